@@ -23,6 +23,7 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "esp_http_server.h"
 #include "esp_ota_ops.h"
@@ -33,6 +34,8 @@
 #include "web_server.h"
 #include "ota_handler.h"
 #include "captive_portal.h"
+#include "static_files.h"
+#include "boot_trace.h"
 
 static const char *TAG = "WEBSERVER_AT";
 
@@ -41,6 +44,20 @@ static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
 
+// Sequência de inicialização: cada etapa sinaliza um bit ao concluir
+static EventGroupHandle_t s_boot_event_group;
+#define BOOT_NVS_BIT        BIT0
+#define BOOT_NETIF_BIT      BIT1
+#define BOOT_WIFI_BIT       BIT2
+#define BOOT_AP_STARTED_BIT BIT3    // WIFI_EVENT_AP_START
+#define BOOT_STATIC_BIT     BIT4
+#define BOOT_OTA_BIT        BIT5
+#define BOOT_WEB_BIT        BIT6
+#define BOOT_PORTAL_BIT     BIT7
+
+// Espera máxima pelas dependências de uma etapa
+#define BOOT_PHASE_TIMEOUT_MS 10000
+
 // Configurações padrão
 #define DEFAULT_AP_SSID     "pos_softap"
 #define DEFAULT_AP_PASSWORD "espressif"
@@ -80,6 +97,8 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_START) {
         ESP_LOGI(TAG, "SoftAP iniciado com sucesso");
+        boot_trace_mark("event.ap_start");
+        xEventGroupSetBits(s_boot_event_group, BOOT_AP_STARTED_BIT);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STOP) {
         ESP_LOGI(TAG, "SoftAP parado");
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
@@ -178,64 +197,134 @@ static void webserver_task(void *pvParameters)
 }
 
 /**
- * @brief Função principal
+ * @brief Etapa: pilha TCP/IP, loop de eventos e handler do SoftAP
  */
-void app_main(void)
+static esp_err_t boot_netif(void)
 {
-    ESP_LOGI(TAG, "=== ESP32-C6 Web Server AT Examples ===");
-    ESP_LOGI(TAG, "Versão: 1.0.0");
-    ESP_LOGI(TAG, "Build: %s %s", __DATE__, __TIME__);
-    
-    // Inicializar NVS
-    ESP_ERROR_CHECK(init_nvs());
-    
     // Inicializar esp_netif (necessário para LWIP)
     ESP_ERROR_CHECK(esp_netif_init());
     
     // Inicializar sistema de eventos
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     
-    // Criar event group
-    s_wifi_event_group = xEventGroupCreate();
-    
     // Registrar handlers de eventos
-    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
-    
-    // Inicializar Wi-Fi
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
-    
-    // Inicializar wifi_manager
+    return esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL);
+}
+
+/**
+ * @brief Etapa: Wi-Fi (driver inicializado só pelo wifi_manager) e SoftAP
+ */
+static esp_err_t boot_wifi(void)
+{
     ESP_ERROR_CHECK(wifi_manager_init());
     
     // Criar interface de rede padrão para Wi-Fi (APÓS inicializar Wi-Fi)
     esp_netif_create_default_wifi_ap();
     esp_netif_create_default_wifi_sta();
     
-    // Configurar SoftAP
-    ESP_ERROR_CHECK(setup_softap());
-    
-    // Aguardar Wi-Fi estar pronto antes de iniciar servidor web
-    vTaskDelay(pdMS_TO_TICKS(3000));
-    
-    ESP_LOGI(TAG, "SoftAP configurado, iniciando servidor web");
-    
-    // Aguardar mais um pouco para garantir que o LWIP está pronto
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    
-    // Inicializar servidor web
-    ESP_ERROR_CHECK(web_server_init());
+    // Configurar SoftAP (conclusão sinalizada por WIFI_EVENT_AP_START)
+    return setup_softap();
+}
+
+/**
+ * @brief Etapa: arquivos estáticos
+ * 
+ * Sem a partição, as páginas continuam funcionando, só as imagens
+ * respondem 404.
+ */
+static esp_err_t boot_static_files(void)
+{
+    if (static_files_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Arquivos estáticos indisponíveis");
+    }
+    return ESP_OK;
+}
+
+// Etapas da inicialização, em ordem. Cada uma espera os bits de que
+// depende (inclusive eventos, como o SoftAP iniciado) em vez de um atraso
+// fixo: o servidor web só precisa da pilha TCP/IP para aceitar conexões.
+typedef struct {
+    const char *name;
+    EventBits_t requires;
+    EventBits_t provides;
+    esp_err_t (*init)(void);
+    bool critical;              // Falha reinicia o sistema
+} boot_phase_t;
+
+static const boot_phase_t s_boot_phases[] = {
+    { "nvs",            0,                                  BOOT_NVS_BIT,    init_nvs,            true  },
+    { "netif",          0,                                  BOOT_NETIF_BIT,  boot_netif,          true  },
+    { "wifi",           BOOT_NVS_BIT | BOOT_NETIF_BIT,      BOOT_WIFI_BIT,   boot_wifi,           true  },
+    { "static_files",   0,                                  BOOT_STATIC_BIT, boot_static_files,   false },
+    { "ota",            BOOT_NVS_BIT,                       BOOT_OTA_BIT,    init_ota_handler,    true  },
+    { "web_server",     BOOT_NETIF_BIT | BOOT_STATIC_BIT | BOOT_OTA_BIT, BOOT_WEB_BIT, web_server_init, true },
+    { "captive_portal", BOOT_WEB_BIT | BOOT_AP_STARTED_BIT, BOOT_PORTAL_BIT, init_captive_portal, false },
+};
+
+/**
+ * @brief Executar as etapas de inicialização (linha do tempo em boot_trace)
+ */
+static void run_boot_sequence(void)
+{
+    for (size_t i = 0; i < sizeof(s_boot_phases) / sizeof(s_boot_phases[0]); i++) {
+        const boot_phase_t *phase = &s_boot_phases[i];
+        int64_t wait_start = esp_timer_get_time();
+        
+        if (phase->requires) {
+            EventBits_t bits = xEventGroupWaitBits(s_boot_event_group, phase->requires,
+                                                 pdFALSE, pdTRUE,
+                                                 pdMS_TO_TICKS(BOOT_PHASE_TIMEOUT_MS));
+            if ((bits & phase->requires) != phase->requires) {
+                ESP_LOGE(TAG, "[boot] %s: dependências não satisfeitas (0x%02x de 0x%02x)",
+                         phase->name, (unsigned)(bits & phase->requires), (unsigned)phase->requires);
+                if (phase->critical) {
+                    ESP_ERROR_CHECK(ESP_ERR_TIMEOUT);
+                }
+                continue;
+            }
+        }
+        
+        int64_t waited_ms = (esp_timer_get_time() - wait_start) / 1000;
+        if (waited_ms > 0) {
+            ESP_LOGI(TAG, "[boot] %s aguardou dependências por %lld ms", phase->name, (long long)waited_ms);
+        }
+        
+        int trace = boot_trace_begin(phase->name);
+        esp_err_t ret = phase->init();
+        boot_trace_end(trace);
+        
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "[boot] %s falhou: %s", phase->name, esp_err_to_name(ret));
+            if (phase->critical) {
+                ESP_ERROR_CHECK(ret);
+            }
+            continue;
+        }
+        xEventGroupSetBits(s_boot_event_group, phase->provides);
+    }
+}
+
+/**
+ * @brief Função principal
+ */
+void app_main(void)
+{
+    boot_trace_mark("app_main");
+    ESP_LOGI(TAG, "=== ESP32-C6 Web Server AT Examples ===");
+    ESP_LOGI(TAG, "Versão: 1.0.0");
+    ESP_LOGI(TAG, "Build: %s %s", __DATE__, __TIME__);
     
-    // Inicializar Captive Portal (se habilitado)
-    ESP_ERROR_CHECK(init_captive_portal());
+    // Criar event groups
+    s_wifi_event_group = xEventGroupCreate();
+    s_boot_event_group = xEventGroupCreate();
     
-    // Inicializar OTA handler
-    ESP_ERROR_CHECK(init_ota_handler());
+    run_boot_sequence();
     
     // Criar task principal
     xTaskCreate(webserver_task, "webserver_task", 4096, NULL, 5, NULL);
     
+    boot_trace_finish();
+    
     ESP_LOGI(TAG, "Sistema inicializado com sucesso!");
     ESP_LOGI(TAG, "SoftAP: %s", g_config.ap_ssid);
     ESP_LOGI(TAG, "Web Server: http://192.168.4.1:%d", g_config.web_port);
@@ -0,0 +1,152 @@
+/**
+ * @file boot_trace.c
+ * @brief Linha do tempo da inicialização (boot trace)
+ */
+
+#include "boot_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_app_format.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+
+static const char *TAG = "BOOT_TRACE";
+
+static boot_trace_event_t s_events[BOOT_TRACE_MAX_EVENTS];
+static int s_event_count = 0;
+static uint32_t s_dropped = 0;
+static int64_t s_boot_done_us = 0;          // 0 = boot em andamento
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Reservar entrada na tabela
+ * 
+ * @return int Índice, ou -1 se a tabela encheu
+ */
+static int add_event(const char *name, bool instant)
+{
+    int64_t now = esp_timer_get_time();
+    int id = -1;
+    
+    taskENTER_CRITICAL(&s_lock);
+    if (s_event_count < BOOT_TRACE_MAX_EVENTS) {
+        id = s_event_count++;
+        s_events[id].name = name;
+        s_events[id].start_us = now;
+        s_events[id].end_us = instant ? now : 0;
+    } else {
+        s_dropped++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    
+    return id;
+}
+
+/**
+ * @brief Nome do motivo do último reset
+ */
+static const char* reset_reason_name(esp_reset_reason_t reason)
+{
+    switch (reason) {
+        case ESP_RST_POWERON:
+            return "poweron";
+        case ESP_RST_EXT:
+            return "external";
+        case ESP_RST_SW:
+            return "software";
+        case ESP_RST_PANIC:
+            return "panic";
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            return "watchdog";
+        case ESP_RST_DEEPSLEEP:
+            return "deepsleep";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        default:
+            return "unknown";
+    }
+}
+
+int boot_trace_begin(const char *name)
+{
+    return add_event(name, false);
+}
+
+void boot_trace_end(int id)
+{
+    if (id < 0 || id >= BOOT_TRACE_MAX_EVENTS) {
+        return;
+    }
+    
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    s_events[id].end_us = now;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void boot_trace_mark(const char *name)
+{
+    add_event(name, true);
+}
+
+void boot_trace_finish(void)
+{
+    s_boot_done_us = esp_timer_get_time();
+    
+    ESP_LOGI(TAG, "Linha do tempo do boot (%lld ms):", (long long)(s_boot_done_us / 1000));
+    int count = s_event_count;
+    for (int i = 0; i < count; i++) {
+        // Cópia sob trava: outras tasks ainda podem estar registrando
+        boot_trace_event_t event;
+        taskENTER_CRITICAL(&s_lock);
+        event = s_events[i];
+        taskEXIT_CRITICAL(&s_lock);
+        
+        if (event.end_us == event.start_us) {
+            ESP_LOGI(TAG, "  %7lld ms  %-32s", (long long)(event.start_us / 1000), event.name);
+        } else if (event.end_us == 0) {
+            ESP_LOGI(TAG, "  %7lld ms  %-32s (não concluída)", (long long)(event.start_us / 1000), event.name);
+        } else {
+            ESP_LOGI(TAG, "  %7lld ms  %-32s %6lld ms", (long long)(event.start_us / 1000), event.name,
+                     (long long)((event.end_us - event.start_us) / 1000));
+        }
+    }
+    if (s_dropped > 0) {
+        ESP_LOGW(TAG, "%lu eventos descartados (BOOT_TRACE_MAX_EVENTS)", (unsigned long)s_dropped);
+    }
+}
+
+esp_err_t boot_trace_write_json(json_writer_t *w)
+{
+    const esp_app_desc_t *app_desc = esp_app_get_description();
+    
+    json_writer_object_begin(w, NULL);
+    json_writer_add_string(w, "version", app_desc ? app_desc->version : NULL);
+    json_writer_add_string(w, "idf_version", app_desc ? app_desc->idf_ver : NULL);
+    json_writer_add_string(w, "reset_reason", reset_reason_name(esp_reset_reason()));
+    json_writer_add_int(w, "boot_time_us", s_boot_done_us);
+    json_writer_add_bool(w, "complete", s_boot_done_us != 0);
+    
+    json_writer_array_begin(w, "events");
+    int count = s_event_count;
+    for (int i = 0; i < count; i++) {
+        boot_trace_event_t event;
+        taskENTER_CRITICAL(&s_lock);
+        event = s_events[i];
+        taskEXIT_CRITICAL(&s_lock);
+        
+        json_writer_object_begin(w, NULL);
+        json_writer_add_string(w, "name", event.name);
+        json_writer_add_int(w, "start_us", event.start_us);
+        json_writer_add_int(w, "duration_us", event.end_us ? event.end_us - event.start_us : -1);
+        json_writer_object_end(w);
+    }
+    json_writer_array_end(w);
+    
+    json_writer_add_int(w, "dropped", s_dropped);
+    json_writer_object_end(w);
+    return w->error;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file boot_trace.h
+ * @brief Linha do tempo da inicialização (boot trace)
+ * 
+ * Registra, com esp_timer_get_time(), o início e o fim de cada etapa do
+ * boot em uma tabela fixa (sem heap), servida em /api/boot e impressa no
+ * log ao final da inicialização. Serve para comparar o tempo de boot
+ * entre versões de firmware.
+ * 
+ * Uso:
+ *     int id = boot_trace_begin("wifi_manager_init");
+ *     ...
+ *     boot_trace_end(id);
+ *     boot_trace_mark("softap_started");
+ */
+
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "json_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Entradas da tabela (as excedentes são descartadas e contadas)
+#define BOOT_TRACE_MAX_EVENTS 32
+
+// Entrada da tabela
+typedef struct {
+    const char *name;           // String estática (não é copiada)
+    int64_t start_us;           // esp_timer_get_time() no início
+    int64_t end_us;             // No fim (0: em andamento; igual ao início em marcas)
+} boot_trace_event_t;
+
+/**
+ * @brief Iniciar etapa
+ * 
+ * @param name Nome (deve permanecer válido: use literais)
+ * @return int Identificador para boot_trace_end(), ou -1 se a tabela encheu
+ */
+int boot_trace_begin(const char *name);
+
+/**
+ * @brief Concluir etapa iniciada com boot_trace_begin()
+ * 
+ * @param id Identificador (-1 é ignorado)
+ */
+void boot_trace_end(int id);
+
+/**
+ * @brief Registrar um instante (evento sem duração)
+ * 
+ * @param name Nome (deve permanecer válido: use literais)
+ */
+void boot_trace_mark(const char *name);
+
+/**
+ * @brief Marcar o fim do boot e imprimir a linha do tempo no log
+ */
+void boot_trace_finish(void);
+
+/**
+ * @brief Escrever a linha do tempo em JSON (/api/boot)
+ * 
+ * @param w Emissor JSON
+ * @return esp_err_t Estado do emissor
+ */
+esp_err_t boot_trace_write_json(json_writer_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_TRACE_H
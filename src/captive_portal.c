@@ -4,11 +4,11 @@
  */
 
 #include "captive_portal.h"
+#include "boot_trace.h"
 #include "esp_log.h"
 #include "esp_http_server.h"
 #include "esp_netif.h"
 #include "esp_wifi.h"
-#include "cJSON.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -48,6 +48,7 @@ esp_err_t init_captive_portal_service(void)
     
     s_enabled = true;
     s_active = true;
+    boot_trace_mark("captive_portal.active");
     
     ESP_LOGI(TAG, "Captive Portal inicializado");
     ESP_LOGI(TAG, "Domínio: %s", s_domain);
@@ -215,24 +216,16 @@ esp_err_t captive_portal_connectivity_test_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-const char* get_captive_portal_status(void)
+esp_err_t get_captive_portal_status(json_writer_t *w)
 {
-    static char json_buffer[256];
-    cJSON *json = cJSON_CreateObject();
-    
-    cJSON_AddBoolToObject(json, "enabled", s_enabled);
-    cJSON_AddBoolToObject(json, "active", s_active);
-    cJSON_AddStringToObject(json, "domain", s_domain);
-    cJSON_AddStringToObject(json, "redirect_url", s_redirect_url);
-    
-    char *json_string = cJSON_Print(json);
-    strncpy(json_buffer, json_string, sizeof(json_buffer) - 1);
-    json_buffer[sizeof(json_buffer) - 1] = '\0';
-    
-    free(json_string);
-    cJSON_Delete(json);
-    
-    return json_buffer;
+    json_writer_object_begin(w, NULL);
+    json_writer_add_bool(w, "enabled", s_enabled);
+    json_writer_add_bool(w, "active", s_active);
+    json_writer_add_string(w, "domain", s_domain);
+    json_writer_add_string(w, "redirect_url", s_redirect_url);
+    json_writer_object_end(w);
+    
+    return w->error;
 }
 
 esp_err_t set_captive_portal_enabled(bool enable)
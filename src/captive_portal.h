@@ -11,6 +11,7 @@
 
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "json_writer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -112,11 +113,12 @@ esp_err_t register_captive_portal_handlers(httpd_handle_t server);
 esp_err_t captive_portal_connectivity_test_handler(httpd_req_t *req);
 
 /**
- * @brief Obter status do Captive Portal
+ * @brief Escrever status do Captive Portal
  * 
- * @return const char* JSON com status
+ * @param w Emissor JSON do chamador (ver json_writer.h)
+ * @return esp_err_t Estado do emissor
  */
-const char* get_captive_portal_status(void);
+esp_err_t get_captive_portal_status(json_writer_t *w);
 
 /**
  * @brief Habilitar/desabilitar Captive Portal
@@ -0,0 +1,181 @@
+/**
+ * @file http_async.c
+ * @brief Execução de handlers lentos fora da task do httpd
+ */
+
+#include "http_async.h"
+#include "http_metrics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+static const char *TAG = "HTTP_ASYNC";
+
+// Abaixo da task do httpd (prioridade 5): as requisições rápidas, atendidas
+// inline, têm preferência sobre as lentas
+#define HTTP_ASYNC_TASK_STACK    4096
+#define HTTP_ASYNC_TASK_PRIORITY 4
+
+// Requisição na fila
+typedef struct {
+    httpd_req_t *req;                       // Cópia de httpd_req_async_handler_begin()
+    http_async_handler_t handler;
+    http_metrics_endpoint_t *endpoint;      // NULL: endpoint sem métricas
+    int64_t enqueued_us;
+} http_async_job_t;
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_workers[HTTP_ASYNC_WORKERS];
+static http_async_stats_t s_stats = {0};
+
+/**
+ * @brief Verificar se a task atual é uma worker
+ */
+static bool in_worker(void)
+{
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < HTTP_ASYNC_WORKERS; i++) {
+        if (s_workers[i] == current) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Task worker: executa as requisições da fila
+ */
+static void worker_task(void *arg)
+{
+    http_async_job_t job;
+    
+    while (true) {
+        if (xQueueReceive(s_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        
+        uint32_t wait_us = (uint32_t)(esp_timer_get_time() - job.enqueued_us);
+        uint32_t max = __atomic_load_n(&s_stats.max_wait_us, __ATOMIC_RELAXED);
+        while (wait_us > max &&
+               !__atomic_compare_exchange_n(&s_stats.max_wait_us, &max, wait_us, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+        
+        __atomic_fetch_add(&s_stats.busy, 1, __ATOMIC_RELAXED);
+        httpd_handle_t server = job.req->handle;
+        int sockfd = httpd_req_to_sockfd(job.req);
+        esp_err_t ret = http_metrics_run(job.endpoint, job.req, job.handler, job.enqueued_us);
+        httpd_req_async_handler_complete(job.req);
+        __atomic_fetch_sub(&s_stats.busy, 1, __ATOMIC_RELAXED);
+        
+        // Inline, o httpd fecharia a conexão quando o handler retorna erro
+        if (ret != ESP_OK) {
+            httpd_sess_trigger_close(server, sockfd);
+        }
+    }
+}
+
+/**
+ * @brief Responder 503 (todos os workers ocupados e fila cheia)
+ * 
+ * Com Connection: close, o handler retorna erro e o httpd fecha a sessão
+ * em vez de descartar o corpo restante (um firmware inteiro, no POST /ota)
+ * na própria task.
+ */
+static esp_err_t send_busy(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Retry-After", HTTP_ASYNC_RETRY_AFTER_S);
+    httpd_resp_set_hdr(req, "Connection", "close");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, "{\"success\":false,\"message\":\"Servidor ocupado, tente novamente\"}",
+                           HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t http_async_init(void)
+{
+    if (s_queue) {
+        return ESP_OK;
+    }
+    
+    s_queue = xQueueCreate(HTTP_ASYNC_QUEUE_LEN, sizeof(http_async_job_t));
+    if (!s_queue) {
+        ESP_LOGE(TAG, "Erro ao criar fila de requisições");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (int i = 0; i < HTTP_ASYNC_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "http_async_%d", i);
+        if (xTaskCreate(worker_task, name, HTTP_ASYNC_TASK_STACK, NULL,
+                        HTTP_ASYNC_TASK_PRIORITY, &s_workers[i]) != pdPASS) {
+            // Os workers já criados continuam atendendo a fila
+            s_workers[i] = NULL;
+            ESP_LOGE(TAG, "Erro ao criar worker %d", i);
+            if (i == 0) {
+                vQueueDelete(s_queue);
+                s_queue = NULL;
+                return ESP_ERR_NO_MEM;
+            }
+            break;
+        }
+    }
+    
+    ESP_LOGI(TAG, "Pool assíncrono: %d workers, fila de %d", HTTP_ASYNC_WORKERS, HTTP_ASYNC_QUEUE_LEN);
+    return ESP_OK;
+}
+
+esp_err_t http_async_dispatch(httpd_req_t *req, http_async_handler_t handler)
+{
+    if (!req || !handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!s_queue || in_worker()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    http_async_job_t job = {
+        .handler = handler,
+        .endpoint = http_metrics_current(),
+        .enqueued_us = esp_timer_get_time(),
+    };
+    
+    esp_err_t ret = httpd_req_async_handler_begin(req, &job.req);
+    if (ret != ESP_OK) {
+        // Sem cópia da requisição: atender inline
+        ESP_LOGW(TAG, "Erro ao iniciar requisição assíncrona: %s", esp_err_to_name(ret));
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (xQueueSend(s_queue, &job, 0) != pdTRUE) {
+        httpd_req_async_handler_complete(job.req);
+        __atomic_fetch_add(&s_stats.rejected, 1, __ATOMIC_RELAXED);
+        ESP_LOGW(TAG, "Fila cheia, respondendo 503: %s", req->uri);
+        send_busy(req);
+        return ESP_FAIL;
+    }
+    
+    http_metrics_defer();
+    __atomic_fetch_add(&s_stats.dispatched, 1, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+esp_err_t http_async_get_stats(http_async_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    stats->dispatched = __atomic_load_n(&s_stats.dispatched, __ATOMIC_RELAXED);
+    stats->rejected = __atomic_load_n(&s_stats.rejected, __ATOMIC_RELAXED);
+    stats->busy = __atomic_load_n(&s_stats.busy, __ATOMIC_RELAXED);
+    stats->queued = s_queue ? uxQueueMessagesWaiting(s_queue) : 0;
+    stats->max_wait_us = __atomic_load_n(&s_stats.max_wait_us, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
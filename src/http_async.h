@@ -0,0 +1,86 @@
+/**
+ * @file http_async.h
+ * @brief Execução de handlers lentos fora da task do httpd
+ * 
+ * O esp_http_server atende todos os handlers em uma única task: um scan,
+ * um upload OTA ou uma gravação na flash bloqueiam as demais conexões.
+ * Handlers lentos repassam a requisição (httpd_req_async_handler_begin)
+ * a um pool pequeno de workers por uma fila limitada; com a fila cheia, a
+ * resposta é 503 com Retry-After e a conexão é fechada. Os endpoints
+ * rápidos (páginas, status) continuam na task do httpd.
+ * 
+ * Uso, no início do handler:
+ *     esp_err_t ret = http_async_dispatch(req, meu_handler);
+ *     if (ret != ESP_ERR_INVALID_STATE) {
+ *         return ret;
+ *     }
+ *     ... (executando na worker, ou inline se o pool não existe)
+ */
+
+#ifndef HTTP_ASYNC_H
+#define HTTP_ASYNC_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Workers (requisições lentas simultâneas)
+#define HTTP_ASYNC_WORKERS 2
+
+// Requisições aguardando worker; acima disso, 503
+#define HTTP_ASYNC_QUEUE_LEN 4
+
+// Segundos sugeridos ao cliente no 503 (Retry-After)
+#define HTTP_ASYNC_RETRY_AFTER_S "2"
+
+// Handler HTTP
+typedef esp_err_t (*http_async_handler_t)(httpd_req_t *req);
+
+// Contadores
+typedef struct {
+    uint32_t dispatched;        // Requisições repassadas aos workers
+    uint32_t rejected;          // Respondidas com 503 (fila cheia)
+    uint32_t busy;              // Workers executando agora
+    uint32_t queued;            // Aguardando worker
+    uint32_t max_wait_us;       // Maior espera na fila
+} http_async_stats_t;
+
+/**
+ * @brief Criar a fila e os workers
+ * 
+ * Sem o pool, http_async_dispatch() devolve ESP_ERR_INVALID_STATE e os
+ * handlers rodam na task do httpd, como antes.
+ * 
+ * @return esp_err_t
+ */
+esp_err_t http_async_init(void);
+
+/**
+ * @brief Repassar a requisição a um worker
+ * 
+ * @param req Requisição (na task do httpd)
+ * @param handler Handler a executar na worker com a cópia da requisição
+ * @return esp_err_t ESP_OK se a requisição foi repassada; ESP_FAIL se foi
+ *         respondida com 503 (o handler retorna o erro para o httpd fechar a
+ *         sessão sem ler o corpo); ESP_ERR_INVALID_STATE se já está em uma
+ *         worker ou o pool não existe (o handler segue inline)
+ */
+esp_err_t http_async_dispatch(httpd_req_t *req, http_async_handler_t handler);
+
+/**
+ * @brief Obter contadores
+ * 
+ * @param stats Contadores
+ * @return esp_err_t
+ */
+esp_err_t http_async_get_stats(http_async_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_ASYNC_H
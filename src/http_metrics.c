@@ -0,0 +1,361 @@
+/**
+ * @file http_metrics.c
+ * @brief Métricas por endpoint do servidor HTTP
+ */
+
+#include "http_metrics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "lwip/sockets.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(CONFIG_LWIP_MAX_SOCKETS) && CONFIG_LWIP_MAX_SOCKETS > HTTP_METRICS_SOCKET_SLOTS
+#error "HTTP_METRICS_SOCKET_SLOTS deve ser >= CONFIG_LWIP_MAX_SOCKETS"
+#endif
+
+static const char *TAG = "HTTP_METRICS";
+
+// Slots preenchidos só no registro (antes de atender requisições); depois,
+// apenas contadores mudam: os de 32 bits com operações atômicas, as somas
+// de 64 bits sob s_sum_lock (no RV32 o __atomic de 64 bits não é lock-free)
+static http_metrics_endpoint_t s_endpoints[HTTP_METRICS_MAX_ENDPOINTS];
+static int s_endpoint_count = 0;
+static portMUX_TYPE s_sum_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Bytes enviados na requisição atual de cada socket
+static uint32_t s_socket_bytes[HTTP_METRICS_SOCKET_SLOTS];
+
+// Requisição em execução no invólucro (apenas na task do httpd)
+static http_metrics_endpoint_t *s_current = NULL;
+static bool s_deferred = false;
+
+/**
+ * @brief Envio pelo socket contando bytes (mesmo tratamento do envio padrão)
+ */
+static int metrics_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    if (!buf) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+    
+    int ret = send(sockfd, buf, buf_len, flags);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    
+    __atomic_fetch_add(&s_socket_bytes[sockfd % HTTP_METRICS_SOCKET_SLOTS], (uint32_t)ret, __ATOMIC_RELAXED);
+    return ret;
+}
+
+/**
+ * @brief Faixa do histograma para uma latência
+ */
+static int latency_bucket(int64_t latency_us)
+{
+    int bucket = 0;
+    while (bucket < HTTP_METRICS_BUCKETS - 1 &&
+           latency_us > (int64_t)http_metrics_bucket_bound_ms(bucket) * 1000) {
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Contabilizar uma requisição concluída
+ */
+static void record_request(http_metrics_endpoint_t *endpoint, int64_t latency_us, uint32_t bytes, esp_err_t ret)
+{
+    uint32_t latency = latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us;
+    __atomic_fetch_add(&endpoint->requests, 1, __ATOMIC_RELAXED);
+    if (ret != ESP_OK) {
+        __atomic_fetch_add(&endpoint->errors, 1, __ATOMIC_RELAXED);
+    }
+    taskENTER_CRITICAL(&s_sum_lock);
+    endpoint->bytes_sent += bytes;
+    endpoint->latency_us_total += latency;
+    taskEXIT_CRITICAL(&s_sum_lock);
+    __atomic_fetch_add(&endpoint->buckets[latency_bucket(latency_us)], 1, __ATOMIC_RELAXED);
+    
+    uint32_t max = __atomic_load_n(&endpoint->latency_us_max, __ATOMIC_RELAXED);
+    while (latency > max &&
+           !__atomic_compare_exchange_n(&endpoint->latency_us_max, &max, latency, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief Ler uma soma de 64 bits do endpoint
+ */
+static uint64_t load_sum(const uint64_t *sum)
+{
+    taskENTER_CRITICAL(&s_sum_lock);
+    uint64_t value = *sum;
+    taskEXIT_CRITICAL(&s_sum_lock);
+    return value;
+}
+
+/**
+ * @brief Invólucro dos handlers registrados
+ */
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    http_metrics_endpoint_t *endpoint = (http_metrics_endpoint_t *)req->user_ctx;
+    int sockfd = httpd_req_to_sockfd(req);
+    uint32_t *socket_bytes = &s_socket_bytes[sockfd % HTTP_METRICS_SOCKET_SLOTS];
+    
+    __atomic_store_n(socket_bytes, 0, __ATOMIC_RELAXED);
+    httpd_sess_set_send_override(req->handle, sockfd, metrics_send);
+    
+    s_current = endpoint;
+    s_deferred = false;
+    
+    int64_t start = esp_timer_get_time();
+    req->user_ctx = endpoint->uri.user_ctx;
+    esp_err_t ret = endpoint->uri.handler(req);
+    int64_t latency_us = esp_timer_get_time() - start;
+    
+    s_current = NULL;
+    if (!s_deferred) {
+        record_request(endpoint, latency_us, __atomic_load_n(socket_bytes, __ATOMIC_RELAXED), ret);
+    }
+    
+    return ret;
+}
+
+http_metrics_endpoint_t* http_metrics_current(void)
+{
+    return s_current;
+}
+
+void http_metrics_defer(void)
+{
+    s_deferred = true;
+}
+
+esp_err_t http_metrics_run(http_metrics_endpoint_t *endpoint, httpd_req_t *req,
+                           esp_err_t (*handler)(httpd_req_t *req), int64_t start_us)
+{
+    if (!endpoint) {
+        return handler(req);
+    }
+    
+    // O envio contado já está instalado na sessão pelo invólucro, e o
+    // httpd não lê outra requisição do socket enquanto esta não termina
+    uint32_t *socket_bytes = &s_socket_bytes[httpd_req_to_sockfd(req) % HTTP_METRICS_SOCKET_SLOTS];
+    __atomic_store_n(socket_bytes, 0, __ATOMIC_RELAXED);
+    
+    esp_err_t ret = handler(req);
+    record_request(endpoint, esp_timer_get_time() - start_us,
+                   __atomic_load_n(socket_bytes, __ATOMIC_RELAXED), ret);
+    return ret;
+}
+
+/**
+ * @brief Nome do método HTTP
+ */
+static const char* method_name(httpd_method_t method)
+{
+    switch (method) {
+        case HTTP_GET:
+            return "GET";
+        case HTTP_POST:
+            return "POST";
+        case HTTP_PUT:
+            return "PUT";
+        case HTTP_DELETE:
+            return "DELETE";
+        case HTTP_HEAD:
+            return "HEAD";
+        case HTTP_OPTIONS:
+            return "OPTIONS";
+        default:
+            return "OTHER";
+    }
+}
+
+esp_err_t http_metrics_register(httpd_handle_t server, const httpd_uri_t *uri)
+{
+    if (!uri) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (s_endpoint_count >= HTTP_METRICS_MAX_ENDPOINTS) {
+        ESP_LOGW(TAG, "Sem slot de métricas para %s", uri->uri);
+        return httpd_register_uri_handler(server, uri);
+    }
+    
+    http_metrics_endpoint_t *endpoint = &s_endpoints[s_endpoint_count];
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->uri = *uri;
+    
+    httpd_uri_t wrapped = *uri;
+    wrapped.handler = metrics_handler;
+    wrapped.user_ctx = endpoint;
+    
+    esp_err_t ret = httpd_register_uri_handler(server, &wrapped);
+    if (ret == ESP_OK) {
+        s_endpoint_count++;
+    }
+    return ret;
+}
+
+uint32_t http_metrics_bucket_bound_ms(int bucket)
+{
+    return bucket < HTTP_METRICS_BUCKETS - 1 ? 1u << bucket : 0;
+}
+
+esp_err_t http_metrics_write_json(json_writer_t *w)
+{
+    json_writer_object_begin(w, NULL);
+    json_writer_add_int(w, "uptime_us", esp_timer_get_time());
+    
+    json_writer_array_begin(w, "bucket_bounds_ms");
+    for (int i = 0; i < HTTP_METRICS_BUCKETS - 1; i++) {
+        json_writer_add_int(w, NULL, http_metrics_bucket_bound_ms(i));
+    }
+    json_writer_array_end(w);
+    
+    uint64_t requests_total = 0;
+    json_writer_array_begin(w, "endpoints");
+    for (int i = 0; i < s_endpoint_count; i++) {
+        http_metrics_endpoint_t *endpoint = &s_endpoints[i];
+        uint32_t requests = __atomic_load_n(&endpoint->requests, __ATOMIC_RELAXED);
+        uint64_t latency_total = load_sum(&endpoint->latency_us_total);
+        requests_total += requests;
+        
+        json_writer_object_begin(w, NULL);
+        json_writer_add_string(w, "uri", endpoint->uri.uri);
+        json_writer_add_string(w, "method", method_name(endpoint->uri.method));
+        json_writer_add_int(w, "requests", requests);
+        json_writer_add_int(w, "errors", __atomic_load_n(&endpoint->errors, __ATOMIC_RELAXED));
+        json_writer_add_int(w, "bytes_sent", load_sum(&endpoint->bytes_sent));
+        json_writer_add_int(w, "latency_us_avg", requests ? latency_total / requests : 0);
+        json_writer_add_int(w, "latency_us_max", __atomic_load_n(&endpoint->latency_us_max, __ATOMIC_RELAXED));
+        json_writer_array_begin(w, "histogram");
+        for (int b = 0; b < HTTP_METRICS_BUCKETS; b++) {
+            json_writer_add_int(w, NULL, __atomic_load_n(&endpoint->buckets[b], __ATOMIC_RELAXED));
+        }
+        json_writer_array_end(w);
+        json_writer_object_end(w);
+    }
+    json_writer_array_end(w);
+    
+    json_writer_add_int(w, "requests_total", requests_total);
+    json_writer_object_end(w);
+    return w->error;
+}
+
+// Buffer de saída do formato Prometheus
+typedef struct {
+    httpd_req_t *req;
+    char buf[512];
+    size_t len;
+    esp_err_t error;
+} prom_writer_t;
+
+/**
+ * @brief Acrescentar linha formatada, enviando o bloco quando encher
+ */
+static void prom_printf(prom_writer_t *p, const char *fmt, ...)
+{
+    if (p->error != ESP_OK) {
+        return;
+    }
+    
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(p->buf + p->len, sizeof(p->buf) - p->len, fmt, args);
+        va_end(args);
+        
+        if (n >= 0 && (size_t)n < sizeof(p->buf) - p->len) {
+            p->len += n;
+            return;
+        }
+        
+        // Não coube: enviar o que há e tentar de novo com o buffer vazio
+        if (p->len == 0) {
+            break;
+        }
+        p->error = httpd_resp_send_chunk(p->req, p->buf, p->len);
+        p->len = 0;
+        if (p->error != ESP_OK) {
+            return;
+        }
+    }
+    p->error = ESP_ERR_INVALID_SIZE;
+}
+
+esp_err_t http_metrics_send_prometheus(httpd_req_t *req)
+{
+    static prom_writer_t p;     // Fora da pilha do httpd (uma requisição por vez)
+    p.req = req;
+    p.len = 0;
+    p.error = ESP_OK;
+    
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    
+    prom_printf(&p, "# HELP http_requests_total Requisicoes atendidas por endpoint\n"
+                    "# TYPE http_requests_total counter\n");
+    for (int i = 0; i < s_endpoint_count; i++) {
+        prom_printf(&p, "http_requests_total{uri=\"%s\",method=\"%s\"} %" PRIu32 "\n",
+                    s_endpoints[i].uri.uri, method_name(s_endpoints[i].uri.method),
+                    __atomic_load_n(&s_endpoints[i].requests, __ATOMIC_RELAXED));
+    }
+    
+    prom_printf(&p, "# HELP http_request_errors_total Handlers que retornaram erro\n"
+                    "# TYPE http_request_errors_total counter\n");
+    for (int i = 0; i < s_endpoint_count; i++) {
+        prom_printf(&p, "http_request_errors_total{uri=\"%s\",method=\"%s\"} %" PRIu32 "\n",
+                    s_endpoints[i].uri.uri, method_name(s_endpoints[i].uri.method),
+                    __atomic_load_n(&s_endpoints[i].errors, __ATOMIC_RELAXED));
+    }
+    
+    prom_printf(&p, "# HELP http_response_bytes_total Bytes enviados\n"
+                    "# TYPE http_response_bytes_total counter\n");
+    for (int i = 0; i < s_endpoint_count; i++) {
+        prom_printf(&p, "http_response_bytes_total{uri=\"%s\",method=\"%s\"} %" PRIu64 "\n",
+                    s_endpoints[i].uri.uri, method_name(s_endpoints[i].uri.method),
+                    load_sum(&s_endpoints[i].bytes_sent));
+    }
+    
+    prom_printf(&p, "# HELP http_request_duration_seconds Tempo no handler\n"
+                    "# TYPE http_request_duration_seconds histogram\n");
+    for (int i = 0; i < s_endpoint_count; i++) {
+        http_metrics_endpoint_t *endpoint = &s_endpoints[i];
+        const char *method = method_name(endpoint->uri.method);
+        uint64_t cumulative = 0;
+        
+        for (int b = 0; b < HTTP_METRICS_BUCKETS; b++) {
+            uint32_t bound = http_metrics_bucket_bound_ms(b);
+            cumulative += __atomic_load_n(&endpoint->buckets[b], __ATOMIC_RELAXED);
+            if (bound) {
+                prom_printf(&p, "http_request_duration_seconds_bucket{uri=\"%s\",method=\"%s\",le=\"%" PRIu32 ".%03" PRIu32 "\"} %" PRIu64 "\n",
+                            endpoint->uri.uri, method, bound / 1000, bound % 1000, cumulative);
+            } else {
+                prom_printf(&p, "http_request_duration_seconds_bucket{uri=\"%s\",method=\"%s\",le=\"+Inf\"} %" PRIu64 "\n",
+                            endpoint->uri.uri, method, cumulative);
+            }
+        }
+        
+        uint64_t total_us = load_sum(&endpoint->latency_us_total);
+        prom_printf(&p, "http_request_duration_seconds_sum{uri=\"%s\",method=\"%s\"} %" PRIu64 ".%06" PRIu64 "\n"
+                        "http_request_duration_seconds_count{uri=\"%s\",method=\"%s\"} %" PRIu64 "\n",
+                    endpoint->uri.uri, method, total_us / 1000000, total_us % 1000000,
+                    endpoint->uri.uri, method, cumulative);
+    }
+    
+    if (p.error == ESP_OK && p.len > 0) {
+        p.error = httpd_resp_send_chunk(req, p.buf, p.len);
+    }
+    if (p.error == ESP_OK) {
+        p.error = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return p.error;
+}
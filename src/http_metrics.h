@@ -0,0 +1,112 @@
+/**
+ * @file http_metrics.h
+ * @brief Métricas por endpoint do servidor HTTP
+ * 
+ * Cada handler registrado com http_metrics_register() passa por um
+ * invólucro que conta requisições, erros e bytes enviados e registra a
+ * latência em um histograma com faixas em potências de 2 (1 ms a 2 s).
+ * Os contadores ficam em slots fixos por endpoint: os de 32 bits são
+ * atualizados com operações atômicas e as somas de 64 bits (bytes e
+ * latência), que no RV32 não têm atômicos lock-free, sob uma seção crítica
+ * curta. São exportados em JSON ou no formato texto do Prometheus
+ * (/api/metrics).
+ */
+
+#ifndef HTTP_METRICS_H
+#define HTTP_METRICS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "json_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Endpoints monitorados (os excedentes são registrados sem métricas)
+#define HTTP_METRICS_MAX_ENDPOINTS 20
+
+// Faixas do histograma: até 1, 2, 4 ... 2048 ms e acima (+Inf)
+#define HTTP_METRICS_BUCKETS 13
+
+// Contadores de bytes por socket (índice sockfd % N; deve ser >= o
+// número de sockets do lwip)
+#define HTTP_METRICS_SOCKET_SLOTS 16
+
+// Slot de um endpoint
+typedef struct {
+    httpd_uri_t uri;                    // Cópia do original (handler e user_ctx originais)
+    uint32_t requests;
+    uint32_t errors;                    // Handler retornou erro
+    uint64_t bytes_sent;                // Somas de 64 bits: só sob a trava do módulo
+    uint64_t latency_us_total;
+    uint32_t latency_us_max;
+    uint32_t buckets[HTTP_METRICS_BUCKETS];     // Não cumulativos
+} http_metrics_endpoint_t;
+
+/**
+ * @brief Registrar handler com coleta de métricas
+ * 
+ * Substitui httpd_register_uri_handler(). O handler original recebe o
+ * próprio user_ctx em req->user_ctx, como se não houvesse invólucro.
+ * 
+ * @param server Servidor
+ * @param uri Handler (copiado)
+ * @return esp_err_t Resultado de httpd_register_uri_handler()
+ */
+esp_err_t http_metrics_register(httpd_handle_t server, const httpd_uri_t *uri);
+
+/**
+ * @brief Endpoint da requisição em execução na task do httpd
+ * 
+ * @return http_metrics_endpoint_t* Slot, ou NULL fora de um handler monitorado
+ */
+http_metrics_endpoint_t* http_metrics_current(void);
+
+/**
+ * @brief Indicar que a requisição atual continua fora do handler
+ * 
+ * Chamado após repassar a requisição a outra task: o invólucro deixa de
+ * contabilizá-la, e a contagem fica com http_metrics_run().
+ */
+void http_metrics_defer(void);
+
+/**
+ * @brief Executar handler adiado, contabilizando no endpoint
+ * 
+ * @param endpoint Slot obtido com http_metrics_current() (NULL: sem métricas)
+ * @param req Cópia assíncrona da requisição
+ * @param handler Handler original
+ * @param start_us esp_timer_get_time() na chegada (a latência inclui a espera na fila)
+ * @return esp_err_t Retorno do handler
+ */
+esp_err_t http_metrics_run(http_metrics_endpoint_t *endpoint, httpd_req_t *req,
+                           esp_err_t (*handler)(httpd_req_t *req), int64_t start_us);
+
+/**
+ * @brief Limite superior (ms) de uma faixa do histograma (0: +Inf)
+ */
+uint32_t http_metrics_bucket_bound_ms(int bucket);
+
+/**
+ * @brief Escrever métricas em JSON
+ * 
+ * @param w Emissor JSON
+ * @return esp_err_t Estado do emissor
+ */
+esp_err_t http_metrics_write_json(json_writer_t *w);
+
+/**
+ * @brief Enviar métricas no formato texto do Prometheus (em blocos)
+ * 
+ * @param req Requisição
+ * @return esp_err_t
+ */
+esp_err_t http_metrics_send_prometheus(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_METRICS_H
@@ -0,0 +1,123 @@
+/**
+ * @file http_range.c
+ * @brief Interpretação do cabeçalho Range (intervalo único)
+ */
+
+#include "http_range.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Ler número decimal sem sinal
+ * 
+ * @return const char* Posição após o número, ou NULL se não houver dígitos
+ */
+static const char* parse_number(const char *p, size_t *value)
+{
+    if (*p < '0' || *p > '9') {
+        return NULL;
+    }
+    
+    char *end;
+    unsigned long long v = strtoull(p, &end, 10);
+    if (v > SIZE_MAX) {
+        v = SIZE_MAX;
+    }
+    *value = (size_t)v;
+    return end;
+}
+
+/**
+ * @brief Verificar se o If-Range permite a resposta parcial
+ * 
+ * Só ETags são aceitos (comparação forte); datas não são validadas e
+ * resultam no recurso inteiro.
+ */
+static bool if_range_matches(httpd_req_t *req, const char *etag)
+{
+    size_t len = httpd_req_get_hdr_value_len(req, "If-Range");
+    if (len == 0) {
+        return true;
+    }
+    
+    char value[HTTP_RANGE_HEADER_SIZE];
+    if (!etag || len >= sizeof(value) ||
+        httpd_req_get_hdr_value_str(req, "If-Range", value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    
+    return strcmp(value, etag) == 0;
+}
+
+esp_err_t http_range_parse(httpd_req_t *req, size_t size, const char *etag, http_range_t *range)
+{
+    memset(range, 0, sizeof(*range));
+    range->length = size;
+    
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+    
+    char value[HTTP_RANGE_HEADER_SIZE];
+    if (size == 0 ||
+        httpd_req_get_hdr_value_str(req, "Range", value, sizeof(value)) != ESP_OK ||
+        strncmp(value, "bytes=", 6) != 0 || strchr(value, ',') != NULL ||
+        !if_range_matches(req, etag)) {
+        return ESP_OK;
+    }
+    
+    const char *p = value + 6;
+    size_t first, last = size - 1;
+    
+    if (*p == '-') {
+        // Sufixo: últimos n bytes
+        size_t n;
+        p = parse_number(p + 1, &n);
+        if (!p || *p != '\0') {
+            return ESP_OK;
+        }
+        if (n == 0) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        first = n < size ? size - n : 0;
+    } else {
+        p = parse_number(p, &first);
+        if (!p || *p != '-') {
+            return ESP_OK;
+        }
+        p++;
+        if (*p != '\0') {
+            size_t end;
+            p = parse_number(p, &end);
+            if (!p || *p != '\0' || end < first) {
+                return ESP_OK;
+            }
+            if (end < last) {
+                last = end;
+            }
+        }
+        if (first >= size) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    
+    range->start = first;
+    range->length = last - first + 1;
+    range->partial = true;
+    snprintf(range->content_range, sizeof(range->content_range), "bytes %u-%u/%u",
+             (unsigned)first, (unsigned)last, (unsigned)size);
+    
+    httpd_resp_set_status(req, "206 Partial Content");
+    httpd_resp_set_hdr(req, "Content-Range", range->content_range);
+    return ESP_OK;
+}
+
+esp_err_t http_range_send_unsatisfiable(httpd_req_t *req, size_t size)
+{
+    char content_range[32];
+    snprintf(content_range, sizeof(content_range), "bytes */%u", (unsigned)size);
+    
+    httpd_resp_set_status(req, "416 Range Not Satisfiable");
+    httpd_resp_set_hdr(req, "Content-Range", content_range);
+    return httpd_resp_send(req, NULL, 0);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file http_range.h
+ * @brief Requisições parciais (Range / 206 Partial Content)
+ * 
+ * Suporta um único intervalo de bytes por requisição ("bytes=a-b",
+ * "bytes=a-" e "bytes=-n"). Pedidos com vários intervalos ou malformados
+ * são ignorados e respondidos por inteiro, como permite a RFC 9110.
+ */
+
+#ifndef HTTP_RANGE_H
+#define HTTP_RANGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tamanho do buffer do cabeçalho Range recebido
+#define HTTP_RANGE_HEADER_SIZE 64
+
+// Intervalo a enviar
+typedef struct {
+    size_t start;               // Primeiro byte
+    size_t length;              // Bytes a enviar
+    bool partial;               // true: resposta 206 com Content-Range
+    char content_range[48];     // Valor do Content-Range (vive até o envio)
+} http_range_t;
+
+/**
+ * @brief Interpretar Range / If-Range da requisição
+ * 
+ * Sem Range (ou com If-Range diferente do ETag atual), o intervalo é o
+ * recurso inteiro. Define "Accept-Ranges: bytes" na resposta; em pedido
+ * parcial, também o status 206 e o Content-Range.
+ * 
+ * @param req Requisição
+ * @param size Tamanho total do recurso
+ * @param etag ETag atual do recurso (NULL: If-Range nunca corresponde)
+ * @param range Intervalo resultante
+ * @return esp_err_t ESP_ERR_INVALID_SIZE se o intervalo estiver fora do
+ *         recurso (responder com http_range_send_unsatisfiable)
+ */
+esp_err_t http_range_parse(httpd_req_t *req, size_t size, const char *etag, http_range_t *range);
+
+/**
+ * @brief Responder 416 Range Not Satisfiable
+ * 
+ * @param req Requisição
+ * @param size Tamanho total do recurso (informado no Content-Range)
+ * @return esp_err_t
+ */
+esp_err_t http_range_send_unsatisfiable(httpd_req_t *req, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_RANGE_H
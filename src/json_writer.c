@@ -0,0 +1,262 @@
+/**
+ * @file json_writer.c
+ * @brief Emissor de JSON compacto sem alocação
+ */
+
+#include "json_writer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Descarregar o buffer, se houver função de descarga
+ */
+static void flush_buffer(json_writer_t *w)
+{
+    if (w->error == ESP_OK && w->flush && w->len > 0) {
+        w->error = w->flush(w->flush_ctx, w->buf, w->len);
+        w->len = 0;
+    }
+}
+
+/**
+ * @brief Acrescentar bytes à saída
+ * 
+ * Em buffer fixo, um byte fica reservado para o '\0' final; o que não
+ * couber marca o erro ESP_ERR_INVALID_SIZE e é descartado, mas continua
+ * contado em total (tamanho necessário, como no snprintf).
+ */
+static void write_raw(json_writer_t *w, const char *data, size_t len)
+{
+    if (w->error == ESP_ERR_INVALID_SIZE && !w->flush) {
+        w->total += len;
+        return;
+    }
+    
+    while (w->error == ESP_OK && len > 0) {
+        size_t room = w->size - w->len - (w->flush ? 0 : 1);
+        if (room == 0) {
+            if (!w->flush) {
+                w->error = ESP_ERR_INVALID_SIZE;
+                w->total += len;
+                return;
+            }
+            flush_buffer(w);
+            continue;
+        }
+        
+        size_t n = len < room ? len : room;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        w->total += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Escrever string com aspas e escapes
+ */
+static void write_string(json_writer_t *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    
+    write_raw(w, "\"", 1);
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        
+        // Trecho sem escapes de uma vez só
+        write_raw(w, run, s - run);
+        run = s + 1;
+        
+        char esc[6] = {'\\', (char)c, 0};
+        size_t esc_len = 2;
+        switch (c) {
+            case '"':
+            case '\\':
+                break;
+            case '\n':
+                esc[1] = 'n';
+                break;
+            case '\r':
+                esc[1] = 'r';
+                break;
+            case '\t':
+                esc[1] = 't';
+                break;
+            default:
+                memcpy(esc + 1, "u00", 3);
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 0x0f];
+                esc_len = 6;
+                break;
+        }
+        write_raw(w, esc, esc_len);
+    }
+    write_raw(w, run, s - run);
+    write_raw(w, "\"", 1);
+}
+
+/**
+ * @brief Escrever separador e nome do campo antes de um valor
+ */
+static void write_key(json_writer_t *w, const char *key)
+{
+    if (w->depth > 0) {
+        if (w->has_items[w->depth - 1]) {
+            write_raw(w, ",", 1);
+        }
+        w->has_items[w->depth - 1] = true;
+    }
+    
+    if (key) {
+        write_string(w, key);
+        write_raw(w, ":", 1);
+    }
+}
+
+/**
+ * @brief Abrir nível de aninhamento
+ */
+static void open_level(json_writer_t *w, const char *key, char bracket)
+{
+    write_key(w, key);
+    write_raw(w, &bracket, 1);
+    
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->error = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    w->has_items[w->depth++] = false;
+}
+
+/**
+ * @brief Fechar nível de aninhamento
+ */
+static void close_level(json_writer_t *w, char bracket)
+{
+    if (w->depth == 0) {
+        w->error = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    w->depth--;
+    write_raw(w, &bracket, 1);
+}
+
+/**
+ * @brief Descarga para httpd_resp_send_chunk
+ */
+static esp_err_t httpd_flush(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+    json_writer_init_stream(w, buf, size, NULL, NULL);
+    if (size == 0) {
+        w->error = ESP_ERR_INVALID_SIZE;
+    } else {
+        buf[0] = '\0';
+    }
+}
+
+void json_writer_init_stream(json_writer_t *w, char *buf, size_t size,
+                             json_writer_flush_t flush, void *ctx)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->size = size;
+    w->flush = flush;
+    w->flush_ctx = ctx;
+    w->error = (buf && size > 0) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void json_writer_init_httpd(json_writer_t *w, httpd_req_t *req, char *buf, size_t size)
+{
+    json_writer_init_stream(w, buf, size, httpd_flush, req);
+}
+
+void json_writer_object_begin(json_writer_t *w, const char *key)
+{
+    open_level(w, key, '{');
+}
+
+void json_writer_array_begin(json_writer_t *w, const char *key)
+{
+    open_level(w, key, '[');
+}
+
+void json_writer_object_end(json_writer_t *w)
+{
+    close_level(w, '}');
+}
+
+void json_writer_array_end(json_writer_t *w)
+{
+    close_level(w, ']');
+}
+
+void json_writer_add_string(json_writer_t *w, const char *key, const char *value)
+{
+    write_key(w, key);
+    if (value) {
+        write_string(w, value);
+    } else {
+        write_raw(w, "null", 4);
+    }
+}
+
+void json_writer_add_int(json_writer_t *w, const char *key, int64_t value)
+{
+    char number[24];
+    int len = snprintf(number, sizeof(number), "%" PRId64, value);
+    
+    write_key(w, key);
+    write_raw(w, number, len);
+}
+
+void json_writer_add_bool(json_writer_t *w, const char *key, bool value)
+{
+    write_key(w, key);
+    write_raw(w, value ? "true" : "false", value ? 4 : 5);
+}
+
+esp_err_t json_writer_finish(json_writer_t *w)
+{
+    if (w->error == ESP_OK && w->depth != 0) {
+        w->error = ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!w->flush) {
+        // Mesmo em erro, o buffer fica com uma string válida (truncada)
+        if (w->size > 0) {
+            w->buf[w->len] = '\0';
+        }
+        return w->error;
+    }
+    
+    if (w->flush == httpd_flush) {
+        httpd_req_t *req = (httpd_req_t *)w->flush_ctx;
+        
+        // Resposta inteira no buffer: envio único, com Content-Length
+        if (w->error == ESP_OK && w->total == w->len) {
+            w->error = httpd_resp_send(req, w->buf, w->len);
+            w->len = 0;
+            return w->error;
+        }
+        
+        flush_buffer(w);
+        if (w->error == ESP_OK) {
+            w->error = httpd_resp_send_chunk(req, NULL, 0);
+        }
+        return w->error;
+    }
+    
+    flush_buffer(w);
+    return w->error;
+}
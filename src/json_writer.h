@@ -0,0 +1,117 @@
+/**
+ * @file json_writer.h
+ * @brief Emissor de JSON compacto sem alocação
+ * 
+ * Escreve o JSON diretamente em um buffer do chamador, sem montar árvore
+ * nem usar o heap. Com uma função de descarga (ex.: httpd_resp_send_chunk),
+ * o buffer é enviado sempre que enche, permitindo respostas maiores que ele.
+ * 
+ * Uso:
+ *     json_writer_t w;
+ *     json_writer_init(&w, buffer, sizeof(buffer));
+ *     json_writer_object_begin(&w, NULL);
+ *     json_writer_add_string(&w, "status", "online");
+ *     json_writer_object_end(&w);
+ *     esp_err_t ret = json_writer_finish(&w);
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Profundidade máxima de objetos/arrays aninhados
+#define JSON_WRITER_MAX_DEPTH 8
+
+// Descarga do buffer cheio (retorno diferente de ESP_OK interrompe a escrita)
+typedef esp_err_t (*json_writer_flush_t)(void *ctx, const char *data, size_t len);
+
+// Estado do emissor (pode ficar na pilha)
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;                 // Bytes pendentes no buffer
+    size_t total;               // Bytes emitidos (em buffer fixo, inclusive os que não couberam)
+    json_writer_flush_t flush;  // NULL: buffer fixo, terminado em '\0'
+    void *flush_ctx;
+    uint8_t depth;
+    bool has_items[JSON_WRITER_MAX_DEPTH];
+    esp_err_t error;            // Primeiro erro (ESP_ERR_INVALID_SIZE: não coube)
+} json_writer_t;
+
+/**
+ * @brief Iniciar escrita em buffer fixo
+ * 
+ * @param w Emissor
+ * @param buf Buffer de saída (recebe o JSON terminado em '\0')
+ * @param size Tamanho do buffer
+ */
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+/**
+ * @brief Iniciar escrita com descarga do buffer quando cheio
+ * 
+ * @param w Emissor
+ * @param buf Buffer intermediário
+ * @param size Tamanho do buffer
+ * @param flush Função chamada com os bytes acumulados
+ * @param ctx Contexto repassado a flush
+ */
+void json_writer_init_stream(json_writer_t *w, char *buf, size_t size,
+                             json_writer_flush_t flush, void *ctx);
+
+/**
+ * @brief Iniciar escrita direto na resposta HTTP (httpd_resp_send_chunk)
+ * 
+ * json_writer_finish() envia o último bloco e encerra a resposta. Se o
+ * JSON inteiro coube no buffer, ele é enviado de uma vez, com
+ * Content-Length, em vez de em blocos.
+ */
+void json_writer_init_httpd(json_writer_t *w, httpd_req_t *req, char *buf, size_t size);
+
+/**
+ * @brief Abrir objeto ou array
+ * 
+ * @param key Nome do campo (NULL na raiz ou dentro de arrays)
+ */
+void json_writer_object_begin(json_writer_t *w, const char *key);
+void json_writer_array_begin(json_writer_t *w, const char *key);
+
+/**
+ * @brief Fechar objeto ou array
+ */
+void json_writer_object_end(json_writer_t *w);
+void json_writer_array_end(json_writer_t *w);
+
+/**
+ * @brief Adicionar valores (key NULL dentro de arrays)
+ */
+void json_writer_add_string(json_writer_t *w, const char *key, const char *value);
+void json_writer_add_int(json_writer_t *w, const char *key, int64_t value);
+void json_writer_add_bool(json_writer_t *w, const char *key, bool value);
+
+/**
+ * @brief Concluir a escrita
+ * 
+ * Em buffer fixo, termina a string com '\0'; com descarga, envia os bytes
+ * pendentes (e, em json_writer_init_httpd, o bloco final da resposta).
+ * 
+ * @return esp_err_t ESP_ERR_INVALID_SIZE se o JSON não coube no buffer
+ *         fixo (w->total + 1 é o tamanho necessário), ou o erro da função
+ *         de descarga
+ */
+esp_err_t json_writer_finish(json_writer_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_WRITER_H
@@ -4,63 +4,1043 @@
  */
 
 #include "ota_handler.h"
+#include "boot_trace.h"
 #include "esp_log.h"
+#include "nvs.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
 #include "esp_system.h"
 #include "esp_partition.h"
+#include "esp_image_format.h"
 #include "esp_crc.h"
+#include "mbedtls/sha256.h"
+#include "miniz.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 
 static const char *TAG = "OTA_HANDLER";
 
+// Formato do stream recebido em ota_write_data()
+typedef enum {
+    OTA_FORMAT_UNKNOWN = 0,   // Aguardando os primeiros bytes
+    OTA_FORMAT_RAW,           // Stream sem compressão
+    OTA_FORMAT_DEFLATE,       // Contêiner OTA_PACK_MAGIC
+} ota_format_t;
+
+// Conteúdo do stream (após descompressão)
+typedef enum {
+    OTA_CONTENT_UNKNOWN = 0,  // Aguardando os primeiros bytes
+    OTA_CONTENT_IMAGE,        // Imagem .bin
+    OTA_CONTENT_DELTA,        // Patch OTA_DELTA_MAGIC
+} ota_content_t;
+
+// Registro de controle do patch: diff_len, extra_len, seek
+#define OTA_DELTA_CTRL_SIZE 12
+
+// Aplicação do patch delta sobre a partição em execução
+typedef struct {
+    const esp_partition_t *source;
+    size_t source_size;
+    int64_t old_pos;
+    uint32_t diff_left;
+    uint32_t extra_left;
+    int32_t seek;
+    uint8_t ctrl[OTA_DELTA_CTRL_SIZE];
+    size_t ctrl_len;
+    uint8_t buf[OTA_DELTA_CHUNK_SIZE];
+} ota_delta_t;
+
+// Descompressor deflate com janela circular de dict_size bytes
+typedef struct {
+    tinfl_decompressor decomp;
+    size_t dict_size;
+    size_t dict_ofs;
+    bool done;
+    uint8_t dict[];
+} ota_inflate_t;
+
 // Estrutura para controle do upgrade
 typedef struct {
     esp_ota_handle_t ota_handle;
     const esp_partition_t *target_partition;
-    size_t total_size;
-    size_t written_size;
+    size_t total_size;        // Bytes a receber (tamanho transferido)
+    size_t received_size;     // Bytes recebidos em ota_write_data()
+    size_t image_size;        // Tamanho da imagem gravada na flash
+    size_t written_size;      // Bytes da imagem já gravados
     bool in_progress;
+    bool raw_write;       // Gravação direta em partição pré-apagada
     char status_message[64];
+    
+    // Verificação incremental: o hash cobre a imagem sem os últimos
+    // OTA_SHA256_SIZE bytes, guardados em tail (hash anexado pelo esptool)
+    mbedtls_sha256_context sha_ctx;
+    uint8_t tail[OTA_SHA256_SIZE];
+    uint8_t header[sizeof(esp_image_header_t)];
+    uint8_t expected_sha256[OTA_SHA256_SIZE];
+    bool has_expected_sha256;
+    
+    // Decodificação do stream
+    ota_format_t format;
+    uint8_t prefix[OTA_PACK_HEADER_SIZE];
+    size_t prefix_len;
+    ota_inflate_t *inflate;
+    ota_content_t content;
+    uint8_t content_hdr[OTA_DELTA_HEADER_SIZE];
+    size_t content_hdr_len;
+    ota_delta_t *delta;
+    size_t checkpoint_offset; // Offset do último checkpoint salvo
 } ota_context_t;
 
 static ota_context_t s_ota_ctx = {0};
 
+// Hash da imagem em execução (calculado sob demanda)
+static uint8_t s_running_hash[OTA_SHA256_SIZE];
+static bool s_running_hash_valid = false;
+
 // Callbacks
 static ota_progress_cb_t s_progress_cb = NULL;
 static ota_complete_cb_t s_complete_cb = NULL;
 static ota_error_cb_t s_error_cb = NULL;
 
-// Event group para sincronização
-static EventGroupHandle_t s_ota_event_group;
-#define OTA_COMPLETE_BIT BIT0
-#define OTA_ERROR_BIT    BIT1
+// Snapshot consistente do progresso, lido por ota_get_progress()
+static ota_progress_t s_progress = {0};
+static portMUX_TYPE s_progress_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Task de despacho do progresso: criada sob demanda, dorme em notificação
+// e encerra após OTA_DISPATCH_IDLE_MS sem upgrade nem apagamento ativos
+#define OTA_DISPATCH_TASK_STACK    4096
+#define OTA_DISPATCH_TASK_PRIORITY 4
+#define OTA_DISPATCH_IDLE_MS       5000
+
+static TaskHandle_t s_dispatch_task = NULL;
+static SemaphoreHandle_t s_dispatch_mutex = NULL;
+
+// Event group para sincronização
+static EventGroupHandle_t s_ota_event_group;
+#define OTA_COMPLETE_BIT      BIT0
+#define OTA_ERROR_BIT         BIT1
+#define OTA_PIPELINE_DONE_BIT BIT2
+#define OTA_ERASE_STEP_BIT    BIT3
+
+// Pipeline de gravação (produtor: recepção HTTP, consumidor: flash)
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} ota_pipeline_item_t;
+
+typedef struct {
+    uint8_t *storage;
+    QueueHandle_t free_queue;
+    QueueHandle_t filled_queue;
+    volatile esp_err_t result;
+    volatile bool abort;
+    bool active;
+} ota_pipeline_t;
+
+static ota_pipeline_t s_pipeline = {0};
+
+#define OTA_PIPELINE_TASK_STACK    4096
+#define OTA_PIPELINE_TASK_PRIORITY 5
+
+// Retomada de upload: registro persistido em NVS
+#define OTA_RESUME_NAMESPACE "ota_resume"
+#define OTA_RESUME_KEY       "checkpoint"
+
+typedef struct {
+    char partition[17];
+    uint32_t total_size;
+    uint32_t offset;
+    uint8_t header[sizeof(esp_image_header_t)];
+    uint8_t expected_sha256[OTA_SHA256_SIZE];
+    bool has_expected_sha256;
+    mbedtls_sha256_context sha_ctx;
+} ota_resume_record_t;
+
+// Último checkpoint (offset 0 = nenhum)
+static ota_resume_record_t s_resume = {0};
+
+// Pré-apagamento: o prefixo [0, erased_bytes) da partição está apagado
+typedef struct {
+    const esp_partition_t *partition;
+    size_t erased_bytes;
+    size_t target_bytes;
+    esp_err_t result;
+    bool running;
+    bool stale;           // Partição regravada: estado descartado ao fim da task
+} ota_erase_ctx_t;
+
+static ota_erase_ctx_t s_erase = {0};
+static portMUX_TYPE s_erase_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_pre_erase_enabled = OTA_PRE_ERASE_DEFAULT_ENABLED;
+
+#define OTA_ERASE_TASK_STACK    3072
+#define OTA_ERASE_TASK_PRIORITY 4
+#define OTA_SECTOR_SIZE         4096
+
+/**
+ * @brief Task de despacho do progresso OTA
+ * 
+ * Várias atualizações acumuladas enquanto o callback executa são
+ * consumidas de uma só vez, e o callback só é chamado quando o
+ * percentual ou o estado mudaram desde o último envio.
+ */
+static void ota_progress_dispatch_task(void *pvParameters)
+{
+    ota_progress_t last = {0};
+    bool has_last = false;
+    
+    while (1) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OTA_DISPATCH_IDLE_MS)) == 0) {
+            // Ocioso: encerrar se não houver upgrade nem apagamento, a menos
+            // que uma notificação tenha chegado antes de obter o mutex
+            xSemaphoreTake(s_dispatch_mutex, portMAX_DELAY);
+            ota_progress_t current;
+            ota_get_progress(&current);
+            bool idle = !current.in_progress && !current.erase_in_progress &&
+                        ulTaskNotifyTake(pdTRUE, 0) == 0;
+            if (idle) {
+                s_dispatch_task = NULL;
+            }
+            xSemaphoreGive(s_dispatch_mutex);
+            
+            if (idle) {
+                break;
+            }
+        }
+        
+        ota_progress_t progress;
+        ota_get_progress(&progress);
+        
+        bool changed = !has_last ||
+                       progress.percentage != last.percentage ||
+                       progress.in_progress != last.in_progress ||
+                       progress.erase_in_progress != last.erase_in_progress ||
+                       progress.erase_bytes != last.erase_bytes ||
+                       progress.resume_offset != last.resume_offset ||
+                       strcmp(progress.status_message, last.status_message) != 0;
+        if (changed && s_progress_cb) {
+            s_progress_cb(&progress);
+            last = progress;
+            has_last = true;
+        }
+    }
+    
+    ESP_LOGD(TAG, "Despacho de progresso encerrado");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Atualizar o snapshot de progresso e acordar o despacho
+ * 
+ * @param upgrade_fields true se o chamador é dono de s_ota_ctx (fluxo de
+ *                       upgrade); o pré-apagamento atualiza só seus campos
+ */
+static void progress_update(bool upgrade_fields)
+{
+    ota_progress_t upgrade = {0};
+    if (upgrade_fields) {
+        upgrade.bytes_written = s_ota_ctx.received_size;
+        upgrade.total_bytes = s_ota_ctx.total_size;
+        upgrade.percentage = (s_ota_ctx.total_size > 0) ?
+            (s_ota_ctx.received_size * 100) / s_ota_ctx.total_size : 0;
+        upgrade.in_progress = s_ota_ctx.in_progress;
+        strncpy(upgrade.status_message, s_ota_ctx.status_message,
+                sizeof(upgrade.status_message) - 1);
+        upgrade.resume_offset = s_resume.offset;
+    }
+    
+    portENTER_CRITICAL(&s_erase_lock);
+    size_t erase_bytes = s_erase.erased_bytes;
+    size_t erase_total = s_erase.target_bytes;
+    bool erase_running = s_erase.running;
+    portEXIT_CRITICAL(&s_erase_lock);
+    
+    portENTER_CRITICAL(&s_progress_lock);
+    if (upgrade_fields) {
+        s_progress = upgrade;
+    }
+    s_progress.erase_bytes = erase_bytes;
+    s_progress.erase_total = erase_total;
+    s_progress.erase_in_progress = erase_running;
+    portEXIT_CRITICAL(&s_progress_lock);
+    
+    if (!s_progress_cb || !s_dispatch_mutex) {
+        return;
+    }
+    
+    // Criar a task de despacho na primeira atualização
+    xSemaphoreTake(s_dispatch_mutex, portMAX_DELAY);
+    if (!s_dispatch_task &&
+        xTaskCreate(ota_progress_dispatch_task, "ota_progress", OTA_DISPATCH_TASK_STACK,
+                    NULL, OTA_DISPATCH_TASK_PRIORITY, &s_dispatch_task) != pdPASS) {
+        s_dispatch_task = NULL;
+        ESP_LOGW(TAG, "Erro ao criar task de progresso");
+    }
+    if (s_dispatch_task) {
+        xTaskNotifyGive(s_dispatch_task);
+    }
+    xSemaphoreGive(s_dispatch_mutex);
+}
+
+/**
+ * @brief Task de gravação do pipeline OTA
+ * 
+ * Consome os buffers preenchidos e os grava na flash. Após um erro os
+ * buffers continuam sendo devolvidos (sem gravação), para que o produtor
+ * nunca fique bloqueado e possa observar o erro.
+ */
+static void ota_pipeline_writer_task(void *pvParameters)
+{
+    ota_pipeline_item_t item;
+    
+    while (xQueueReceive(s_pipeline.filled_queue, &item, portMAX_DELAY) == pdTRUE) {
+        // Buffer nulo sinaliza fim do stream
+        if (!item.data) {
+            break;
+        }
+        
+        if (s_pipeline.result == ESP_OK && !s_pipeline.abort) {
+            esp_err_t ret = ota_write_data(item.data, item.len);
+            if (ret != ESP_OK) {
+                s_pipeline.result = ret;
+            }
+        }
+        
+        xQueueSend(s_pipeline.free_queue, &item.data, portMAX_DELAY);
+    }
+    
+    xEventGroupSetBits(s_ota_event_group, OTA_PIPELINE_DONE_BIT);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Task de pré-apagamento da partição OTA
+ * 
+ * Apaga a partição em passos de OTA_PRE_ERASE_STEP_SIZE até atingir
+ * target_bytes, que pode ser ampliado enquanto a task está rodando.
+ */
+static void ota_erase_task(void *pvParameters)
+{
+    while (1) {
+        portENTER_CRITICAL(&s_erase_lock);
+        const esp_partition_t *partition = s_erase.partition;
+        size_t offset = s_erase.erased_bytes;
+        size_t pending = s_erase.target_bytes - offset;
+        if (pending == 0 || s_erase.result != ESP_OK) {
+            s_erase.running = false;
+            portEXIT_CRITICAL(&s_erase_lock);
+            break;
+        }
+        portEXIT_CRITICAL(&s_erase_lock);
+        
+        size_t step = pending < OTA_PRE_ERASE_STEP_SIZE ? pending : OTA_PRE_ERASE_STEP_SIZE;
+        esp_err_t ret = esp_partition_erase_range(partition, offset, step);
+        
+        portENTER_CRITICAL(&s_erase_lock);
+        if (ret == ESP_OK) {
+            s_erase.erased_bytes += step;
+        } else {
+            s_erase.result = ret;
+        }
+        portEXIT_CRITICAL(&s_erase_lock);
+        
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Erro no pré-apagamento em 0x%x: %s",
+                     (unsigned)offset, esp_err_to_name(ret));
+        }
+        
+        xEventGroupSetBits(s_ota_event_group, OTA_ERASE_STEP_BIT);
+        progress_update(false);
+    }
+    
+    ESP_LOGI(TAG, "Pré-apagamento concluído: %u bytes", (unsigned)s_erase.erased_bytes);
+    
+    portENTER_CRITICAL(&s_erase_lock);
+    if (s_erase.stale) {
+        memset(&s_erase, 0, sizeof(s_erase));
+    }
+    portEXIT_CRITICAL(&s_erase_lock);
+    
+    xEventGroupSetBits(s_ota_event_group, OTA_ERASE_STEP_BIT);
+    progress_update(false);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Verificar se a partição guarda uma imagem aguardando reinício
+ * 
+ * Após esp_ota_set_boot_partition() o firmware antigo continua rodando até
+ * o reinício, e a "próxima partição OTA" é justamente a recém-gravada.
+ */
+static bool is_pending_boot_partition(const esp_partition_t *partition)
+{
+    const esp_partition_t *boot = esp_ota_get_boot_partition();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    return boot && running && boot->address != running->address &&
+           partition->address == boot->address;
+}
+
+/**
+ * @brief Ampliar a área de pré-apagamento e iniciar a task se necessário
+ */
+static esp_err_t schedule_erase(const esp_partition_t *partition, size_t image_size)
+{
+    if (is_pending_boot_partition(partition)) {
+        ESP_LOGW(TAG, "Pré-apagamento recusado: %s tem imagem aguardando reinício", partition->label);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    size_t target = (image_size == 0 || image_size > partition->size) ? partition->size : image_size;
+    target = (target + OTA_SECTOR_SIZE - 1) & ~(size_t)(OTA_SECTOR_SIZE - 1);
+    
+    bool start_task = false;
+    portENTER_CRITICAL(&s_erase_lock);
+    if (s_erase.partition != partition || s_erase.stale) {
+        if (s_erase.running) {
+            // Não trocar de partição com um apagamento em andamento
+            portEXIT_CRITICAL(&s_erase_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+        s_erase.partition = partition;
+        s_erase.erased_bytes = 0;
+        s_erase.target_bytes = 0;
+        s_erase.result = ESP_OK;
+        s_erase.stale = false;
+    }
+    if (target > s_erase.target_bytes) {
+        s_erase.target_bytes = target;
+    }
+    if (!s_erase.running && s_erase.erased_bytes < s_erase.target_bytes) {
+        s_erase.running = true;
+        s_erase.result = ESP_OK;
+        start_task = true;
+    }
+    portEXIT_CRITICAL(&s_erase_lock);
+    
+    if (start_task &&
+        xTaskCreate(ota_erase_task, "ota_erase", OTA_ERASE_TASK_STACK,
+                    NULL, OTA_ERASE_TASK_PRIORITY, NULL) != pdPASS) {
+        portENTER_CRITICAL(&s_erase_lock);
+        s_erase.running = false;
+        portEXIT_CRITICAL(&s_erase_lock);
+        ESP_LOGE(TAG, "Erro ao criar task de pré-apagamento");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    if (start_task) {
+        ESP_LOGI(TAG, "Pré-apagamento de %s iniciado (%u bytes)",
+                 partition->label, (unsigned)target);
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Invalidar o estado de pré-apagamento após gravar na partição
+ */
+static void invalidate_erase(void)
+{
+    portENTER_CRITICAL(&s_erase_lock);
+    if (s_erase.running) {
+        // Interromper a task no próximo passo; ela descarta o estado ao sair
+        s_erase.target_bytes = s_erase.erased_bytes;
+        s_erase.stale = true;
+    } else {
+        memset(&s_erase, 0, sizeof(s_erase));
+    }
+    portEXIT_CRITICAL(&s_erase_lock);
+}
+
+/**
+ * @brief Aguardar o pré-apagamento cobrir a região [0, end)
+ */
+static esp_err_t wait_erased(size_t end)
+{
+    while (1) {
+        portENTER_CRITICAL(&s_erase_lock);
+        size_t erased = s_erase.erased_bytes;
+        bool running = s_erase.running;
+        esp_err_t result = s_erase.result;
+        portEXIT_CRITICAL(&s_erase_lock);
+        
+        if (erased >= end) {
+            return ESP_OK;
+        }
+        if (result != ESP_OK) {
+            return result;
+        }
+        if (!running) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        
+        xEventGroupWaitBits(s_ota_event_group, OTA_ERASE_STEP_BIT,
+                            pdTRUE, pdFALSE, pdMS_TO_TICKS(1000));
+    }
+}
+
+/**
+ * @brief Atualizar o hash incremental com um bloco da imagem
+ * 
+ * Bytes dentro dos últimos OTA_SHA256_SIZE da imagem vão para tail; o
+ * restante alimenta o SHA-256. O cabeçalho é copiado para consulta do
+ * flag hash_appended.
+ */
+static void hash_update(size_t offset, const uint8_t *data, size_t size)
+{
+    size_t total = s_ota_ctx.image_size;
+    size_t hash_limit = total > OTA_SHA256_SIZE ? total - OTA_SHA256_SIZE : 0;
+    
+    if (offset < sizeof(s_ota_ctx.header)) {
+        size_t n = sizeof(s_ota_ctx.header) - offset;
+        memcpy(s_ota_ctx.header + offset, data, n < size ? n : size);
+    }
+    
+    if (offset < hash_limit) {
+        size_t n = hash_limit - offset;
+        if (n > size) {
+            n = size;
+        }
+        mbedtls_sha256_update(&s_ota_ctx.sha_ctx, data, n);
+        offset += n;
+        data += n;
+        size -= n;
+    }
+    
+    if (size > 0) {
+        memcpy(s_ota_ctx.tail + (offset - hash_limit), data, size);
+    }
+}
+
+/**
+ * @brief Finalizar o hash incremental e validar a imagem
+ * 
+ * Confere o SHA-256 anexado pelo esptool (quando hash_appended) e o hash
+ * do arquivo completo informado com ota_set_expected_sha256().
+ */
+static esp_err_t hash_verify(void)
+{
+    uint8_t digest[OTA_SHA256_SIZE];
+    const esp_image_header_t *header = (const esp_image_header_t *)s_ota_ctx.header;
+    
+    if (s_ota_ctx.has_expected_sha256) {
+        // Hash do arquivo inteiro = prefixo + tail
+        mbedtls_sha256_context full;
+        mbedtls_sha256_init(&full);
+        mbedtls_sha256_clone(&full, &s_ota_ctx.sha_ctx);
+        mbedtls_sha256_update(&full, s_ota_ctx.tail, sizeof(s_ota_ctx.tail));
+        mbedtls_sha256_finish(&full, digest);
+        mbedtls_sha256_free(&full);
+        
+        if (memcmp(digest, s_ota_ctx.expected_sha256, OTA_SHA256_SIZE) != 0) {
+            ESP_LOGE(TAG, "SHA-256 da imagem difere do esperado");
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+    
+    mbedtls_sha256_finish(&s_ota_ctx.sha_ctx, digest);
+    if (header->hash_appended == 1 &&
+        memcmp(digest, s_ota_ctx.tail, OTA_SHA256_SIZE) != 0) {
+        ESP_LOGE(TAG, "SHA-256 anexado à imagem não confere");
+        return ESP_ERR_INVALID_CRC;
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Carregar o checkpoint de retomada salvo em NVS
+ */
+static void load_resume_record(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(OTA_RESUME_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    
+    // Registro de outra versão do firmware (tamanho diferente) é ignorado
+    size_t required_size = sizeof(s_resume);
+    if (nvs_get_blob(nvs_handle, OTA_RESUME_KEY, &s_resume, &required_size) != ESP_OK ||
+        required_size != sizeof(s_resume)) {
+        memset(&s_resume, 0, sizeof(s_resume));
+    }
+    nvs_close(nvs_handle);
+    
+    if (s_resume.offset > 0) {
+        ESP_LOGI(TAG, "Upload interrompido em %s: %u/%u bytes",
+                 s_resume.partition, (unsigned)s_resume.offset, (unsigned)s_resume.total_size);
+    }
+}
+
+/**
+ * @brief Descartar o checkpoint de retomada
+ */
+static void clear_resume_record(void)
+{
+    if (s_resume.offset == 0) {
+        return;
+    }
+    
+    memset(&s_resume, 0, sizeof(s_resume));
+    
+    nvs_handle_t nvs_handle;
+    if (nvs_open(OTA_RESUME_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_erase_key(nvs_handle, OTA_RESUME_KEY);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+}
+
+/**
+ * @brief Salvar checkpoint de retomada no offset de escrita atual
+ * 
+ * Só é chamado em limites de setor e antes dos últimos OTA_SHA256_SIZE
+ * bytes, onde o contexto SHA-256 cobre exatamente [0, written_size).
+ */
+static void save_checkpoint(void)
+{
+    ota_resume_record_t *rec = &s_resume;
+    
+    memset(rec, 0, sizeof(*rec));
+    strncpy(rec->partition, s_ota_ctx.target_partition->label, sizeof(rec->partition) - 1);
+    rec->total_size = s_ota_ctx.total_size;
+    rec->offset = s_ota_ctx.written_size;
+    memcpy(rec->header, s_ota_ctx.header, sizeof(rec->header));
+    memcpy(rec->expected_sha256, s_ota_ctx.expected_sha256, sizeof(rec->expected_sha256));
+    rec->has_expected_sha256 = s_ota_ctx.has_expected_sha256;
+    mbedtls_sha256_clone(&rec->sha_ctx, &s_ota_ctx.sha_ctx);
+    
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(OTA_RESUME_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, OTA_RESUME_KEY, rec, sizeof(*rec));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Erro ao salvar checkpoint OTA: %s", esp_err_to_name(ret));
+        memset(rec, 0, sizeof(*rec));
+        return;
+    }
+    
+    s_ota_ctx.checkpoint_offset = s_ota_ctx.written_size;
+    ESP_LOGD(TAG, "Checkpoint OTA: %u bytes", (unsigned)s_ota_ctx.written_size);
+}
+
+/**
+ * @brief Liberar o estado de decodificação do stream
+ */
+static void release_decoder(void)
+{
+    free(s_ota_ctx.inflate);
+    s_ota_ctx.inflate = NULL;
+    free(s_ota_ctx.delta);
+    s_ota_ctx.delta = NULL;
+}
+
+/**
+ * @brief Ler inteiro de 32 bits little-endian
+ */
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Gravar bytes da imagem na partição de destino
+ * 
+ * Último estágio da decodificação: valida limites e magic number, grava
+ * na flash e atualiza o hash incremental.
+ */
+static esp_err_t image_write(const uint8_t *data, size_t size)
+{
+    // Não aceitar mais bytes do que o tamanho da imagem
+    if (size > s_ota_ctx.image_size - s_ota_ctx.written_size) {
+        ESP_LOGE(TAG, "Dados excedem o tamanho anunciado da imagem");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // Rejeitar cedo imagens sem o magic number do ESP-IDF
+    if (s_ota_ctx.written_size == 0 && data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "Magic number inválido: 0x%x", data[0]);
+        return ESP_ERR_INVALID_CRC;
+    }
+    
+    esp_err_t ret;
+    if (s_ota_ctx.raw_write) {
+        // Não ultrapassar a região já apagada
+        ret = wait_erased(s_ota_ctx.written_size + size);
+        if (ret == ESP_OK) {
+            ret = esp_partition_write(s_ota_ctx.target_partition,
+                                      s_ota_ctx.written_size, data, size);
+        }
+    } else {
+        ret = esp_ota_write(s_ota_ctx.ota_handle, data, size);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao escrever dados OTA: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    hash_update(s_ota_ctx.written_size, data, size);
+    s_ota_ctx.written_size += size;
+    
+    // Checkpoint para retomada (somente imagens .bin sem compressão)
+    if (s_ota_ctx.format == OTA_FORMAT_RAW && s_ota_ctx.content == OTA_CONTENT_IMAGE &&
+        s_ota_ctx.written_size - s_ota_ctx.checkpoint_offset >= OTA_RESUME_CHECKPOINT_SIZE &&
+        s_ota_ctx.written_size % OTA_SECTOR_SIZE == 0 &&
+        s_ota_ctx.written_size + OTA_SHA256_SIZE <= s_ota_ctx.image_size) {
+        save_checkpoint();
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Aplicar um bloco do patch delta
+ * 
+ * Os bytes de diff são somados à origem, lida da partição em execução em
+ * blocos de OTA_DELTA_CHUNK_SIZE; os bytes extras são copiados como estão.
+ */
+static esp_err_t delta_feed(const uint8_t *data, size_t size)
+{
+    ota_delta_t *d = s_ota_ctx.delta;
+    
+    while (size > 0) {
+        if (d->diff_left > 0) {
+            size_t n = size < d->diff_left ? size : d->diff_left;
+            if (n > sizeof(d->buf)) {
+                n = sizeof(d->buf);
+            }
+            
+            if (d->old_pos < 0 || d->old_pos + (int64_t)n > (int64_t)d->source_size) {
+                ESP_LOGE(TAG, "Patch referencia dados fora da imagem de origem");
+                return ESP_ERR_INVALID_SIZE;
+            }
+            
+            esp_err_t ret = esp_partition_read(d->source, (size_t)d->old_pos, d->buf, n);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            
+            for (size_t i = 0; i < n; i++) {
+                d->buf[i] += data[i];
+            }
+            
+            ret = image_write(d->buf, n);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            
+            d->old_pos += n;
+            d->diff_left -= n;
+            data += n;
+            size -= n;
+        } else if (d->extra_left > 0) {
+            size_t n = size < d->extra_left ? size : d->extra_left;
+            
+            esp_err_t ret = image_write(data, n);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            
+            d->extra_left -= n;
+            data += n;
+            size -= n;
+        } else {
+            if (s_ota_ctx.written_size == s_ota_ctx.image_size) {
+                ESP_LOGE(TAG, "Dados após o fim do patch");
+                return ESP_ERR_INVALID_SIZE;
+            }
+            
+            // Registro anterior concluído: aplicar o deslocamento na origem
+            if (d->ctrl_len == 0) {
+                d->old_pos += d->seek;
+                d->seek = 0;
+            }
+            
+            d->ctrl[d->ctrl_len++] = *data++;
+            size--;
+            
+            if (d->ctrl_len == OTA_DELTA_CTRL_SIZE) {
+                d->ctrl_len = 0;
+                d->diff_left = read_le32(d->ctrl);
+                d->extra_left = read_le32(d->ctrl + 4);
+                d->seek = (int32_t)read_le32(d->ctrl + 8);
+                
+                size_t remaining = s_ota_ctx.image_size - s_ota_ctx.written_size;
+                if (d->diff_left > remaining || d->extra_left > remaining - d->diff_left) {
+                    ESP_LOGE(TAG, "Registro do patch excede o tamanho da nova imagem");
+                    return ESP_ERR_INVALID_SIZE;
+                }
+            }
+        }
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Interpretar o cabeçalho do patch delta
+ */
+static esp_err_t parse_delta_header(void)
+{
+    const uint8_t *hdr = s_ota_ctx.content_hdr;
+    size_t new_size = read_le32(hdr + 8);
+    size_t old_size = read_le32(hdr + 12);
+    
+    if (hdr[4] != OTA_DELTA_VERSION) {
+        ESP_LOGE(TAG, "Versão de patch não suportada: %d", hdr[4]);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    const esp_partition_t *source = esp_ota_get_running_partition();
+    if (!source || source == s_ota_ctx.target_partition) {
+        ESP_LOGE(TAG, "Patch delta exige destino diferente da partição em execução");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (new_size == 0 || new_size > s_ota_ctx.target_partition->size ||
+        old_size == 0 || old_size > source->size) {
+        ESP_LOGE(TAG, "Tamanhos inválidos no patch: %u -> %u bytes",
+                 (unsigned)old_size, (unsigned)new_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // O patch só é válido sobre a mesma imagem usada para gerá-lo
+    uint8_t running_hash[OTA_SHA256_SIZE];
+    esp_err_t ret = ota_get_firmware_hash(running_hash, sizeof(running_hash));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (memcmp(running_hash, hdr + 16, OTA_SHA256_SIZE) != 0) {
+        ESP_LOGE(TAG, "Patch gerado para outra imagem de origem");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    
+    ota_delta_t *d = calloc(1, sizeof(ota_delta_t));
+    if (!d) {
+        return ESP_ERR_NO_MEM;
+    }
+    d->source = source;
+    d->source_size = old_size;
+    
+    s_ota_ctx.delta = d;
+    s_ota_ctx.image_size = new_size;
+    s_ota_ctx.content = OTA_CONTENT_DELTA;
+    
+    if (s_ota_ctx.raw_write) {
+        schedule_erase(s_ota_ctx.target_partition, new_size);
+    }
+    
+    ESP_LOGI(TAG, "Patch delta: %s (%u bytes) -> %u bytes",
+             source->label, (unsigned)old_size, (unsigned)new_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Encaminhar o conteúdo (já descomprimido) para imagem ou patch
+ */
+static esp_err_t content_write(const uint8_t *data, size_t size)
+{
+    const size_t magic_len = sizeof(OTA_DELTA_MAGIC) - 1;
+    
+    while (s_ota_ctx.content == OTA_CONTENT_UNKNOWN && size > 0) {
+        s_ota_ctx.content_hdr[s_ota_ctx.content_hdr_len++] = *data++;
+        size--;
+        
+        size_t len = s_ota_ctx.content_hdr_len;
+        esp_err_t ret = ESP_OK;
+        if (memcmp(s_ota_ctx.content_hdr, OTA_DELTA_MAGIC, len < magic_len ? len : magic_len) != 0) {
+            // Imagem binária: os bytes já lidos pertencem à imagem
+            s_ota_ctx.content = OTA_CONTENT_IMAGE;
+            ret = image_write(s_ota_ctx.content_hdr, len);
+        } else if (len == OTA_DELTA_HEADER_SIZE) {
+            ret = parse_delta_header();
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    if (size == 0) {
+        return ESP_OK;
+    }
+    
+    return (s_ota_ctx.content == OTA_CONTENT_DELTA) ? delta_feed(data, size) :
+                                                      image_write(data, size);
+}
+
+/**
+ * @brief Descomprimir um bloco do stream deflate direto para a flash
+ * 
+ * A saída é produzida na janela circular e gravada à medida que é gerada,
+ * de modo que a memória usada não depende do tamanho da imagem.
+ */
+static esp_err_t inflate_feed(const uint8_t *data, size_t size, bool last)
+{
+    ota_inflate_t *inf = s_ota_ctx.inflate;
+    
+    while (!inf->done) {
+        size_t in_bytes = size;
+        size_t out_bytes = inf->dict_size - inf->dict_ofs;
+        tinfl_status status = tinfl_decompress(&inf->decomp, data, &in_bytes,
+                                               inf->dict, inf->dict + inf->dict_ofs, &out_bytes,
+                                               last ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_bytes;
+        size -= in_bytes;
+        
+        if (out_bytes > 0) {
+            esp_err_t ret = content_write(inf->dict + inf->dict_ofs, out_bytes);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            inf->dict_ofs = (inf->dict_ofs + out_bytes) & (inf->dict_size - 1);
+        }
+        
+        if (status < TINFL_STATUS_DONE) {
+            ESP_LOGE(TAG, "Stream comprimido inválido (%d)", (int)status);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        
+        if (status == TINFL_STATUS_DONE) {
+            inf->done = true;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && size == 0) {
+            return ESP_OK;
+        }
+    }
+    
+    if (size > 0) {
+        ESP_LOGE(TAG, "Dados após o fim do stream comprimido");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Interpretar o cabeçalho do contêiner comprimido
+ */
+static esp_err_t parse_pack_header(void)
+{
+    const uint8_t *hdr = s_ota_ctx.prefix;
+    uint8_t window_bits = hdr[5];
+    size_t image_size = read_le32(hdr + 8);
+    
+    if (hdr[4] != OTA_PACK_VERSION) {
+        ESP_LOGE(TAG, "Versão de contêiner não suportada: %d", hdr[4]);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (window_bits < 9 || window_bits > OTA_PACK_MAX_WINDOW_BITS) {
+        ESP_LOGE(TAG, "Janela de compressão inválida: %d bits", window_bits);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (image_size == 0 || image_size > s_ota_ctx.target_partition->size) {
+        ESP_LOGE(TAG, "Imagem descomprimida não cabe na partição: %u bytes", (unsigned)image_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    size_t dict_size = (size_t)1 << window_bits;
+    ota_inflate_t *inf = malloc(sizeof(ota_inflate_t) + dict_size);
+    if (!inf) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    tinfl_init(&inf->decomp);
+    inf->dict_size = dict_size;
+    inf->dict_ofs = 0;
+    inf->done = false;
+    
+    s_ota_ctx.inflate = inf;
+    s_ota_ctx.image_size = image_size;
+    s_ota_ctx.format = OTA_FORMAT_DEFLATE;
+    
+    // A imagem descomprimida é maior que o stream: ampliar o pré-apagamento
+    if (s_ota_ctx.raw_write) {
+        schedule_erase(s_ota_ctx.target_partition, image_size);
+    }
+    
+    ESP_LOGI(TAG, "Imagem comprimida: %u -> %u bytes (janela de %u bytes)",
+             (unsigned)s_ota_ctx.total_size, (unsigned)image_size, (unsigned)dict_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Identificar o formato do stream pelos primeiros bytes
+ * 
+ * @param end true se não haverá mais bytes no stream
+ */
+static esp_err_t detect_format(bool end)
+{
+    const size_t magic_len = sizeof(OTA_PACK_MAGIC) - 1;
+    size_t cmp_len = s_ota_ctx.prefix_len < magic_len ? s_ota_ctx.prefix_len : magic_len;
+    
+    if (memcmp(s_ota_ctx.prefix, OTA_PACK_MAGIC, cmp_len) != 0) {
+        // Stream sem compressão: os bytes já lidos pertencem ao conteúdo
+        s_ota_ctx.format = OTA_FORMAT_RAW;
+        return content_write(s_ota_ctx.prefix, s_ota_ctx.prefix_len);
+    }
+    
+    if (s_ota_ctx.prefix_len < OTA_PACK_HEADER_SIZE) {
+        return end ? ESP_ERR_INVALID_SIZE : ESP_OK;
+    }
+    
+    return parse_pack_header();
+}
 
 /**
- * @brief Task para processar progresso OTA
+ * @brief Encaminhar bytes recebidos ao estágio de decodificação
  */
-static void ota_progress_task(void *pvParameters)
+static esp_err_t decode_payload(const uint8_t *data, size_t size, bool last)
 {
-    while (1) {
-        if (s_ota_ctx.in_progress && s_progress_cb) {
-            ota_progress_t progress = {0};
-            progress.bytes_written = s_ota_ctx.written_size;
-            progress.total_bytes = s_ota_ctx.total_size;
-            progress.percentage = (s_ota_ctx.total_size > 0) ? 
-                (s_ota_ctx.written_size * 100) / s_ota_ctx.total_size : 0;
-            progress.in_progress = s_ota_ctx.in_progress;
-            strncpy(progress.status_message, s_ota_ctx.status_message, 
-                   sizeof(progress.status_message) - 1);
-            
-            s_progress_cb(&progress);
-        }
+    while (s_ota_ctx.format == OTA_FORMAT_UNKNOWN && size > 0) {
+        s_ota_ctx.prefix[s_ota_ctx.prefix_len++] = *data++;
+        size--;
         
-        vTaskDelay(pdMS_TO_TICKS(100));
+        esp_err_t ret = detect_format(last && size == 0);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    if (size == 0) {
+        return ESP_OK;
+    }
+    
+    switch (s_ota_ctx.format) {
+        case OTA_FORMAT_RAW:
+            return content_write(data, size);
+        case OTA_FORMAT_DEFLATE:
+            return inflate_feed(data, size, last);
+        default:
+            return ESP_ERR_INVALID_STATE;
+    }
+}
+
+/**
+ * @brief Liberar buffers e filas do pipeline
+ */
+static void pipeline_release(void)
+{
+    if (s_pipeline.free_queue) {
+        vQueueDelete(s_pipeline.free_queue);
+    }
+    if (s_pipeline.filled_queue) {
+        vQueueDelete(s_pipeline.filled_queue);
     }
+    free(s_pipeline.storage);
+    memset(&s_pipeline, 0, sizeof(s_pipeline));
 }
 
 /**
@@ -107,6 +1087,111 @@ static const esp_partition_t* get_partition_by_name(const char *name)
     return NULL;
 }
 
+/**
+ * @brief Resolver partição de destino (NULL = próxima partição OTA)
+ */
+static const esp_partition_t* resolve_target_partition(const char *partition_name)
+{
+    if (!partition_name || partition_name[0] == '\0') {
+        return esp_ota_get_next_update_partition(NULL);
+    }
+    
+    return get_partition_by_name(partition_name);
+}
+
+/**
+ * @brief Abrir sessão OTA na partição de destino
+ */
+static esp_err_t begin_upgrade(const esp_partition_t *target, size_t size)
+{
+    if (s_ota_ctx.in_progress) {
+        ESP_LOGE(TAG, "Upgrade OTA já em progresso");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!is_valid_ota_partition(target)) {
+        ESP_LOGE(TAG, "Partição inválida para OTA: %s", target ? target->label : "(null)");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Verificar tamanho
+    if (size > target->size) {
+        ESP_LOGE(TAG, "Firmware muito grande: %u > %u",
+                 (unsigned)size, (unsigned)target->size);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Um novo upload substitui qualquer upload interrompido
+    clear_resume_record();
+    
+    // Com pré-apagamento a gravação é feita direto na partição, enquanto
+    // a task de apagamento se mantém à frente do ponto de escrita.
+    // Partições criptografadas continuam pelo caminho esp_ota_*.
+    s_ota_ctx.raw_write = s_pre_erase_enabled && !target->encrypted &&
+                          schedule_erase(target, size) == ESP_OK;
+    
+    // Iniciar upgrade
+    if (!s_ota_ctx.raw_write) {
+        // esp_ota_begin() apaga e regrava a partição por conta própria
+        invalidate_erase();
+        esp_err_t ret = esp_ota_begin(target, 0, &s_ota_ctx.ota_handle);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Erro ao iniciar OTA: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    // Configurar contexto
+    s_ota_ctx.target_partition = target;
+    s_ota_ctx.total_size = size;
+    s_ota_ctx.received_size = 0;
+    s_ota_ctx.image_size = size;
+    s_ota_ctx.written_size = 0;
+    s_ota_ctx.format = OTA_FORMAT_UNKNOWN;
+    s_ota_ctx.prefix_len = 0;
+    s_ota_ctx.inflate = NULL;
+    s_ota_ctx.content = OTA_CONTENT_UNKNOWN;
+    s_ota_ctx.content_hdr_len = 0;
+    s_ota_ctx.delta = NULL;
+    s_ota_ctx.checkpoint_offset = 0;
+    s_ota_ctx.has_expected_sha256 = false;
+    memset(s_ota_ctx.header, 0, sizeof(s_ota_ctx.header));
+    mbedtls_sha256_init(&s_ota_ctx.sha_ctx);
+    mbedtls_sha256_starts(&s_ota_ctx.sha_ctx, 0);
+    s_ota_ctx.in_progress = true;
+    strcpy(s_ota_ctx.status_message, "Iniciando upgrade...");
+    progress_update(true);
+    
+    ESP_LOGI(TAG, "Upgrade OTA iniciado para partição: %s (%u bytes)",
+             target->label, (unsigned)size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Encerrar sessão OTA após erro de escrita/finalização
+ */
+static void fail_upgrade(esp_err_t err, const char *message, bool abort_handle)
+{
+    if (abort_handle && !s_ota_ctx.raw_write) {
+        esp_ota_abort(s_ota_ctx.ota_handle);
+    }
+    
+    // Partição parcialmente gravada: o prefixo apagado não vale mais
+    invalidate_erase();
+    
+    mbedtls_sha256_free(&s_ota_ctx.sha_ctx);
+    release_decoder();
+    clear_resume_record();
+    s_ota_ctx.in_progress = false;
+    strncpy(s_ota_ctx.status_message, message, sizeof(s_ota_ctx.status_message) - 1);
+    s_ota_ctx.status_message[sizeof(s_ota_ctx.status_message) - 1] = '\0';
+    progress_update(true);
+    
+    if (s_error_cb) {
+        s_error_cb(err);
+    }
+}
+
 esp_err_t init_ota_handler(void)
 {
     ESP_LOGI(TAG, "Inicializando handler OTA");
@@ -120,9 +1205,17 @@ esp_err_t init_ota_handler(void)
     
     // Inicializar contexto
     memset(&s_ota_ctx, 0, sizeof(ota_context_t));
+    int trace = boot_trace_begin("ota.resume_record");
+    load_resume_record();
+    boot_trace_end(trace);
     
-    // Criar task de progresso
-    xTaskCreate(ota_progress_task, "ota_progress", 4096, NULL, 5, NULL);
+    // Progresso é publicado por evento; a task de despacho é criada sob demanda
+    s_dispatch_mutex = xSemaphoreCreateMutex();
+    if (!s_dispatch_mutex) {
+        ESP_LOGE(TAG, "Erro ao criar mutex de progresso");
+        return ESP_ERR_NO_MEM;
+    }
+    progress_update(true);
     
     ESP_LOGI(TAG, "Handler OTA inicializado");
     return ESP_OK;
@@ -184,11 +1277,6 @@ esp_err_t ota_start_upgrade(const char *partition_name,
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (s_ota_ctx.in_progress) {
-        ESP_LOGE(TAG, "Upgrade OTA já em progresso");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
     // Obter partição de destino
     const esp_partition_t *target = get_partition_by_name(partition_name);
     if (!target) {
@@ -196,17 +1284,6 @@ esp_err_t ota_start_upgrade(const char *partition_name,
         return ESP_ERR_NOT_FOUND;
     }
     
-    if (!is_valid_ota_partition(target)) {
-        ESP_LOGE(TAG, "Partição inválida para OTA: %s", partition_name);
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    // Verificar tamanho
-    if (size > target->size) {
-        ESP_LOGE(TAG, "Firmware muito grande: %d > %d", size, target->size);
-        return ESP_ERR_NO_MEM;
-    }
-    
     // Verificar integridade
     esp_err_t ret = ota_verify_firmware(data, size);
     if (ret != ESP_OK) {
@@ -214,24 +1291,153 @@ esp_err_t ota_start_upgrade(const char *partition_name,
         return ret;
     }
     
-    // Iniciar upgrade
-    ret = esp_ota_begin(target, 0, &s_ota_ctx.ota_handle);
+    return begin_upgrade(target, size);
+}
+
+esp_err_t ota_begin_streaming(const char *partition_name, size_t image_size)
+{
+    if (image_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const esp_partition_t *target = resolve_target_partition(partition_name);
+    if (!target) {
+        ESP_LOGE(TAG, "Partição não encontrada: %s",
+                 partition_name ? partition_name : "(próxima OTA)");
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // Em streaming o cabeçalho só é conhecido no primeiro bloco,
+    // verificado em ota_write_data()
+    return begin_upgrade(target, image_size);
+}
+
+esp_err_t ota_resume_streaming(const char *partition_name, size_t image_size, size_t offset)
+{
+    if (s_ota_ctx.in_progress) {
+        ESP_LOGE(TAG, "Upgrade OTA já em progresso");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    const esp_partition_t *target = get_partition_by_name(partition_name && partition_name[0] ?
+                                                          partition_name : s_resume.partition);
+    if (s_resume.offset == 0 || !is_valid_ota_partition(target) ||
+        strcmp(target->label, s_resume.partition) != 0 ||
+        image_size != s_resume.total_size || offset != s_resume.offset) {
+        ESP_LOGW(TAG, "Nenhum checkpoint compatível com a retomada em %u/%u bytes",
+                 (unsigned)offset, (unsigned)image_size);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // Os setores a partir do offset são apagados conforme a escrita avança
+    invalidate_erase();
+    esp_err_t ret = esp_ota_resume(target, OTA_WITH_SEQUENTIAL_WRITES, offset, &s_ota_ctx.ota_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Erro ao iniciar OTA: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Erro ao retomar OTA: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // Configurar contexto
+    // Restaurar contexto a partir do checkpoint
+    s_ota_ctx.raw_write = false;
     s_ota_ctx.target_partition = target;
-    s_ota_ctx.total_size = size;
-    s_ota_ctx.written_size = 0;
+    s_ota_ctx.total_size = image_size;
+    s_ota_ctx.received_size = offset;
+    s_ota_ctx.image_size = image_size;
+    s_ota_ctx.written_size = offset;
+    s_ota_ctx.format = OTA_FORMAT_RAW;
+    s_ota_ctx.prefix_len = 0;
+    s_ota_ctx.inflate = NULL;
+    s_ota_ctx.content = OTA_CONTENT_IMAGE;
+    s_ota_ctx.content_hdr_len = 0;
+    s_ota_ctx.delta = NULL;
+    s_ota_ctx.checkpoint_offset = offset;
+    memcpy(s_ota_ctx.header, s_resume.header, sizeof(s_ota_ctx.header));
+    memcpy(s_ota_ctx.expected_sha256, s_resume.expected_sha256, sizeof(s_ota_ctx.expected_sha256));
+    s_ota_ctx.has_expected_sha256 = s_resume.has_expected_sha256;
+    mbedtls_sha256_init(&s_ota_ctx.sha_ctx);
+    mbedtls_sha256_clone(&s_ota_ctx.sha_ctx, &s_resume.sha_ctx);
     s_ota_ctx.in_progress = true;
-    strcpy(s_ota_ctx.status_message, "Iniciando upgrade...");
+    strcpy(s_ota_ctx.status_message, "Retomando upgrade...");
+    progress_update(true);
+    
+    ESP_LOGI(TAG, "Upgrade OTA retomado em %s: %u/%u bytes",
+             target->label, (unsigned)offset, (unsigned)image_size);
+    return ESP_OK;
+}
+
+esp_err_t ota_get_resume_info(ota_resume_info_t *info)
+{
+    if (!info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (s_resume.offset == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    strncpy(info->partition, s_resume.partition, sizeof(info->partition) - 1);
+    info->partition[sizeof(info->partition) - 1] = '\0';
+    info->offset = s_resume.offset;
+    info->total_bytes = s_resume.total_size;
+    return ESP_OK;
+}
+
+esp_err_t ota_set_expected_sha256(const uint8_t *sha256)
+{
+    if (!sha256) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!s_ota_ctx.in_progress) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    ESP_LOGI(TAG, "Upgrade OTA iniciado para partição: %s", partition_name);
+    memcpy(s_ota_ctx.expected_sha256, sha256, OTA_SHA256_SIZE);
+    s_ota_ctx.has_expected_sha256 = true;
     return ESP_OK;
 }
 
+void ota_set_pre_erase_enabled(bool enable)
+{
+    s_pre_erase_enabled = enable;
+    ESP_LOGI(TAG, "Pré-apagamento OTA %s", enable ? "habilitado" : "desabilitado");
+}
+
+bool ota_is_pre_erase_enabled(void)
+{
+    return s_pre_erase_enabled;
+}
+
+esp_err_t ota_pre_erase_start(const char *partition_name, size_t image_size)
+{
+    if (!s_pre_erase_enabled) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    // Só com o tamanho anunciado: nunca a partição inteira por antecipação
+    if (image_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Não apagar por baixo de um upgrade em andamento
+    if (s_ota_ctx.in_progress) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    const esp_partition_t *target = resolve_target_partition(partition_name);
+    if (!is_valid_ota_partition(target) || target->encrypted) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Preservar os dados de um upload que ainda pode ser retomado
+    if (s_resume.offset > 0 && strcmp(s_resume.partition, target->label) == 0) {
+        ESP_LOGI(TAG, "Pré-apagamento ignorado: upload retomável em %s", target->label);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    return schedule_erase(target, image_size);
+}
+
 esp_err_t ota_write_data(const uint8_t *data, size_t size)
 {
     if (!s_ota_ctx.in_progress) {
@@ -242,23 +1448,135 @@ esp_err_t ota_write_data(const uint8_t *data, size_t size)
         return ESP_ERR_INVALID_ARG;
     }
     
-    esp_err_t ret = esp_ota_write(s_ota_ctx.ota_handle, data, size);
+    // Não aceitar mais bytes do que o tamanho anunciado
+    if (size > s_ota_ctx.total_size - s_ota_ctx.received_size) {
+        ESP_LOGE(TAG, "Dados excedem o tamanho anunciado da imagem");
+        fail_upgrade(ESP_ERR_INVALID_SIZE, "Imagem maior que o anunciado", true);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    s_ota_ctx.received_size += size;
+    bool last = s_ota_ctx.received_size == s_ota_ctx.total_size;
+    
+    esp_err_t ret = decode_payload(data, size, last);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Erro ao escrever dados OTA: %s", esp_err_to_name(ret));
-        s_ota_ctx.in_progress = false;
-        strcpy(s_ota_ctx.status_message, "Erro ao escrever dados");
-        
-        if (s_error_cb) {
-            s_error_cb(ret);
-        }
+        fail_upgrade(ret, ret == ESP_ERR_INVALID_CRC ? "Imagem de firmware inválida" :
+                          ret == ESP_ERR_INVALID_VERSION ? "Patch incompatível com o firmware atual" :
+                          "Erro ao escrever dados", true);
         return ret;
     }
     
-    s_ota_ctx.written_size += size;
-    
     // Verificar se concluído
-    if (s_ota_ctx.written_size >= s_ota_ctx.total_size) {
+    if (last) {
         ret = ota_finish_upgrade();
+    } else {
+        progress_update(true);
+    }
+    
+    return ret;
+}
+
+esp_err_t ota_pipeline_begin(void)
+{
+    if (!s_ota_ctx.in_progress) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (s_pipeline.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    s_pipeline.storage = malloc(OTA_PIPELINE_BUFFER_COUNT * OTA_PIPELINE_BUFFER_SIZE);
+    s_pipeline.free_queue = xQueueCreate(OTA_PIPELINE_BUFFER_COUNT, sizeof(uint8_t *));
+    // Uma posição extra para o marcador de fim do stream
+    s_pipeline.filled_queue = xQueueCreate(OTA_PIPELINE_BUFFER_COUNT + 1, sizeof(ota_pipeline_item_t));
+    if (!s_pipeline.storage || !s_pipeline.free_queue || !s_pipeline.filled_queue) {
+        ESP_LOGE(TAG, "Memória insuficiente para o pipeline OTA");
+        pipeline_release();
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (int i = 0; i < OTA_PIPELINE_BUFFER_COUNT; i++) {
+        uint8_t *buffer = s_pipeline.storage + i * OTA_PIPELINE_BUFFER_SIZE;
+        xQueueSend(s_pipeline.free_queue, &buffer, 0);
+    }
+    
+    s_pipeline.result = ESP_OK;
+    s_pipeline.abort = false;
+    xEventGroupClearBits(s_ota_event_group, OTA_PIPELINE_DONE_BIT);
+    
+    if (xTaskCreate(ota_pipeline_writer_task, "ota_writer", OTA_PIPELINE_TASK_STACK,
+                    NULL, OTA_PIPELINE_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Erro ao criar task de gravação OTA");
+        pipeline_release();
+        return ESP_ERR_NO_MEM;
+    }
+    
+    s_pipeline.active = true;
+    return ESP_OK;
+}
+
+esp_err_t ota_pipeline_get_buffer(uint8_t **buffer, size_t *capacity)
+{
+    if (!buffer || !capacity) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!s_pipeline.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // Bloqueia até a task de gravação liberar um buffer
+    xQueueReceive(s_pipeline.free_queue, buffer, portMAX_DELAY);
+    *capacity = OTA_PIPELINE_BUFFER_SIZE;
+    
+    if (s_pipeline.result != ESP_OK) {
+        xQueueSend(s_pipeline.free_queue, buffer, 0);
+        *buffer = NULL;
+        return s_pipeline.result;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t ota_pipeline_submit(uint8_t *buffer, size_t len)
+{
+    if (!buffer || len == 0 || len > OTA_PIPELINE_BUFFER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!s_pipeline.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ota_pipeline_item_t item = { .data = buffer, .len = len };
+    xQueueSend(s_pipeline.filled_queue, &item, portMAX_DELAY);
+    
+    return ESP_OK;
+}
+
+esp_err_t ota_pipeline_end(bool abort)
+{
+    if (!s_pipeline.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (abort) {
+        s_pipeline.abort = true;
+    }
+    
+    // Marcador de fim: a task grava o que estiver pendente e encerra
+    ota_pipeline_item_t end = { .data = NULL, .len = 0 };
+    xQueueSend(s_pipeline.filled_queue, &end, portMAX_DELAY);
+    xEventGroupWaitBits(s_ota_event_group, OTA_PIPELINE_DONE_BIT,
+                        pdTRUE, pdFALSE, portMAX_DELAY);
+    
+    esp_err_t ret = s_pipeline.result;
+    pipeline_release();
+    
+    if (abort && s_ota_ctx.in_progress) {
+        ota_abort_upgrade();
+        return ESP_FAIL;
     }
     
     return ret;
@@ -270,15 +1588,32 @@ esp_err_t ota_finish_upgrade(void)
         return ESP_ERR_INVALID_STATE;
     }
     
-    esp_err_t ret = esp_ota_end(s_ota_ctx.ota_handle);
+    strcpy(s_ota_ctx.status_message, "Verificando imagem...");
+    progress_update(true);
+    
+    // Rejeitar imagem incompleta ou corrompida antes de fechar a sessão,
+    // usando o hash calculado durante a gravação
+    bool complete = s_ota_ctx.written_size == s_ota_ctx.image_size &&
+                    (!s_ota_ctx.inflate || s_ota_ctx.inflate->done);
+    esp_err_t ret = complete ? hash_verify() : ESP_ERR_INVALID_SIZE;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Imagem rejeitada: %s", esp_err_to_name(ret));
+        fail_upgrade(ret, complete ? "Imagem inválida (SHA-256)" : "Imagem incompleta", true);
+        return ret;
+    }
+    mbedtls_sha256_free(&s_ota_ctx.sha_ctx);
+    release_decoder();
+    
+    // Em gravação direta não há handle esp_ota; a imagem é validada por
+    // esp_ota_set_boot_partition()
+    invalidate_erase();
+    if (!s_ota_ctx.raw_write) {
+        ret = esp_ota_end(s_ota_ctx.ota_handle);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao finalizar OTA: %s", esp_err_to_name(ret));
-        s_ota_ctx.in_progress = false;
-        strcpy(s_ota_ctx.status_message, "Erro ao finalizar upgrade");
-        
-        if (s_error_cb) {
-            s_error_cb(ret);
-        }
+        // esp_ota_end() libera o handle mesmo em caso de erro
+        fail_upgrade(ret, "Erro ao finalizar upgrade", false);
         return ret;
     }
     
@@ -286,17 +1621,14 @@ esp_err_t ota_finish_upgrade(void)
     ret = esp_ota_set_boot_partition(s_ota_ctx.target_partition);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao definir partição de boot: %s", esp_err_to_name(ret));
-        s_ota_ctx.in_progress = false;
-        strcpy(s_ota_ctx.status_message, "Erro ao definir partição de boot");
-        
-        if (s_error_cb) {
-            s_error_cb(ret);
-        }
+        fail_upgrade(ret, "Erro ao definir partição de boot", false);
         return ret;
     }
     
+    clear_resume_record();
     s_ota_ctx.in_progress = false;
     strcpy(s_ota_ctx.status_message, "Upgrade concluído com sucesso");
+    progress_update(true);
     
     ESP_LOGI(TAG, "Upgrade OTA concluído com sucesso");
     
@@ -313,9 +1645,16 @@ esp_err_t ota_abort_upgrade(void)
         return ESP_ERR_INVALID_STATE;
     }
     
-    esp_err_t ret = esp_ota_abort(s_ota_ctx.ota_handle);
+    esp_err_t ret = ESP_OK;
+    invalidate_erase();
+    if (!s_ota_ctx.raw_write) {
+        ret = esp_ota_abort(s_ota_ctx.ota_handle);
+    }
+    mbedtls_sha256_free(&s_ota_ctx.sha_ctx);
+    release_decoder();
     s_ota_ctx.in_progress = false;
     strcpy(s_ota_ctx.status_message, "Upgrade abortado");
+    progress_update(true);
     
     ESP_LOGI(TAG, "Upgrade OTA abortado");
     
@@ -337,13 +1676,10 @@ esp_err_t ota_get_progress(ota_progress_t *progress)
         return ESP_ERR_INVALID_ARG;
     }
     
-    progress->bytes_written = s_ota_ctx.written_size;
-    progress->total_bytes = s_ota_ctx.total_size;
-    progress->percentage = (s_ota_ctx.total_size > 0) ? 
-        (s_ota_ctx.written_size * 100) / s_ota_ctx.total_size : 0;
-    progress->in_progress = s_ota_ctx.in_progress;
-    strncpy(progress->status_message, s_ota_ctx.status_message, 
-           sizeof(progress->status_message) - 1);
+    // Cópia do snapshot atualizado por quem altera o estado do upgrade
+    portENTER_CRITICAL(&s_progress_lock);
+    *progress = s_progress;
+    portEXIT_CRITICAL(&s_progress_lock);
     
     return ESP_OK;
 }
@@ -420,28 +1756,58 @@ esp_err_t ota_restart_after_upgrade(uint32_t delay_ms)
 
 esp_err_t ota_get_firmware_hash(uint8_t *hash, size_t hash_size)
 {
-    if (!hash || hash_size < 32) {
+    if (!hash || hash_size < OTA_SHA256_SIZE) {
         return ESP_ERR_INVALID_ARG;
     }
     
+    if (s_running_hash_valid) {
+        memcpy(hash, s_running_hash, OTA_SHA256_SIZE);
+        return ESP_OK;
+    }
+    
     const esp_partition_t *running = esp_ota_get_running_partition();
     if (!running) {
         return ESP_ERR_NOT_FOUND;
     }
     
-    // Ler primeiros 4KB do firmware para calcular hash
-    uint8_t buffer[4096];
-    esp_err_t ret = esp_partition_read(running, 0, buffer, sizeof(buffer));
+    // Tamanho real da imagem (sem o espaço livre da partição)
+    esp_partition_pos_t pos = { .offset = running->address, .size = running->size };
+    esp_image_metadata_t metadata = {0};
+    esp_err_t ret = esp_image_get_metadata(&pos, &metadata);
     if (ret != ESP_OK) {
         return ret;
     }
     
-    // Calcular SHA-256 (simplificado - usar mbedtls em produção)
-    for (int i = 0; i < 32; i++) {
-        hash[i] = buffer[i % sizeof(buffer)] ^ (i * 7);
+    uint8_t *buffer = malloc(OTA_STREAM_CHUNK_SIZE);
+    if (!buffer) {
+        return ESP_ERR_NO_MEM;
     }
     
-    return ESP_OK;
+    // Mesmo SHA-256 incremental da gravação, alimentado em blocos de 4KB
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    
+    for (size_t offset = 0; offset < metadata.image_len && ret == ESP_OK; offset += OTA_STREAM_CHUNK_SIZE) {
+        size_t len = metadata.image_len - offset;
+        if (len > OTA_STREAM_CHUNK_SIZE) {
+            len = OTA_STREAM_CHUNK_SIZE;
+        }
+        ret = esp_partition_read(running, offset, buffer, len);
+        if (ret == ESP_OK) {
+            mbedtls_sha256_update(&ctx, buffer, len);
+        }
+    }
+    
+    if (ret == ESP_OK) {
+        mbedtls_sha256_finish(&ctx, s_running_hash);
+        s_running_hash_valid = true;
+        memcpy(hash, s_running_hash, OTA_SHA256_SIZE);
+    }
+    
+    mbedtls_sha256_free(&ctx);
+    free(buffer);
+    return ret;
 }
 
 bool ota_is_valid_partition(const char *partition_name)
@@ -16,6 +16,58 @@
 extern "C" {
 #endif
 
+// Tamanho do bloco usado para receber o firmware em modo streaming
+#define OTA_STREAM_CHUNK_SIZE 4096
+
+// Pipeline de gravação: buffers ping-pong entre recepção e flash
+#define OTA_PIPELINE_BUFFER_COUNT 2
+#define OTA_PIPELINE_BUFFER_SIZE  OTA_STREAM_CHUNK_SIZE
+
+// Pré-apagamento da partição OTA em segundo plano (modo opcional)
+#define OTA_PRE_ERASE_DEFAULT_ENABLED 0
+#define OTA_PRE_ERASE_STEP_SIZE       (64 * 1024)
+
+// Retomada de upload: checkpoint em NVS a cada OTA_RESUME_CHECKPOINT_SIZE bytes
+#define OTA_RESUME_CHECKPOINT_SIZE (64 * 1024)
+
+// Tamanho do hash SHA-256 em bytes
+#define OTA_SHA256_SIZE 32
+
+/*
+ * Contêiner de imagem comprimida (gerado por tools/ota_pack.py):
+ *   0  magic "OTAZ"
+ *   4  versão (OTA_PACK_VERSION)
+ *   5  window_bits do stream deflate (9..OTA_PACK_MAX_WINDOW_BITS)
+ *   6  reservado (2 bytes, zero)
+ *   8  tamanho do conteúdo descomprimido (uint32 little-endian)
+ *   12 stream deflate "raw" (sem cabeçalho zlib)
+ * ota_write_data() reconhece o contêiner pelo magic e descomprime em
+ * uma janela circular de 2^window_bits bytes.
+ */
+#define OTA_PACK_MAGIC           "OTAZ"
+#define OTA_PACK_VERSION         1
+#define OTA_PACK_HEADER_SIZE     12
+#define OTA_PACK_MAX_WINDOW_BITS 15
+
+/*
+ * Patch delta (gerado por tools/ota_delta.py), aplicado sobre a imagem
+ * da partição em execução:
+ *   0  magic "ODLT"
+ *   4  versão (OTA_DELTA_VERSION)
+ *   5  reservado (3 bytes, zero)
+ *   8  tamanho da nova imagem (uint32 little-endian)
+ *   12 tamanho da imagem de origem (uint32 little-endian)
+ *   16 SHA-256 da imagem de origem (igual a ota_get_firmware_hash())
+ *   48 registros: diff_len, extra_len (uint32), seek (int32), seguidos de
+ *      diff_len bytes somados à origem e extra_len bytes literais
+ * Pode ser enviado diretamente ou dentro do contêiner OTAZ. A origem é
+ * lida da flash em blocos de OTA_DELTA_CHUNK_SIZE bytes.
+ */
+#define OTA_DELTA_MAGIC       "ODLT"
+#define OTA_DELTA_VERSION     1
+#define OTA_DELTA_HEADER_SIZE 48
+#define OTA_DELTA_CHUNK_SIZE  1024
+
 // Estrutura para informações de partição
 typedef struct {
     char name[16];
@@ -33,8 +85,19 @@ typedef struct {
     int percentage;
     bool in_progress;
     char status_message[64];
+    size_t erase_bytes;       // Bytes já apagados pelo pré-apagamento
+    size_t erase_total;       // Bytes a apagar pelo pré-apagamento
+    bool erase_in_progress;
+    size_t resume_offset;     // Offset do último checkpoint (0 = sem retomada)
 } ota_progress_t;
 
+// Checkpoint de upload interrompido
+typedef struct {
+    char partition[17];
+    size_t offset;            // Bytes já gravados e verificáveis
+    size_t total_bytes;       // Tamanho total da imagem
+} ota_resume_info_t;
+
 // Callbacks
 typedef void (*ota_progress_cb_t)(const ota_progress_t *progress);
 typedef void (*ota_complete_cb_t)(esp_err_t result);
@@ -85,15 +148,147 @@ esp_err_t ota_start_upgrade(const char *partition_name,
                            const uint8_t *data, 
                            size_t size);
 
+/**
+ * @brief Iniciar upgrade OTA em modo streaming
+ * 
+ * A imagem é entregue depois em blocos via ota_write_data(), sem que o
+ * firmware completo precise estar em RAM. O upgrade é finalizado
+ * automaticamente quando image_size bytes forem escritos.
+ * 
+ * @param partition_name Nome da partição de destino (NULL = próxima partição OTA)
+ * @param image_size Tamanho total da imagem em bytes
+ * @return esp_err_t 
+ */
+esp_err_t ota_begin_streaming(const char *partition_name, size_t image_size);
+
+/**
+ * @brief Retomar um upload interrompido a partir do último checkpoint
+ * 
+ * Durante o streaming de imagens .bin sem compressão, o offset gravado e
+ * o estado do SHA-256 são salvos em NVS a cada OTA_RESUME_CHECKPOINT_SIZE
+ * bytes. Uma conexão perdida mantém o checkpoint; erros de validação e
+ * um novo upload o descartam. Após a retomada, os bytes a partir de
+ * offset são entregues via ota_write_data().
+ * 
+ * @param partition_name Nome da partição (NULL = partição do checkpoint)
+ * @param image_size Tamanho total da imagem em bytes
+ * @param offset Offset de retomada (deve ser igual ao do checkpoint)
+ * @return ESP_ERR_NOT_FOUND se não houver checkpoint compatível
+ */
+esp_err_t ota_resume_streaming(const char *partition_name, size_t image_size, size_t offset);
+
+/**
+ * @brief Obter o checkpoint de upload interrompido
+ * 
+ * @param info Ponteiro para estrutura de saída
+ * @return ESP_ERR_NOT_FOUND se não houver checkpoint
+ */
+esp_err_t ota_get_resume_info(ota_resume_info_t *info);
+
+/**
+ * @brief Habilitar/desabilitar o pré-apagamento da partição OTA
+ * 
+ * Com o pré-apagamento habilitado, a partição de destino é apagada em
+ * segundo plano antes (e durante) o upload, e a gravação dispensa o
+ * apagamento síncrono feito por esp_ota_begin().
+ * 
+ * @param enable true para habilitar
+ */
+void ota_set_pre_erase_enabled(bool enable);
+
+/**
+ * @brief Verificar se o pré-apagamento está habilitado
+ * 
+ * @return true se habilitado
+ */
+bool ota_is_pre_erase_enabled(void);
+
+/**
+ * @brief Iniciar pré-apagamento da partição OTA em segundo plano
+ * 
+ * Apaga apenas os setores necessários para image_size bytes. Chamadas
+ * repetidas apenas ampliam a área a apagar; setores já apagados desde o
+ * último upgrade não são apagados novamente. A partição com uma imagem
+ * aguardando reinício (definida como boot, diferente da atual) não é
+ * apagada.
+ * 
+ * @param partition_name Nome da partição (NULL = próxima partição OTA)
+ * @param image_size Tamanho da imagem (obrigatório)
+ * @return esp_err_t ESP_ERR_NOT_SUPPORTED se o modo estiver desabilitado,
+ *         ESP_ERR_INVALID_STATE com upgrade ou reinício pendente
+ */
+esp_err_t ota_pre_erase_start(const char *partition_name, size_t image_size);
+
 /**
  * @brief Escrever dados durante upgrade OTA
  * 
+ * Aceita a imagem em formato binário (.bin) ou no contêiner comprimido
+ * OTA_PACK_MAGIC e/ou um patch OTA_DELTA_MAGIC, identificados
+ * automaticamente pelos primeiros bytes.
+ * O tamanho informado ao iniciar o upgrade é o tamanho transferido.
+ * 
  * @param data Dados a serem escritos
  * @param size Tamanho dos dados
  * @return esp_err_t 
  */
 esp_err_t ota_write_data(const uint8_t *data, size_t size);
 
+/**
+ * @brief Definir o SHA-256 esperado da imagem em gravação
+ * 
+ * O hash é calculado incrementalmente em ota_write_data() e comparado em
+ * ota_finish_upgrade(), sem reler a partição. Deve ser chamado após
+ * iniciar o upgrade e antes do último bloco. Para imagens comprimidas o
+ * hash é o da imagem descomprimida (.bin).
+ * 
+ * @param sha256 Hash esperado (OTA_SHA256_SIZE bytes)
+ * @return esp_err_t 
+ */
+esp_err_t ota_set_expected_sha256(const uint8_t *sha256);
+
+/**
+ * @brief Iniciar pipeline de gravação (recepção e flash em paralelo)
+ * 
+ * Deve ser chamado após ota_begin_streaming(). Cria uma task de gravação
+ * que consome os buffers preenchidos pelo produtor com ota_write_data(),
+ * enquanto o produtor continua recebendo dados no outro buffer.
+ * 
+ * @return esp_err_t 
+ */
+esp_err_t ota_pipeline_begin(void);
+
+/**
+ * @brief Obter buffer livre do pipeline
+ * 
+ * Bloqueia enquanto todos os buffers estiverem aguardando gravação
+ * (backpressure). Retorna o erro da task de gravação, se houver.
+ * 
+ * @param buffer Ponteiro para receber o buffer
+ * @param capacity Ponteiro para receber a capacidade do buffer
+ * @return esp_err_t 
+ */
+esp_err_t ota_pipeline_get_buffer(uint8_t **buffer, size_t *capacity);
+
+/**
+ * @brief Entregar buffer preenchido para gravação
+ * 
+ * @param buffer Buffer obtido com ota_pipeline_get_buffer()
+ * @param len Quantidade de bytes válidos
+ * @return esp_err_t 
+ */
+esp_err_t ota_pipeline_submit(uint8_t *buffer, size_t len);
+
+/**
+ * @brief Encerrar pipeline de gravação
+ * 
+ * Aguarda a gravação dos buffers pendentes e libera os recursos. Com
+ * abort = true os buffers pendentes são descartados e o upgrade abortado.
+ * 
+ * @param abort true para descartar dados pendentes e abortar o upgrade
+ * @return esp_err_t Resultado final da gravação
+ */
+esp_err_t ota_pipeline_end(bool abort);
+
 /**
  * @brief Finalizar upgrade OTA
  * 
@@ -118,6 +313,9 @@ bool ota_is_upgrading(void);
 /**
  * @brief Obter progresso atual do upgrade
  * 
+ * Retorna uma cópia consistente do snapshot mantido pelo handler,
+ * segura para chamada a partir de qualquer task.
+ * 
  * @param progress Ponteiro para estrutura de progresso
  * @return esp_err_t 
  */
@@ -144,6 +342,10 @@ esp_err_t ota_get_firmware_version(char *version, size_t version_size);
 /**
  * @brief Registrar callback de progresso
  * 
+ * O callback é chamado por uma task de despacho criada sob demanda, apenas
+ * quando o percentual ou o estado mudam; atualizações próximas são
+ * agrupadas, de modo que um callback lento não atrasa a gravação.
+ * 
  * @param cb Callback
  */
 void ota_register_progress_cb(ota_progress_cb_t cb);
@@ -171,9 +373,12 @@ void ota_register_error_cb(ota_error_cb_t cb);
 esp_err_t ota_restart_after_upgrade(uint32_t delay_ms);
 
 /**
- * @brief Obter hash do firmware atual
+ * @brief Obter hash SHA-256 do firmware atual
+ * 
+ * Calculado uma única vez sobre a imagem da partição em execução; as
+ * chamadas seguintes retornam o valor em cache.
  * 
- * @param hash Buffer para armazenar hash
+ * @param hash Buffer para armazenar hash (mínimo OTA_SHA256_SIZE bytes)
  * @param hash_size Tamanho do buffer
  * @return esp_err_t 
  */
@@ -0,0 +1,318 @@
+/**
+ * @file static_files.c
+ * @brief Índice e envio dos arquivos estáticos da partição spiffs
+ */
+
+#include "static_files.h"
+#include "web_assets.h"
+#include "http_range.h"
+#include "esp_log.h"
+#include "esp_spiffs.h"
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/sha256.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+static const char *TAG = "STATIC_FILES";
+
+// Índice ordenado por caminho; o ETag das entradas é escrito e lido sob
+// s_etag_lock (o envio roda em mais de uma task)
+static static_file_t *s_files = NULL;
+static size_t s_file_count = 0;
+static portMUX_TYPE s_etag_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Tipos de conteúdo por extensão
+static const struct {
+    const char *ext;
+    const char *type;
+} s_content_types[] = {
+    { ".html", "text/html" },
+    { ".css",  "text/css" },
+    { ".js",   "application/javascript" },
+    { ".json", "application/json" },
+    { ".svg",  "image/svg+xml" },
+    { ".png",  "image/png" },
+    { ".jpg",  "image/jpeg" },
+    { ".jpeg", "image/jpeg" },
+    { ".ico",  "image/x-icon" },
+};
+
+/**
+ * @brief Tipo de conteúdo pela extensão do arquivo
+ */
+static const char* content_type_for(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+    if (ext) {
+        for (size_t i = 0; i < sizeof(s_content_types) / sizeof(s_content_types[0]); i++) {
+            if (strcasecmp(ext, s_content_types[i].ext) == 0) {
+                return s_content_types[i].type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+/**
+ * @brief Ordenar entradas por caminho (qsort)
+ */
+static int compare_files(const void *a, const void *b)
+{
+    return strcmp(((const static_file_t *)a)->path, ((const static_file_t *)b)->path);
+}
+
+/**
+ * @brief Comparar caminho com entrada do índice (bsearch)
+ */
+static int compare_path(const void *key, const void *entry)
+{
+    return strcmp((const char *)key, ((const static_file_t *)entry)->path);
+}
+
+/**
+ * @brief Adicionar arquivo ao índice
+ */
+static esp_err_t index_add(const char *name)
+{
+    size_t len = strlen(STATIC_FILES_BASE_PATH) + 1 + strlen(name) + 1;
+    char *path = malloc(len);
+    if (!path) {
+        return ESP_ERR_NO_MEM;
+    }
+    snprintf(path, len, "%s/%s", STATIC_FILES_BASE_PATH, name);
+    
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        free(path);
+        return ESP_OK;
+    }
+    
+    static_file_t *files = realloc(s_files, (s_file_count + 1) * sizeof(static_file_t));
+    if (!files) {
+        free(path);
+        return ESP_ERR_NO_MEM;
+    }
+    s_files = files;
+    s_files[s_file_count++] = (static_file_t) {
+        .path = path,
+        .size = (size_t)st.st_size,
+        .content_type = content_type_for(path),
+    };
+    return ESP_OK;
+}
+
+/**
+ * @brief Criar o índice percorrendo o diretório montado
+ * 
+ * O spiffs não tem diretórios: readdir() devolve todos os arquivos com o
+ * caminho relativo completo (ex.: "images/logo.png").
+ */
+static esp_err_t build_index(void)
+{
+    DIR *dir = opendir(STATIC_FILES_BASE_PATH);
+    if (!dir) {
+        return ESP_FAIL;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    struct dirent *entry;
+    while (ret == ESP_OK && (entry = readdir(dir)) != NULL) {
+        ret = index_add(entry->d_name);
+    }
+    closedir(dir);
+    
+    if (s_file_count > 1) {
+        qsort(s_files, s_file_count, sizeof(static_file_t), compare_files);
+    }
+    return ret;
+}
+
+/**
+ * @brief Calcular o ETag do arquivo (SHA-256 do conteúdo)
+ * 
+ * Feito no primeiro acesso para não atrasar o boot lendo toda a partição;
+ * o resultado fica no índice. A versão é a mesma que tools/web_assets.py
+ * usa nas URLs "?v=" das páginas.
+ * 
+ * @param file Entrada do índice
+ * @param chunk Buffer de leitura (STATIC_FILES_CHUNK_SIZE bytes)
+ */
+static esp_err_t compute_etag(static_file_t *file, char *chunk)
+{
+    FILE *f = fopen(file->path, "rb");
+    if (!f) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    mbedtls_sha256_context sha;
+    uint8_t digest[32];
+    size_t n;
+    
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    while ((n = fread(chunk, 1, STATIC_FILES_CHUNK_SIZE, f)) > 0) {
+        mbedtls_sha256_update(&sha, (const unsigned char *)chunk, n);
+    }
+    bool failed = ferror(f);
+    fclose(f);
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    
+    if (failed) {
+        return ESP_FAIL;
+    }
+    
+    char etag[sizeof(file->etag)];
+    etag[0] = '"';
+    for (int i = 0; i < STATIC_FILES_VERSION_LEN / 2; i++) {
+        snprintf(&etag[1 + i * 2], 3, "%02x", digest[i]);
+    }
+    etag[STATIC_FILES_VERSION_LEN + 1] = '"';
+    etag[STATIC_FILES_VERSION_LEN + 2] = '\0';
+    
+    // Duas tasks podem calcular ao mesmo tempo: o resultado é o mesmo
+    taskENTER_CRITICAL(&s_etag_lock);
+    memcpy(file->etag, etag, sizeof(etag));
+    taskEXIT_CRITICAL(&s_etag_lock);
+    return ESP_OK;
+}
+
+esp_err_t static_files_init(void)
+{
+    ESP_LOGI(TAG, "Montando partição %s em %s", STATIC_FILES_PARTITION, STATIC_FILES_BASE_PATH);
+    
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = STATIC_FILES_BASE_PATH,
+        .partition_label = STATIC_FILES_PARTITION,
+        .max_files = STATIC_FILES_MAX_OPEN,
+        .format_if_mount_failed = false
+    };
+    
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao montar spiffs: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    ret = build_index();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao indexar arquivos: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    size_t total = 0, used = 0;
+    esp_spiffs_info(STATIC_FILES_PARTITION, &total, &used);
+    ESP_LOGI(TAG, "%u arquivos indexados (%u/%u bytes usados)",
+             (unsigned)s_file_count, (unsigned)used, (unsigned)total);
+    return ESP_OK;
+}
+
+const static_file_t* static_files_find(const char *uri)
+{
+    if (!uri || s_file_count == 0) {
+        return NULL;
+    }
+    
+    char clean[WEB_ASSET_MAX_PATH];
+    size_t len = strcspn(uri, "?#");
+    if (len >= sizeof(clean)) {
+        return NULL;
+    }
+    memcpy(clean, uri, len);
+    clean[len] = '\0';
+    
+    return bsearch(clean, s_files, s_file_count, sizeof(static_file_t), compare_path);
+}
+
+esp_err_t static_files_send(httpd_req_t *req, const static_file_t *file)
+{
+    if (!file) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Arquivo não encontrado");
+        return ESP_FAIL;
+    }
+    
+    char *chunk = malloc(STATIC_FILES_CHUNK_SIZE);
+    if (!chunk) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memória insuficiente");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    static_file_t *entry = &s_files[file - s_files];
+    char etag[sizeof(entry->etag)];
+    taskENTER_CRITICAL(&s_etag_lock);
+    memcpy(etag, entry->etag, sizeof(etag));
+    taskEXIT_CRITICAL(&s_etag_lock);
+    
+    if (etag[0] == '\0') {
+        if (compute_etag(entry, chunk) == ESP_OK) {
+            taskENTER_CRITICAL(&s_etag_lock);
+            memcpy(etag, entry->etag, sizeof(etag));
+            taskEXIT_CRITICAL(&s_etag_lock);
+        } else {
+            ESP_LOGW(TAG, "Sem ETag para %s", entry->path);
+        }
+    }
+    
+    httpd_resp_set_type(req, entry->content_type);
+    
+    if (etag[0] != '\0') {
+        // Versão sem aspas, para comparar com a query "v"
+        char version[STATIC_FILES_VERSION_LEN + 1];
+        memcpy(version, &etag[1], STATIC_FILES_VERSION_LEN);
+        version[STATIC_FILES_VERSION_LEN] = '\0';
+        
+        if (web_assets_not_modified(req, etag, version)) {
+            free(chunk);
+            return ESP_OK;
+        }
+    }
+    
+    http_range_t range;
+    if (http_range_parse(req, entry->size, etag[0] ? etag : NULL, &range) != ESP_OK) {
+        free(chunk);
+        return http_range_send_unsatisfiable(req, entry->size);
+    }
+    
+    FILE *f = fopen(entry->path, "rb");
+    if (!f || fseek(f, (long)range.start, SEEK_SET) != 0) {
+        if (f) {
+            fclose(f);
+        }
+        free(chunk);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Erro ao abrir arquivo");
+        return ESP_FAIL;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    size_t left = range.length;
+    while (ret == ESP_OK && left > 0) {
+        size_t n = fread(chunk, 1, left < STATIC_FILES_CHUNK_SIZE ? left : STATIC_FILES_CHUNK_SIZE, f);
+        if (n == 0) {
+            break;
+        }
+        ret = httpd_resp_send_chunk(req, chunk, n);
+        left -= n;
+    }
+    
+    if (ret == ESP_OK && left > 0) {
+        ESP_LOGE(TAG, "Erro de leitura: %s", entry->path);
+        ret = ESP_FAIL;
+    }
+    fclose(f);
+    free(chunk);
+    
+    // Em caso de erro a resposta fica incompleta e o httpd fecha a conexão
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
+
+size_t static_files_count(void)
+{
+    return s_file_count;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file static_files.h
+ * @brief Arquivos estáticos servidos da partição spiffs
+ * 
+ * O conteúdo de web/assets é gravado na partição "spiffs" durante o build
+ * (spiffs_create_partition_image) e montado em STATIC_FILES_BASE_PATH, que
+ * coincide com o prefixo das URLs. Na montagem é criado um índice ordenado
+ * por caminho (busca binária); os arquivos são enviados em blocos de
+ * STATIC_FILES_CHUNK_SIZE, sem carregar o arquivo inteiro na RAM. O envio
+ * pode rodar na task do httpd e nos workers de http_async ao mesmo tempo.
+ */
+
+#ifndef STATIC_FILES_H
+#define STATIC_FILES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Partição e ponto de montagem (também prefixo das URLs: /assets/...)
+#define STATIC_FILES_PARTITION "spiffs"
+#define STATIC_FILES_BASE_PATH "/assets"
+
+// Arquivos abertos simultaneamente pelo VFS
+#define STATIC_FILES_MAX_OPEN 4
+
+// Buffer de envio, alocado por requisição
+#define STATIC_FILES_CHUNK_SIZE 4096
+
+// Dígitos hex do SHA-256 usados como versão/ETag (igual a tools/web_assets.py)
+#define STATIC_FILES_VERSION_LEN 16
+
+// Entrada do índice
+typedef struct {
+    char *path;                 // Caminho completo, ex.: "/assets/images/logo.png"
+    size_t size;
+    const char *content_type;
+    char etag[STATIC_FILES_VERSION_LEN + 3];   // "\"<versão>\"", calculado no 1º acesso
+} static_file_t;
+
+/**
+ * @brief Montar a partição spiffs e criar o índice de arquivos
+ * 
+ * @return esp_err_t ESP_ERR_NOT_FOUND se a partição não existir
+ */
+esp_err_t static_files_init(void);
+
+/**
+ * @brief Procurar arquivo pelo caminho da URL (query string é ignorada)
+ * 
+ * @param uri URI da requisição
+ * @return const static_file_t* NULL se não encontrado ou não montado
+ */
+const static_file_t* static_files_find(const char *uri);
+
+/**
+ * @brief Enviar arquivo em blocos na resposta HTTP
+ * 
+ * Define ETag (hash do conteúdo) e Cache-Control como os assets embutidos
+ * e responde 304 Not Modified quando o If-None-Match corresponder.
+ * 
+ * @param req Requisição
+ * @param file Arquivo (NULL responde 404)
+ * @return esp_err_t
+ */
+esp_err_t static_files_send(httpd_req_t *req, const static_file_t *file);
+
+/**
+ * @brief Número de arquivos no índice
+ */
+size_t static_files_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATIC_FILES_H
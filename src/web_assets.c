@@ -0,0 +1,206 @@
+/**
+ * @file web_assets.c
+ * @brief Envio das páginas web embutidas no firmware
+ */
+
+#include "web_assets.h"
+#include "esp_log.h"
+#include "miniz.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static const char *TAG = "WEB_ASSETS";
+
+// Formato gzip (RFC 1952) gerado sem campos opcionais
+#define GZIP_HEADER_SIZE  10
+#define GZIP_TRAILER_SIZE 8
+
+// Buffers de If-None-Match, query string e ETag ("W/" + aspas + versão)
+#define IF_NONE_MATCH_SIZE 128
+#define QUERY_SIZE         64
+#define ETAG_SIZE          32
+
+/**
+ * @brief Comparar caminho com entrada da tabela (bsearch)
+ */
+static int compare_path(const void *key, const void *entry)
+{
+    return strcmp((const char *)key, ((const web_asset_t *)entry)->path);
+}
+
+/**
+ * @brief Verificar se o cliente aceita conteúdo gzip
+ */
+static bool accepts_gzip(httpd_req_t *req)
+{
+    char value[64] = {0};
+    esp_err_t ret = httpd_req_get_hdr_value_str(req, "Accept-Encoding", value, sizeof(value));
+    
+    // Valor truncado ainda contém o início da lista de codificações
+    if (ret != ESP_OK && ret != ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return false;
+    }
+    
+    return strstr(value, "gzip") != NULL;
+}
+
+/**
+ * @brief Verificar se a query "v" da URL é igual à versão do asset
+ */
+static bool url_has_version(httpd_req_t *req, const char *version)
+{
+    char query[QUERY_SIZE];
+    char value[ETAG_SIZE];
+    
+    if (!version ||
+        httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "v", value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    
+    return strcmp(value, version) == 0;
+}
+
+/**
+ * @brief Verificar se o If-None-Match contém o ETag
+ * 
+ * Comparação fraca (RFC 9110): o prefixo W/ é ignorado dos dois lados.
+ */
+static bool etag_matches(httpd_req_t *req, const char *etag)
+{
+    char value[IF_NONE_MATCH_SIZE];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    
+    const char *opaque = strchr(etag, '"');
+    return strcmp(value, "*") == 0 || (opaque && strstr(value, opaque) != NULL);
+}
+
+/**
+ * @brief Enviar asset comprimido já descomprimido, em blocos
+ * 
+ * Usa o inflater da ROM com janela circular de TINFL_LZ_DICT_SIZE bytes;
+ * cada trecho produzido é enviado com httpd_resp_send_chunk().
+ */
+static esp_err_t send_inflated(httpd_req_t *req, const web_asset_t *asset)
+{
+    if (asset->size < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    tinfl_decompressor *decomp = malloc(sizeof(tinfl_decompressor));
+    uint8_t *dict = malloc(TINFL_LZ_DICT_SIZE);
+    if (!decomp || !dict) {
+        free(decomp);
+        free(dict);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memória insuficiente");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    const uint8_t *in = asset->data + GZIP_HEADER_SIZE;
+    size_t in_left = asset->size - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE;
+    size_t dict_ofs = 0;
+    tinfl_status status;
+    esp_err_t ret = ESP_OK;
+    
+    tinfl_init(decomp);
+    do {
+        size_t in_bytes = in_left;
+        size_t out_bytes = TINFL_LZ_DICT_SIZE - dict_ofs;
+        status = tinfl_decompress(decomp, in, &in_bytes, dict, dict + dict_ofs, &out_bytes, 0);
+        in += in_bytes;
+        in_left -= in_bytes;
+        
+        if (out_bytes > 0) {
+            ret = httpd_resp_send_chunk(req, (const char *)dict + dict_ofs, out_bytes);
+            dict_ofs = (dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+    } while (ret == ESP_OK && status == TINFL_STATUS_HAS_MORE_OUTPUT);
+    
+    if (ret == ESP_OK && status != TINFL_STATUS_DONE) {
+        ESP_LOGE(TAG, "Asset corrompido: %s (%d)", asset->path, (int)status);
+        ret = ESP_FAIL;
+    }
+    
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    
+    free(dict);
+    free(decomp);
+    return ret;
+}
+
+const web_asset_t* web_assets_find(const char *path)
+{
+    if (!path) {
+        return NULL;
+    }
+    
+    char clean[WEB_ASSET_MAX_PATH];
+    size_t len = strcspn(path, "?#");
+    if (len >= sizeof(clean)) {
+        return NULL;
+    }
+    memcpy(clean, path, len);
+    clean[len] = '\0';
+    
+    return bsearch(clean, g_web_assets, g_web_assets_count, sizeof(web_asset_t), compare_path);
+}
+
+bool web_assets_not_modified(httpd_req_t *req, const char *etag, const char *version)
+{
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", url_has_version(req, version) ?
+                       WEB_ASSET_CACHE_IMMUTABLE : WEB_ASSET_CACHE_REVALIDATE);
+    
+    if (!etag_matches(req, etag)) {
+        return false;
+    }
+    
+    httpd_resp_set_status(req, "304 Not Modified");
+    httpd_resp_send(req, NULL, 0);
+    return true;
+}
+
+esp_err_t web_assets_send(httpd_req_t *req, const web_asset_t *asset)
+{
+    if (!asset) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Arquivo não encontrado");
+        return ESP_FAIL;
+    }
+    
+    httpd_resp_set_type(req, asset->content_type);
+    
+    // A versão descomprimida é outra representação: ETag fraco
+    bool gzip = asset->gzip && accepts_gzip(req);
+    char etag[ETAG_SIZE];
+    snprintf(etag, sizeof(etag), "%s\"%s\"", (asset->gzip && !gzip) ? "W/" : "", asset->version);
+    
+    if (asset->gzip) {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+    
+    if (web_assets_not_modified(req, etag, asset->version)) {
+        return ESP_OK;
+    }
+    
+    if (!asset->gzip) {
+        return httpd_resp_send(req, (const char *)asset->data, asset->size);
+    }
+    
+    if (!gzip) {
+        return send_inflated(req, asset);
+    }
+    
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->data, asset->size);
+}
+
+esp_err_t web_assets_handler(httpd_req_t *req)
+{
+    const char *path = req->user_ctx ? (const char *)req->user_ctx : req->uri;
+    return web_assets_send(req, web_assets_find(path));
+}
@@ -0,0 +1,98 @@
+/**
+ * @file web_assets.h
+ * @brief Páginas web embutidas no firmware
+ * 
+ * Os assets de web/ são minificados, comprimidos com gzip e convertidos
+ * em arrays C durante o build (tools/web_assets.py). A tabela gerada é
+ * ordenada por caminho para consulta por busca binária.
+ * 
+ * Cada asset traz uma versão derivada do conteúdo, enviada como ETag.
+ * Requisições com If-None-Match correspondente recebem 304; URLs
+ * versionadas ("?v=<versão>") são servidas com Cache-Control imutável.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tamanho máximo do caminho de um asset (sem query string)
+#define WEB_ASSET_MAX_PATH 64
+
+// Cache-Control das URLs versionadas e das demais (revalidação por ETag)
+#define WEB_ASSET_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define WEB_ASSET_CACHE_REVALIDATE "no-cache"
+
+// Asset embutido
+typedef struct {
+    const char *path;           // Caminho, ex.: "/index.html"
+    const char *content_type;
+    const uint8_t *data;
+    size_t size;
+    bool gzip;                  // data contém o asset comprimido com gzip
+    const char *version;        // Hash do conteúdo (hex), usado como ETag
+} web_asset_t;
+
+// Tabela gerada no build (web_assets_data.c)
+extern const web_asset_t g_web_assets[];
+extern const size_t g_web_assets_count;
+
+/**
+ * @brief Procurar asset pelo caminho (query string é ignorada)
+ * 
+ * @param path Caminho da requisição
+ * @return const web_asset_t* NULL se não encontrado
+ */
+const web_asset_t* web_assets_find(const char *path);
+
+/**
+ * @brief Enviar asset na resposta HTTP
+ * 
+ * Assets comprimidos são enviados com Content-Encoding: gzip. Para
+ * clientes que não aceitam gzip, o conteúdo é descomprimido durante o
+ * envio, em blocos.
+ * 
+ * Responde 304 Not Modified quando o If-None-Match do cliente contém a
+ * versão do asset.
+ * 
+ * @param req Requisição
+ * @param asset Asset (NULL responde 404)
+ * @return esp_err_t 
+ */
+esp_err_t web_assets_send(httpd_req_t *req, const web_asset_t *asset);
+
+/**
+ * @brief Responder 304 se o cliente já possui a versão atual
+ * 
+ * Define os cabeçalhos ETag e Cache-Control da resposta (imutável quando a
+ * query "v" da URL é igual à versão) e, se o If-None-Match corresponder,
+ * envia 304 Not Modified sem corpo.
+ * 
+ * @param req Requisição
+ * @param etag ETag completo, com aspas (ex.: "\"4e5b10df\"")
+ * @param version Versão esperada na query "v" (NULL: nunca imutável)
+ * @return true se a resposta 304 foi enviada
+ */
+bool web_assets_not_modified(httpd_req_t *req, const char *etag, const char *version);
+
+/**
+ * @brief Handler genérico de assets
+ * 
+ * Envia o asset indicado em user_ctx (caminho) ou, se NULL, o asset
+ * correspondente à URI da requisição.
+ */
+esp_err_t web_assets_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_ASSETS_H
@@ -5,36 +5,61 @@
 
 #include "web_server.h"
 #include "wifi_manager.h"
+#include "wifi_reconnect.h"
 #include "ota_handler.h"
+#include "web_assets.h"
+#include "static_files.h"
+#include "http_range.h"
+#include "json_writer.h"
+#include "boot_trace.h"
+#include "http_metrics.h"
+#include "http_async.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_ota_ops.h"
+#include "esp_timer.h"
 #include "cJSON.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include <ctype.h>
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 
 static const char *TAG = "WEB_SERVER";
 
+// Clientes WebSocket que recebem o progresso OTA
+#define OTA_WS_MAX_CLIENTS 4
+
+static httpd_handle_t s_server = NULL;
+static int s_ota_ws_fds[OTA_WS_MAX_CLIENTS] = {-1, -1, -1, -1};
+static portMUX_TYPE s_ota_ws_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Upload OTA em andamento (os workers atendem requisições em paralelo)
+static bool s_ota_upload_active = false;
+
 // Handlers HTTP
+// Páginas embutidas (web/*.html), enviadas pelo handler genérico de assets
 static const httpd_uri_t root_uri = {
     .uri       = "/",
     .method    = HTTP_GET,
-    .handler   = root_get_handler,
-    .user_ctx  = NULL
+    .handler   = web_assets_handler,
+    .user_ctx  = "/index.html"
 };
 
 static const httpd_uri_t dashboard_uri = {
     .uri       = "/dashboard",
     .method    = HTTP_GET,
-    .handler   = dashboard_get_handler,
-    .user_ctx  = NULL
+    .handler   = web_assets_handler,
+    .user_ctx  = "/dashboard.html"
 };
 
 static const httpd_uri_t wifi_config_get_uri = {
     .uri       = "/wifi",
     .method    = HTTP_GET,
-    .handler   = wifi_config_get_handler,
-    .user_ctx  = NULL
+    .handler   = web_assets_handler,
+    .user_ctx  = "/wifi.html"
 };
 
 static const httpd_uri_t wifi_config_post_uri = {
@@ -79,6 +104,20 @@ static const httpd_uri_t firmware_api_uri = {
     .user_ctx  = NULL
 };
 
+static const httpd_uri_t boot_api_uri = {
+    .uri       = "/api/boot",
+    .method    = HTTP_GET,
+    .handler   = boot_api_handler,
+    .user_ctx  = NULL
+};
+
+static const httpd_uri_t metrics_api_uri = {
+    .uri       = "/api/metrics",
+    .method    = HTTP_GET,
+    .handler   = metrics_api_handler,
+    .user_ctx  = NULL
+};
+
 static const httpd_uri_t ota_partitions_api_uri = {
     .uri       = "/api/ota/partitions",
     .method    = HTTP_GET,
@@ -86,6 +125,15 @@ static const httpd_uri_t ota_partitions_api_uri = {
     .user_ctx  = NULL
 };
 
+#if WEB_PARTITION_DUMP_ENABLED
+static const httpd_uri_t partition_dump_uri = {
+    .uri       = "/api/partition/*",
+    .method    = HTTP_GET,
+    .handler   = partition_dump_handler,
+    .user_ctx  = NULL
+};
+#endif
+
 static const httpd_uri_t wechat_uri = {
     .uri       = "/wechat",
     .method    = HTTP_GET,
@@ -93,31 +141,50 @@ static const httpd_uri_t wechat_uri = {
     .user_ctx  = NULL
 };
 
+// Arquivos da partição spiffs (STATIC_FILES_BASE_PATH)
 static const httpd_uri_t static_files_uri = {
-    .uri       = "/assets/images/maya-logo.png",
+    .uri       = STATIC_FILES_BASE_PATH "/*",
     .method    = HTTP_GET,
     .handler   = static_file_handler,
     .user_ctx  = NULL
 };
 
-static const httpd_uri_t static_bg_uri = {
-    .uri       = "/assets/images/maya-background.jpg",
-    .method    = HTTP_GET,
-    .handler   = static_file_handler,
-    .user_ctx  = NULL
+static const httpd_uri_t ota_ws_uri = {
+    .uri          = "/ws/ota",
+    .method       = HTTP_GET,
+    .handler      = ota_ws_handler,
+    .user_ctx     = NULL,
+    .is_websocket = true
 };
 
-// Função auxiliar para enviar resposta JSON
-static esp_err_t send_json_response(httpd_req_t *req, const char *json_str)
+// Função auxiliar para os cabeçalhos das respostas JSON
+static void set_json_headers(httpd_req_t *req)
 {
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
-    
+}
+
+// Função auxiliar para enviar resposta JSON
+static esp_err_t send_json_response(httpd_req_t *req, const char *json_str)
+{
+    set_json_headers(req);
     return httpd_resp_send(req, json_str, HTTPD_RESP_USE_STRLEN);
 }
 
+// Função auxiliar para gerar e enviar resposta JSON em blocos
+static esp_err_t send_json_stream(httpd_req_t *req, esp_err_t (*write_json)(json_writer_t *w))
+{
+    char buffer[WEB_JSON_CHUNK_SIZE];
+    json_writer_t w;
+    
+    set_json_headers(req);
+    json_writer_init_httpd(&w, req, buffer, sizeof(buffer));
+    write_json(&w);
+    return json_writer_finish(&w);
+}
+
 // Função auxiliar para enviar resposta HTML
 static esp_err_t send_html_response(httpd_req_t *req, const char *html_str)
 {
@@ -144,6 +211,102 @@ static esp_err_t extract_post_data(httpd_req_t *req, char *buffer, size_t buffer
     return ESP_OK;
 }
 
+/**
+ * @brief Registrar cliente WebSocket de progresso OTA
+ */
+static bool ota_ws_add_client(int fd)
+{
+    bool added = false;
+    portENTER_CRITICAL(&s_ota_ws_lock);
+    for (int i = 0; i < OTA_WS_MAX_CLIENTS && !added; i++) {
+        if (s_ota_ws_fds[i] == fd) {
+            added = true;
+        }
+    }
+    for (int i = 0; i < OTA_WS_MAX_CLIENTS && !added; i++) {
+        if (s_ota_ws_fds[i] < 0) {
+            s_ota_ws_fds[i] = fd;
+            added = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_ota_ws_lock);
+    return added;
+}
+
+/**
+ * @brief Remover cliente WebSocket de progresso OTA
+ */
+static void ota_ws_remove_client(int fd)
+{
+    portENTER_CRITICAL(&s_ota_ws_lock);
+    for (int i = 0; i < OTA_WS_MAX_CLIENTS; i++) {
+        if (s_ota_ws_fds[i] == fd) {
+            s_ota_ws_fds[i] = -1;
+        }
+    }
+    portEXIT_CRITICAL(&s_ota_ws_lock);
+}
+
+/**
+ * @brief Enviar progresso OTA em JSON para um cliente WebSocket
+ */
+static esp_err_t ota_ws_send_progress(int fd, const ota_progress_t *progress)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "bytes_written", progress->bytes_written);
+    cJSON_AddNumberToObject(json, "total_bytes", progress->total_bytes);
+    cJSON_AddNumberToObject(json, "percentage", progress->percentage);
+    cJSON_AddBoolToObject(json, "in_progress", progress->in_progress);
+    cJSON_AddStringToObject(json, "status_message", progress->status_message);
+    cJSON_AddNumberToObject(json, "erase_bytes", progress->erase_bytes);
+    cJSON_AddNumberToObject(json, "erase_total", progress->erase_total);
+    cJSON_AddBoolToObject(json, "erase_in_progress", progress->erase_in_progress);
+    cJSON_AddNumberToObject(json, "resume_offset", progress->resume_offset);
+    
+    char *payload = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (!payload) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)payload,
+        .len = strlen(payload)
+    };
+    esp_err_t ret = httpd_ws_send_frame_async(s_server, fd, &frame);
+    
+    free(payload);
+    return ret;
+}
+
+/**
+ * @brief Callback de progresso OTA: repassar a todos os clientes WebSocket
+ * 
+ * O handler OTA só chama este callback quando o percentual ou o estado
+ * mudam, e nunca de forma concorrente.
+ */
+static void ota_progress_ws_cb(const ota_progress_t *progress)
+{
+    int fds[OTA_WS_MAX_CLIENTS];
+    portENTER_CRITICAL(&s_ota_ws_lock);
+    memcpy(fds, s_ota_ws_fds, sizeof(fds));
+    portEXIT_CRITICAL(&s_ota_ws_lock);
+    
+    for (int i = 0; i < OTA_WS_MAX_CLIENTS; i++) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        
+        // Descartar clientes que fecharam a conexão
+        if (httpd_ws_get_fd_info(s_server, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET ||
+            ota_ws_send_progress(fds[i], progress) != ESP_OK) {
+            ota_ws_remove_client(fds[i]);
+        }
+    }
+}
+
 esp_err_t web_server_init(void)
 {
     ESP_LOGI(TAG, "Inicializando servidor web");
@@ -153,12 +316,29 @@ esp_err_t web_server_init(void)
     config.server_port = 80;
     config.max_open_sockets = 7;
     config.max_resp_headers = 8;
-    config.max_uri_handlers = 15;
+    config.max_uri_handlers = 17;
     config.recv_wait_timeout = 25;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    
+    // Sem o pool, os handlers lentos rodam na task do httpd
+    if (http_async_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Pool assíncrono indisponível, handlers lentos serão inline");
+    }
     
-    if (httpd_start(&server, &config) == ESP_OK) {
+    int trace = boot_trace_begin("web_server.httpd_start");
+    esp_err_t ret = httpd_start(&server, &config);
+    boot_trace_end(trace);
+    
+    if (ret == ESP_OK) {
+        s_server = server;
+        
         // Registrar handlers
+        trace = boot_trace_begin("web_server.handlers");
         register_web_handlers(server);
+        boot_trace_end(trace);
+        
+        // Progresso OTA enviado aos clientes WebSocket
+        ota_register_progress_cb(ota_progress_ws_cb);
         ESP_LOGI(TAG, "Servidor web iniciado com sucesso na porta 80");
         return ESP_OK;
     }
@@ -173,590 +353,70 @@ esp_err_t register_web_handlers(httpd_handle_t server)
     
     // Registrar handlers
     ESP_LOGI(TAG, "Registrando root_uri: %s", root_uri.uri);
-    httpd_register_uri_handler(server, &root_uri);
+    http_metrics_register(server, &root_uri);
     
     ESP_LOGI(TAG, "Registrando dashboard_uri: %s", dashboard_uri.uri);
-    httpd_register_uri_handler(server, &dashboard_uri);
+    http_metrics_register(server, &dashboard_uri);
     
     ESP_LOGI(TAG, "Registrando wifi_config_get_uri: %s", wifi_config_get_uri.uri);
-    httpd_register_uri_handler(server, &wifi_config_get_uri);
+    http_metrics_register(server, &wifi_config_get_uri);
     
     ESP_LOGI(TAG, "Registrando wifi_config_post_uri: %s", wifi_config_post_uri.uri);
-    httpd_register_uri_handler(server, &wifi_config_post_uri);
+    http_metrics_register(server, &wifi_config_post_uri);
     
     ESP_LOGI(TAG, "Registrando ota_get_uri: %s", ota_get_uri.uri);
-    httpd_register_uri_handler(server, &ota_get_uri);
+    http_metrics_register(server, &ota_get_uri);
     
     ESP_LOGI(TAG, "Registrando ota_post_uri: %s", ota_post_uri.uri);
-    httpd_register_uri_handler(server, &ota_post_uri);
+    http_metrics_register(server, &ota_post_uri);
     
     ESP_LOGI(TAG, "Registrando wifi_scan_api_uri: %s", wifi_scan_api_uri.uri);
-    httpd_register_uri_handler(server, &wifi_scan_api_uri);
+    http_metrics_register(server, &wifi_scan_api_uri);
     
     ESP_LOGI(TAG, "Registrando status_api_uri: %s", status_api_uri.uri);
-    httpd_register_uri_handler(server, &status_api_uri);
+    http_metrics_register(server, &status_api_uri);
     
     ESP_LOGI(TAG, "Registrando firmware_api_uri: %s", firmware_api_uri.uri);
-    httpd_register_uri_handler(server, &firmware_api_uri);
+    http_metrics_register(server, &firmware_api_uri);
+    
+    ESP_LOGI(TAG, "Registrando boot_api_uri: %s", boot_api_uri.uri);
+    http_metrics_register(server, &boot_api_uri);
+    
+    ESP_LOGI(TAG, "Registrando metrics_api_uri: %s", metrics_api_uri.uri);
+    http_metrics_register(server, &metrics_api_uri);
     
     ESP_LOGI(TAG, "Registrando ota_partitions_api_uri: %s", ota_partitions_api_uri.uri);
-    httpd_register_uri_handler(server, &ota_partitions_api_uri);
+    http_metrics_register(server, &ota_partitions_api_uri);
+    
+#if WEB_PARTITION_DUMP_ENABLED
+    ESP_LOGI(TAG, "Registrando partition_dump_uri: %s", partition_dump_uri.uri);
+    http_metrics_register(server, &partition_dump_uri);
+#endif
     
     ESP_LOGI(TAG, "Registrando wechat_uri: %s", wechat_uri.uri);
-    httpd_register_uri_handler(server, &wechat_uri);
+    http_metrics_register(server, &wechat_uri);
     
     ESP_LOGI(TAG, "Registrando static_files_uri: %s", static_files_uri.uri);
-    httpd_register_uri_handler(server, &static_files_uri);
+    http_metrics_register(server, &static_files_uri);
     
-    ESP_LOGI(TAG, "Registrando static_bg_uri: %s", static_bg_uri.uri);
-    httpd_register_uri_handler(server, &static_bg_uri);
+    ESP_LOGI(TAG, "Registrando ota_ws_uri: %s", ota_ws_uri.uri);
+    http_metrics_register(server, &ota_ws_uri);
     
     ESP_LOGI(TAG, "Todos os handlers HTTP registrados com sucesso");
     return ESP_OK;
 }
 
-const char* get_main_page(void)
-{
-    return "<!DOCTYPE html>"
-           "<html><head>"
-           "<title>Maya Wi-Fi Zigbee Gateway</title>"
-           "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-           "<style>"
-           "* { margin: 0; padding: 0; box-sizing: border-box; }"
-           "body { font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif; background: url('/assets/images/maya-background.jpg') center/cover no-repeat fixed; min-height: 100vh; position: relative; }"
-           "body::before { content: ''; position: absolute; top: 0; left: 0; right: 0; bottom: 0; background: rgba(0, 0, 0, 0.4); z-index: -1; }"
-           ".container { max-width: 800px; margin: 0 auto; padding: 20px; }"
-           ".card { background: rgba(255, 255, 255, 0.95); backdrop-filter: blur(10px); border-radius: 20px; padding: 30px; box-shadow: 0 20px 40px rgba(0,0,0,0.1); margin-bottom: 20px; }"
-           ".header { text-align: center; margin-bottom: 30px; }"
-           ".logo { width: 120px; height: 120px; margin: 0 auto 20px; display: flex; align-items: center; justify-content: center; }"
-           ".logo-text { width: 100%; height: 100%; background: linear-gradient(45deg, #667eea, #764ba2); border-radius: 50%; display: flex; align-items: center; justify-content: center; color: white; font-size: 48px; font-weight: bold; font-family: 'Segoe UI', sans-serif; text-shadow: 0 2px 4px rgba(0,0,0,0.3); box-shadow: 0 8px 16px rgba(0,0,0,0.2); }"
-           "h1 { color: #2c3e50; font-size: 2.2em; margin-bottom: 10px; font-weight: 700; }"
-           ".subtitle { color: #7f8c8d; font-size: 1.1em; margin-bottom: 5px; }"
-           ".author { color: #95a5a6; font-size: 0.9em; font-style: italic; }"
-           ".status-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(200px, 1fr)); gap: 15px; margin: 20px 0; }"
-           ".status-card { background: #f8f9fa; padding: 20px; border-radius: 15px; text-align: center; border-left: 4px solid #3498db; }"
-           ".status-card.wifi { border-left-color: #27ae60; }"
-           ".status-card.ap { border-left-color: #e74c3c; }"
-           ".status-card.ota { border-left-color: #f39c12; }"
-           ".status-card.system { border-left-color: #9b59b6; }"
-           ".status-title { font-weight: bold; color: #2c3e50; margin-bottom: 10px; }"
-           ".status-value { font-size: 1.2em; color: #7f8c8d; }"
-           ".status-value.connected { color: #27ae60; }"
-           ".status-value.disconnected { color: #e74c3c; }"
-           ".button-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(200px, 1fr)); gap: 15px; margin: 30px 0; }"
-           ".button { display: block; padding: 15px 25px; background: linear-gradient(45deg, #3498db, #2980b9); color: white; text-decoration: none; border-radius: 10px; text-align: center; font-weight: bold; transition: all 0.3s ease; box-shadow: 0 5px 15px rgba(52, 152, 219, 0.3); }"
-           ".button:hover { transform: translateY(-2px); box-shadow: 0 8px 25px rgba(52, 152, 219, 0.4); }"
-           ".button.wifi { background: linear-gradient(45deg, #27ae60, #229954); }"
-           ".button.ota { background: linear-gradient(45deg, #f39c12, #e67e22); }"
-           ".button.status { background: linear-gradient(45deg, #9b59b6, #8e44ad); }"
-           ".button.info { background: linear-gradient(45deg, #34495e, #2c3e50); }"
-           ".footer { text-align: center; margin-top: 30px; color: #7f8c8d; font-size: 0.9em; }"
-           ".loading { display: inline-block; width: 20px; height: 20px; border: 3px solid #f3f3f3; border-top: 3px solid #3498db; border-radius: 50%; animation: spin 1s linear infinite; }"
-           "@keyframes spin { 0% { transform: rotate(0deg); } 100% { transform: rotate(360deg); } }"
-           ".alert { padding: 15px; margin: 15px 0; border-radius: 10px; font-weight: bold; }"
-           ".alert.success { background: #d4edda; color: #155724; border: 1px solid #c3e6cb; }"
-           ".alert.error { background: #f8d7da; color: #721c24; border: 1px solid #f5c6cb; }"
-           ".alert.info { background: #d1ecf1; color: #0c5460; border: 1px solid #bee5eb; }"
-           "</style></head>"
-           "<body>"
-           "<div class='container'>"
-           "<div class='card'>"
-           "<div class='header'>"
-           "<div class='logo'>"
-           "<div class='logo-text'>M</div>"
-           "</div>"
-           "<h1>Maya Wi-Fi Zigbee Gateway</h1>"
-           "<p class='subtitle'>Gateway Inteligente para IoT e Automação</p>"
-           "<p class='author'>Eng. Klaus Q. Terra - Hiperenge</p>"
-           "</div>"
-           "<div id='alerts'></div>"
-           "<div class='status-grid'>"
-           "<div class='status-card wifi'>"
-           "<div class='status-title'>Wi-Fi Status</div>"
-           "<div id='wifi-status' class='status-value'>Verificando...</div>"
-           "</div>"
-           "<div class='status-card ap'>"
-           "<div class='status-title'>SoftAP</div>"
-           "<div id='ap-status' class='status-value connected'>Ativo (pos_softap)</div>"
-           "</div>"
-           "<div class='status-card ota'>"
-           "<div class='status-title'>OTA Updates</div>"
-           "<div id='ota-status' class='status-value'>Disponível</div>"
-           "</div>"
-           "<div class='status-card system'>"
-           "<div class='status-title'>Sistema</div>"
-           "<div id='system-status' class='status-value'>Online</div>"
-           "</div>"
-           "</div>"
-           "<div class='button-grid'>"
-           "<a href='/dashboard' class='button status'>📊 Dashboard</a>"
-           "<a href='/wifi' class='button wifi'>📶 Configurar Wi-Fi</a>"
-           "<a href='/ota' class='button ota'>🔄 OTA Upgrade</a>"
-           "<a href='/api/status' class='button info'>ℹ️ Status API</a>"
-           "</div>"
-           "<div class='footer'>"
-           "<p>Maya Gateway v1.0.0 | Desenvolvido com ESP-IDF | © 2025 Hiperenge</p>"
-           "</div>"
-           "</div>"
-           "</div>"
-           "<script>"
-           "async function updateStatus() {"
-           "  try {"
-           "    const response = await fetch('/api/status');"
-           "    const data = await response.json();"
-           "    "
-           "    const wifiStatus = document.getElementById('wifi-status');"
-           "    const systemStatus = document.getElementById('system-status');"
-           "    "
-           "    if (data.wifi_connected) {"
-           "      wifiStatus.textContent = 'Conectado: ' + data.wifi_ssid;"
-           "      wifiStatus.className = 'status-value connected';"
-           "    } else {"
-           "      wifiStatus.textContent = 'Desconectado';"
-           "      wifiStatus.className = 'status-value disconnected';"
-           "    }"
-           "    "
-           "    systemStatus.textContent = 'Uptime: ' + Math.floor(data.uptime / 60) + 'min';"
-           "    "
-           "  } catch (error) {"
-           "    console.error('Erro ao atualizar status:', error);"
-           "  }"
-           "}"
-           ""
-           "// Atualizar status a cada 5 segundos"
-           "updateStatus();"
-           "setInterval(updateStatus, 5000);"
-           ""
-           "// Mostrar notificação de boas-vindas"
-           "setTimeout(() => {"
-           "  const alerts = document.getElementById('alerts');"
-           "  alerts.innerHTML = '<div class=\"alert info\">Bem-vindo ao ESP32-C6 Web Server AT! Use os botoes acima para configurar o dispositivo.</div>';"
-           "  setTimeout(() => alerts.innerHTML = '', 5000);"
-           "}, 1000);"
-           "</script>"
-           "</body></html>";
-}
-
-const char* get_dashboard_page(void)
-{
-    return "<!DOCTYPE html>"
-           "<html><head>"
-           "<title>Dashboard - Maya Gateway</title>"
-           "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-           "<style>"
-           "* { margin: 0; padding: 0; box-sizing: border-box; }"
-           "body { font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif; background: url('/assets/images/maya-background.jpg') center/cover no-repeat fixed; min-height: 100vh; position: relative; }"
-           "body::before { content: ''; position: absolute; top: 0; left: 0; right: 0; bottom: 0; background: rgba(0, 0, 0, 0.5); z-index: -1; }"
-           ".container { max-width: 1200px; margin: 0 auto; padding: 20px; }"
-           ".header { background: rgba(255, 255, 255, 0.1); backdrop-filter: blur(10px); border-radius: 20px; padding: 30px; margin-bottom: 30px; text-align: center; }"
-           ".header h1 { color: white; font-size: 3em; margin-bottom: 10px; }"
-           ".header p { color: rgba(255, 255, 255, 0.8); font-size: 1.2em; }"
-           ".grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(300px, 1fr)); gap: 20px; margin-bottom: 30px; }"
-           ".card { background: rgba(255, 255, 255, 0.95); backdrop-filter: blur(10px); border-radius: 20px; padding: 25px; box-shadow: 0 10px 30px rgba(0,0,0,0.1); }"
-           ".card h3 { color: #2c3e50; margin-bottom: 15px; font-size: 1.3em; }"
-           ".metric { display: flex; justify-content: space-between; align-items: center; padding: 10px 0; border-bottom: 1px solid #ecf0f1; }"
-           ".metric:last-child { border-bottom: none; }"
-           ".metric-label { color: #7f8c8d; font-weight: 500; }"
-           ".metric-value { color: #2c3e50; font-weight: bold; font-size: 1.1em; }"
-           ".metric-value.online { color: #27ae60; }"
-           ".metric-value.offline { color: #e74c3c; }"
-           ".chart-container { height: 200px; background: #f8f9fa; border-radius: 10px; display: flex; align-items: center; justify-content: center; color: #7f8c8d; margin: 15px 0; }"
-           ".button { display: inline-block; padding: 12px 24px; background: linear-gradient(45deg, #3498db, #2980b9); color: white; text-decoration: none; border-radius: 10px; font-weight: bold; transition: all 0.3s ease; margin: 5px; }"
-           ".button:hover { transform: translateY(-2px); box-shadow: 0 5px 15px rgba(52, 152, 219, 0.4); }"
-           ".button.refresh { background: linear-gradient(45deg, #27ae60, #229954); }"
-           ".button.config { background: linear-gradient(45deg, #f39c12, #e67e22); }"
-           ".status-indicator { display: inline-block; width: 12px; height: 12px; border-radius: 50%; margin-right: 8px; }"
-           ".status-indicator.online { background: #27ae60; }"
-           ".status-indicator.offline { background: #e74c3c; }"
-           ".loading { display: inline-block; width: 20px; height: 20px; border: 3px solid #f3f3f3; border-top: 3px solid #3498db; border-radius: 50%; animation: spin 1s linear infinite; }"
-           "@keyframes spin { 0% { transform: rotate(0deg); } 100% { transform: rotate(360deg); } }"
-           ".alert { padding: 15px; margin: 15px 0; border-radius: 10px; font-weight: bold; }"
-           ".alert.success { background: #d4edda; color: #155724; border: 1px solid #c3e6cb; }"
-           ".alert.error { background: #f8d7da; color: #721c24; border: 1px solid #f5c6cb; }"
-           ".alert.info { background: #d1ecf1; color: #0c5460; border: 1px solid #bee5eb; }"
-           "</style></head>"
-           "<body>"
-           "<div class='container'>"
-           "<div class='header'>"
-           "<h1>📊 Maya Gateway Dashboard</h1>"
-           "<p>Monitoramento em Tempo Real do Sistema IoT</p>"
-           "<p style='font-size: 0.9em; color: rgba(255, 255, 255, 0.7);'>Eng. Klaus Q. Terra - Hiperenge</p>"
-           "</div>"
-           "<div class='grid'>"
-           "<div class='card'>"
-           "<h3>🌐 Status de Rede</h3>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Wi-Fi</span>"
-           "<span id='wifi-status' class='metric-value'>Verificando...</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>SoftAP</span>"
-           "<span class='metric-value online'>Ativo (pos_softap)</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>IP Address</span>"
-           "<span id='ip-address' class='metric-value'>192.168.4.1</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Conexões</span>"
-           "<span id='connections' class='metric-value'>0</span>"
-           "</div>"
-           "</div>"
-           "<div class='card'>"
-           "<h3>💻 Sistema</h3>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Uptime</span>"
-           "<span id='uptime' class='metric-value'>Calculando...</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Memória Livre</span>"
-           "<span id='free-memory' class='metric-value'>Verificando...</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>CPU Freq</span>"
-           "<span class='metric-value'>160 MHz</span>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Temperatura</span>"
-           "<span id='temperature' class='metric-value'>N/A</span>"
-           "</div>"
-           "</div>"
-           "<div class='card'>"
-           "<h3>📈 Performance</h3>"
-           "<div class='chart-container'>"
-           "<div>Gráfico de Performance<br><small>Em desenvolvimento</small></div>"
-           "</div>"
-           "<div class='metric'>"
-           "<span class='metric-label'>Requisições/min</span>"
-           "<span id='requests-per-min' class='metric-value'>0</span>"
-           "</div>"
-           "</div>"
-           "<div class='card'>"
-           "<h3>🔧 Ações Rápidas</h3>"
-           "<a href='/' class='button'>🏠 Página Principal</a>"
-           "<a href='/wifi' class='button config'>📶 Configurar Wi-Fi</a>"
-           "<a href='/ota' class='button config'>🔄 OTA Update</a>"
-           "<button onclick='refreshData()' class='button refresh'>🔄 Atualizar</button>"
-           "</div>"
-           "</div>"
-           "<div id='alerts'></div>"
-           "</div>"
-           "<script>"
-           "let requestCount = 0;"
-           "let startTime = Date.now();"
-           ""
-           "async function fetchSystemData() {"
-           "  try {"
-           "    const response = await fetch('/api/status');"
-           "    const data = await response.json();"
-           "    "
-           "    // Atualizar status Wi-Fi"
-           "    const wifiStatus = document.getElementById('wifi-status');"
-           "    if (data.wifi_connected) {"
-           "      wifiStatus.textContent = 'Conectado: ' + data.wifi_ssid;"
-           "      wifiStatus.className = 'metric-value online';"
-           "    } else {"
-           "      wifiStatus.textContent = 'Desconectado';"
-           "      wifiStatus.className = 'metric-value offline';"
-           "    }"
-           "    "
-           "    // Atualizar uptime"
-           "    const uptime = document.getElementById('uptime');"
-           "    const uptimeMinutes = Math.floor(data.uptime / 60);"
-           "    const uptimeHours = Math.floor(uptimeMinutes / 60);"
-           "    const uptimeDays = Math.floor(uptimeHours / 24);"
-           "    "
-           "    if (uptimeDays > 0) {"
-           "      uptime.textContent = uptimeDays + 'd ' + (uptimeHours % 24) + 'h';"
-           "    } else if (uptimeHours > 0) {"
-           "      uptime.textContent = uptimeHours + 'h ' + (uptimeMinutes % 60) + 'm';"
-           "    } else {"
-           "      uptime.textContent = uptimeMinutes + 'm';"
-           "    }"
-           "    "
-           "    // Atualizar memória livre"
-           "    const freeMemory = document.getElementById('free-memory');"
-           "    freeMemory.textContent = Math.floor(data.free_heap / 1024) + ' KB';"
-           "    "
-           "    // Atualizar IP address"
-           "    const ipAddress = document.getElementById('ip-address');"
-           "    ipAddress.textContent = data.ap_ip || '192.168.4.1';"
-           "    "
-           "  } catch (error) {"
-           "    console.error('Erro ao buscar dados:', error);"
-           "    showAlert('Erro ao carregar dados do sistema', 'error');"
-           "  }"
-           "}"
-           ""
-           "function updateRequestCount() {"
-           "  const now = Date.now();"
-           "  const timeDiff = (now - startTime) / 1000 / 60; // minutos"
-           "  const requestsPerMin = Math.floor(requestCount / timeDiff);"
-           "  document.getElementById('requests-per-min').textContent = requestsPerMin;"
-           "}"
-           ""
-           "function showAlert(message, type) {"
-           "  const alerts = document.getElementById('alerts');"
-           "  const alert = document.createElement('div');"
-           "  alert.className = 'alert ' + type;"
-           "  alert.textContent = message;"
-           "  alerts.appendChild(alert);"
-           "  setTimeout(() => alert.remove(), 5000);"
-           "}"
-           ""
-           "function refreshData() {"
-           "  requestCount++;"
-           "  fetchSystemData();"
-           "  updateRequestCount();"
-           "  showAlert('Dados atualizados com sucesso!', 'success');"
-           "}"
-           ""
-           "// Carregar dados iniciais"
-           "fetchSystemData();"
-           ""
-           "// Atualizar dados a cada 10 segundos"
-           "setInterval(fetchSystemData, 10000);"
-           ""
-           "// Atualizar contador de requisições a cada minuto"
-           "setInterval(updateRequestCount, 60000);"
-           ""
-           "// Mostrar notificação de boas-vindas"
-           "setTimeout(() => {"
-           "  showAlert('Dashboard carregado! Dados atualizados automaticamente a cada 10 segundos.', 'info');"
-           "}, 1000);"
-           "</script>"
-           "</body></html>";
-}
-
-const char* get_wifi_config_page(void)
-{
-    return "<!DOCTYPE html>"
-           "<html><head>"
-           "<title>Configuração Wi-Fi - ESP32-C6</title>"
-           "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-           "<style>"
-           "body { font-family: Arial, sans-serif; margin: 20px; background: #f0f0f0; }"
-           ".container { max-width: 500px; margin: 0 auto; background: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }"
-           "h1 { color: #2c3e50; text-align: center; }"
-           "form { margin: 20px 0; }"
-           "label { display: block; margin: 10px 0 5px 0; font-weight: bold; }"
-           "input, select { width: 100%; padding: 10px; margin: 5px 0; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; }"
-           "button { width: 100%; padding: 12px; background: #3498db; color: white; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; }"
-           "button:hover { background: #2980b9; }"
-           ".button { display: inline-block; padding: 10px 20px; margin: 10px 5px; background: #95a5a6; color: white; text-decoration: none; border-radius: 5px; text-align: center; }"
-           ".status { padding: 10px; margin: 10px 0; border-radius: 5px; }"
-           ".success { background: #d4edda; color: #155724; border: 1px solid #c3e6cb; }"
-           ".error { background: #f8d7da; color: #721c24; border: 1px solid #f5c6cb; }"
-           ".loading { background: #d1ecf1; color: #0c5460; border: 1px solid #bee5eb; }"
-           "</style></head>"
-           "<body>"
-           "<div class='container'>"
-           "<h1>Configuração Wi-Fi</h1>"
-           "<div id='status'></div>"
-           "<form id='wifiForm'>"
-           "<label for='ssid'>Rede Wi-Fi:</label>"
-           "<select id='ssid' name='ssid' required>"
-           "<option value=''>Escaneando redes...</option>"
-           "</select>"
-           "<label for='password'>Senha:</label>"
-           "<input type='password' id='password' name='password' placeholder='Digite a senha da rede'>"
-           "<label>"
-           "<input type='checkbox' id='auto_connect' name='auto_connect' checked>"
-           " Conectar automaticamente"
-           "</label>"
-           "<button type='submit'>Conectar</button>"
-           "</form>"
-           "<a href='/' class='button'>Voltar</a>"
-           "</div>"
-           "<script>"
-           "// Carregar lista de redes"
-           "function loadNetworks() {"
-           "  document.getElementById('status').innerHTML = '<div class=\"loading\">Escaneando redes Wi-Fi...</div>';"
-           "  fetch('/api/wifi/scan')"
-           "  .then(response => response.json())"
-           "  .then(data => {"
-           "    const select = document.getElementById('ssid');"
-           "    select.innerHTML = '<option value=\"\">Selecione uma rede</option>';"
-           "    data.networks.forEach(network => {"
-           "      const option = document.createElement('option');"
-           "      option.value = network.ssid;"
-           "      option.textContent = network.ssid + ' (' + network.rssi + ' dBm)';"
-           "      select.appendChild(option);"
-           "    });"
-           "    document.getElementById('status').innerHTML = '';"
-           "  })"
-           "  .catch(error => {"
-           "    document.getElementById('status').innerHTML = '<div class=\"error\">Erro ao escanear redes: ' + error + '</div>';"
-           "  });"
-           "}"
-           ""
-           "// Enviar configuração"
-           "document.getElementById('wifiForm').addEventListener('submit', function(e) {"
-           "  e.preventDefault();"
-           "  const formData = new FormData(this);"
-           "  const data = Object.fromEntries(formData);"
-           "  data.auto_connect = document.getElementById('auto_connect').checked;"
-           ""
-           "  document.getElementById('status').innerHTML = '<div class=\"loading\">Conectando...</div>';"
-           ""
-           "  fetch('/wifi', {"
-           "    method: 'POST',"
-           "    headers: { 'Content-Type': 'application/json' },"
-           "    body: JSON.stringify(data)"
-           "  })"
-           "  .then(response => response.json())"
-           "  .then(data => {"
-           "    if (data.success) {"
-           "      document.getElementById('status').innerHTML = '<div class=\"success\">' + data.message + '</div>';"
-           "    } else {"
-           "      document.getElementById('status').innerHTML = '<div class=\"error\">' + data.message + '</div>';"
-           "    }"
-           "  })"
-           "  .catch(error => {"
-           "    document.getElementById('status').innerHTML = '<div class=\"error\">Erro: ' + error + '</div>';"
-           "  });"
-           "});"
-           ""
-           "// Carregar redes ao abrir a página"
-           "loadNetworks();"
-           "</script>"
-           "</body></html>";
-}
-
-const char* get_ota_page(void)
-{
-    return "<!DOCTYPE html>"
-           "<html><head>"
-           "<title>OTA Upgrade - ESP32-C6</title>"
-           "<meta name='viewport' content='width=device-width, initial-scale=1'>"
-           "<style>"
-           "body { font-family: Arial, sans-serif; margin: 20px; background: #f0f0f0; }"
-           ".container { max-width: 600px; margin: 0 auto; background: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }"
-           "h1 { color: #2c3e50; text-align: center; }"
-           "form { margin: 20px 0; }"
-           "label { display: block; margin: 10px 0 5px 0; font-weight: bold; }"
-           "input, select { width: 100%; padding: 10px; margin: 5px 0; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; }"
-           "button { width: 100%; padding: 12px; background: #e74c3c; color: white; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; }"
-           "button:hover { background: #c0392b; }"
-           ".button { display: inline-block; padding: 10px 20px; margin: 10px 5px; background: #95a5a6; color: white; text-decoration: none; border-radius: 5px; text-align: center; }"
-           ".status { padding: 10px; margin: 10px 0; border-radius: 5px; }"
-           ".success { background: #d4edda; color: #155724; border: 1px solid #c3e6cb; }"
-           ".error { background: #f8d7da; color: #721c24; border: 1px solid #f5c6cb; }"
-           ".loading { background: #d1ecf1; color: #0c5460; border: 1px solid #bee5eb; }"
-           ".info { background: #d1ecf1; color: #0c5460; border: 1px solid #bee5eb; }"
-           ".progress { width: 100%; background: #f0f0f0; border-radius: 5px; overflow: hidden; }"
-           ".progress-bar { height: 20px; background: #3498db; transition: width 0.3s; }"
-           "</style></head>"
-           "<body>"
-           "<div class='container'>"
-           "<h1>OTA Firmware Upgrade</h1>"
-           "<div id='status'></div>"
-           "<div id='firmware-info' class='info' style='display:none;'></div>"
-           "<form id='otaForm'>"
-           "<label for='partition'>Partição:</label>"
-           "<select id='partition' name='partition' required>"
-           "<option value=''>Carregando partições...</option>"
-           "</select>"
-           "<label for='firmware'>Arquivo de Firmware:</label>"
-           "<input type='file' id='firmware' name='firmware' accept='.bin' required>"
-           "<button type='submit'>Iniciar Upgrade</button>"
-           "</form>"
-           "<div id='progress' style='display:none;'>"
-           "<div class='progress'>"
-           "<div id='progress-bar' class='progress-bar' style='width: 0%;'></div>"
-           "</div>"
-           "<div id='progress-text'>0%</div>"
-           "</div>"
-           "<a href='/' class='button'>Voltar</a>"
-           "</div>"
-           "<script>"
-           "// Carregar informações do firmware"
-           "function loadFirmwareInfo() {"
-           "  fetch('/api/firmware')"
-           "  .then(response => response.json())"
-           "  .then(data => {"
-           "    const infoDiv = document.getElementById('firmware-info');"
-           "    infoDiv.innerHTML = 'Versão Atual: ' + data.version + '<br>AT Core: ' + data.at_core;"
-           "    infoDiv.style.display = 'block';"
-           "  });"
-           "}"
-           ""
-           "// Carregar partições"
-           "function loadPartitions() {"
-           "  fetch('/api/ota/partitions')"
-           "  .then(response => response.json())"
-           "  .then(data => {"
-           "    const select = document.getElementById('partition');"
-           "    select.innerHTML = '<option value=\"\">Selecione uma partição</option>';"
-           "    data.partitions.forEach(partition => {"
-           "      const option = document.createElement('option');"
-           "      option.value = partition.name;"
-           "      option.textContent = partition.name + ' (' + partition.size + ' bytes)';"
-           "      select.appendChild(option);"
-           "    });"
-           "  });"
-           "}"
-           ""
-           "// Enviar upgrade OTA"
-           "document.getElementById('otaForm').addEventListener('submit', function(e) {"
-           "  e.preventDefault();"
-           "  const formData = new FormData(this);"
-           "  const file = document.getElementById('firmware').files[0];"
-           "  if (!file) {"
-           "    document.getElementById('status').innerHTML = '<div class=\"error\">Selecione um arquivo de firmware</div>';"
-           "    return;"
-           "  }"
-           ""
-           "  const data = {"
-           "    partition: formData.get('partition'),"
-           "    file_name: file.name,"
-           "    file_size: file.size"
-           "  };"
-           ""
-           "  document.getElementById('status').innerHTML = '<div class=\"loading\">Iniciando upgrade...</div>';"
-           "  document.getElementById('progress').style.display = 'block';"
-           ""
-           "  // Simular progresso (em implementação real, usar WebSocket ou polling)"
-           "  let progress = 0;"
-           "  const progressInterval = setInterval(() => {"
-           "    progress += Math.random() * 10;"
-           "    if (progress > 100) progress = 100;"
-           "    document.getElementById('progress-bar').style.width = progress + '%';"
-           "    document.getElementById('progress-text').textContent = Math.round(progress) + '%';"
-           "    if (progress >= 100) {"
-           "      clearInterval(progressInterval);"
-           "      document.getElementById('status').innerHTML = '<div class=\"success\">Upgrade concluído com sucesso!</div>';"
-           "    }"
-           "  }, 200);"
-           "});"
-           ""
-           "// Carregar dados ao abrir a página"
-           "loadFirmwareInfo();"
-           "loadPartitions();"
-           "</script>"
-           "</body></html>";
-}
-
 // Implementação dos handlers HTTP
-esp_err_t root_get_handler(httpd_req_t *req)
-{
-    return send_html_response(req, get_main_page());
-}
-
-esp_err_t dashboard_get_handler(httpd_req_t *req)
-{
-    return send_html_response(req, get_dashboard_page());
-}
-
-esp_err_t wifi_config_get_handler(httpd_req_t *req)
-{
-    return send_html_response(req, get_wifi_config_page());
-}
-
 esp_err_t wifi_config_post_handler(httpd_req_t *req)
 {
+    // Conexão e gravação na NVS: em uma worker
+    esp_err_t ret = http_async_dispatch(req, wifi_config_post_handler);
+    if (ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    
     char buffer[512];
-    esp_err_t ret = extract_post_data(req, buffer, sizeof(buffer));
+    ret = extract_post_data(req, buffer, sizeof(buffer));
     if (ret != ESP_OK) {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Erro ao ler dados");
         return ESP_FAIL;
@@ -805,12 +465,329 @@ esp_err_t wifi_config_post_handler(httpd_req_t *req)
 
 esp_err_t ota_get_handler(httpd_req_t *req)
 {
-    return send_html_response(req, get_ota_page());
+    // O pré-apagamento espera os metadados (file_size) do POST /ota
+    return web_assets_send(req, web_assets_find("/ota.html"));
+}
+
+// Número máximo de timeouts consecutivos tolerados durante o upload OTA
+#define OTA_UPLOAD_MAX_TIMEOUTS 5
+
+// Função auxiliar para responder ao upload OTA
+static esp_err_t send_ota_result(httpd_req_t *req, const server_response_t *response)
+{
+    cJSON *response_json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response_json, "success", response->success);
+    cJSON_AddStringToObject(response_json, "message", response->message);
+    
+    char *response_str = cJSON_Print(response_json);
+    esp_err_t send_ret = send_json_response(req, response_str);
+    
+    free(response_str);
+    cJSON_Delete(response_json);
+    
+    return send_ret;
+}
+
+/**
+ * @brief Responder 416 informando o offset a partir do qual retomar
+ */
+static esp_err_t send_resume_mismatch(httpd_req_t *req)
+{
+    ota_resume_info_t info = {0};
+    ota_get_resume_info(&info);
+    
+    char offset_str[16];
+    snprintf(offset_str, sizeof(offset_str), "%u", (unsigned)info.offset);
+    httpd_resp_set_status(req, "416 Range Not Satisfiable");
+    httpd_resp_set_hdr(req, "X-OTA-Resume-Offset", offset_str);
+    
+    cJSON *response_json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response_json, "success", false);
+    cJSON_AddStringToObject(response_json, "message", "Offset de retomada não corresponde ao checkpoint");
+    cJSON_AddNumberToObject(response_json, "resume_offset", info.offset);
+    
+    char *response_str = cJSON_Print(response_json);
+    esp_err_t send_ret = send_json_response(req, response_str);
+    
+    free(response_str);
+    cJSON_Delete(response_json);
+    
+    return send_ret;
+}
+
+/**
+ * @brief Interpretar "Content-Range: bytes início-fim/total"
+ */
+static bool parse_content_range(const char *value, size_t *start, size_t *end, size_t *total)
+{
+    unsigned long first, last, length;
+    if (sscanf(value, "bytes %lu-%lu/%lu", &first, &last, &length) != 3 ||
+        first > last || last >= length) {
+        return false;
+    }
+    
+    *start = first;
+    *end = last;
+    *total = length;
+    return true;
+}
+
+/**
+ * @brief Ler exatamente len bytes do corpo da requisição
+ * 
+ * Tolera até OTA_UPLOAD_MAX_TIMEOUTS timeouts consecutivos do socket.
+ * 
+ * @return esp_err_t ESP_FAIL se a conexão for interrompida
+ */
+static esp_err_t recv_exact(httpd_req_t *req, uint8_t *buffer, size_t len)
+{
+    size_t received_total = 0;
+    int timeouts = 0;
+    
+    while (received_total < len) {
+        int received = httpd_req_recv(req, (char *)buffer + received_total, len - received_total);
+        
+        if (received == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < OTA_UPLOAD_MAX_TIMEOUTS) {
+            continue;
+        }
+        
+        if (received <= 0) {
+            ESP_LOGE(TAG, "Conexão interrompida durante upload OTA (%d)", received);
+            return ESP_FAIL;
+        }
+        
+        timeouts = 0;
+        received_total += received;
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Converter string hexadecimal em bytes
+ * 
+ * @return true se hex contém exatamente 2 * len dígitos válidos
+ */
+static bool hex_to_bytes(const char *hex, uint8_t *out, size_t len)
+{
+    if (strlen(hex) != len * 2) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            return false;
+        }
+        out[i] = (uint8_t)byte;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Upload em série: cada bloco é recebido e depois gravado
+ */
+static esp_err_t ota_upload_serial(httpd_req_t *req, size_t remaining, bool *conn_lost)
+{
+    uint8_t *chunk = malloc(OTA_STREAM_CHUNK_SIZE);
+    if (!chunk) {
+        ota_abort_upgrade();
+        return ESP_ERR_NO_MEM;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    while (remaining > 0) {
+        size_t len = remaining < OTA_STREAM_CHUNK_SIZE ? remaining : OTA_STREAM_CHUNK_SIZE;
+        if (recv_exact(req, chunk, len) != ESP_OK) {
+            ota_abort_upgrade();
+            *conn_lost = true;
+            ret = ESP_FAIL;
+            break;
+        }
+        
+        // ota_write_data() encerra a sessão OTA em caso de erro e
+        // finaliza o upgrade ao receber o último byte
+        ret = ota_write_data(chunk, len);
+        if (ret != ESP_OK) {
+            break;
+        }
+        
+        remaining -= len;
+    }
+    
+    free(chunk);
+    return ret;
+}
+
+/**
+ * @brief Upload em pipeline: recepção de um buffer enquanto o outro é gravado
+ */
+static esp_err_t ota_upload_pipelined(httpd_req_t *req, size_t remaining, bool *conn_lost)
+{
+    esp_err_t ret = ota_pipeline_begin();
+    if (ret != ESP_OK) {
+        ota_abort_upgrade();
+        return ret;
+    }
+    
+    while (remaining > 0) {
+        uint8_t *buffer = NULL;
+        size_t capacity = 0;
+        
+        // Bloqueia enquanto a flash estiver ocupada com os dois buffers
+        ret = ota_pipeline_get_buffer(&buffer, &capacity);
+        if (ret != ESP_OK) {
+            break;
+        }
+        
+        size_t len = remaining < capacity ? remaining : capacity;
+        if (recv_exact(req, buffer, len) != ESP_OK) {
+            *conn_lost = true;
+            ota_pipeline_end(true);
+            return ESP_FAIL;
+        }
+        
+        ota_pipeline_submit(buffer, len);
+        remaining -= len;
+    }
+    
+    esp_err_t end_ret = ota_pipeline_end(false);
+    return (ret != ESP_OK) ? ret : end_ret;
+}
+
+/**
+ * @brief Receber firmware em streaming (application/octet-stream)
+ * 
+ * O corpo da requisição é lido em blocos de OTA_STREAM_CHUNK_SIZE e cada
+ * bloco é entregue diretamente a ota_write_data(), de modo que o uso de
+ * memória é constante independentemente do tamanho da imagem.
+ */
+static esp_err_t ota_stream_upload(httpd_req_t *req)
+{
+    char query[64] = {0};
+    char partition[16] = {0};
+    char mode[16] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "partition", partition, sizeof(partition));
+        httpd_query_key_value(query, "mode", mode, sizeof(mode));
+    }
+    
+    // Pipeline (recepção e gravação em paralelo) por padrão; ?mode=serial
+    // mantém o caminho em série para comparação de desempenho
+    bool pipelined = strcmp(mode, "serial") != 0;
+    
+    size_t body_size = req->content_len;
+    if (body_size == 0) {
+        httpd_resp_send_err(req, HTTPD_411_LENGTH_REQUIRED, "Content-Length obrigatório");
+        return ESP_FAIL;
+    }
+    
+    // Retomada de upload interrompido: "Content-Range: bytes offset-(total-1)/total"
+    size_t image_size = body_size;
+    size_t offset = 0;
+    char range[64] = {0};
+    if (httpd_req_get_hdr_value_str(req, "Content-Range", range, sizeof(range)) == ESP_OK) {
+        size_t end = 0;
+        if (!parse_content_range(range, &offset, &end, &image_size) ||
+            end + 1 != image_size || end - offset + 1 != body_size) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content-Range inválido");
+            return ESP_FAIL;
+        }
+    }
+    
+    // SHA-256 opcional do arquivo, conferido ao final sem reler a flash
+    char sha_hex[2 * OTA_SHA256_SIZE + 1] = {0};
+    uint8_t expected_sha256[OTA_SHA256_SIZE];
+    bool has_sha256 = false;
+    if (httpd_req_get_hdr_value_str(req, "X-OTA-SHA256", sha_hex, sizeof(sha_hex)) == ESP_OK) {
+        has_sha256 = hex_to_bytes(sha_hex, expected_sha256, sizeof(expected_sha256));
+        if (!has_sha256) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "X-OTA-SHA256 inválido");
+            return ESP_FAIL;
+        }
+    }
+    
+    esp_err_t ret;
+    if (offset > 0) {
+        ret = ota_resume_streaming(partition[0] ? partition : NULL, image_size, offset);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            return send_resume_mismatch(req);
+        }
+    } else {
+        ret = ota_begin_streaming(partition[0] ? partition : NULL, image_size);
+    }
+    if (ret != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Não foi possível iniciar o upgrade OTA");
+        return ESP_FAIL;
+    }
+    
+    if (has_sha256) {
+        ota_set_expected_sha256(expected_sha256);
+    }
+    
+    bool conn_lost = false;
+    int64_t start_us = esp_timer_get_time();
+    if (pipelined) {
+        ret = ota_upload_pipelined(req, body_size, &conn_lost);
+    } else {
+        ret = ota_upload_serial(req, body_size, &conn_lost);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    
+    if (conn_lost) {
+        // Sem conexão não há para quem responder
+        return ESP_FAIL;
+    }
+    
+    server_response_t response = {0};
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Upload OTA (%s): %u bytes em %lld ms (%.2f MB/s)",
+                 pipelined ? "pipeline" : "serial",
+                 (unsigned)body_size, (long long)(elapsed_us / 1000),
+                 elapsed_us > 0 ? (double)body_size / (double)elapsed_us : 0.0);
+        response.success = true;
+        response.code = 200;
+        strcpy(response.message, "Upgrade OTA concluído, reinicie o dispositivo");
+    } else {
+        ESP_LOGE(TAG, "Erro ao gravar firmware: %s", esp_err_to_name(ret));
+        response.success = false;
+        response.code = 500;
+        strcpy(response.message, "Falha ao gravar firmware");
+        httpd_resp_set_status(req, HTTPD_500);
+    }
+    
+    return send_ota_result(req, &response);
 }
 
 esp_err_t ota_post_handler(httpd_req_t *req)
 {
-    // Implementação simplificada - em produção, usar multipart/form-data
+    // Upload e apagamento da flash: em uma worker
+    esp_err_t dispatch_ret = http_async_dispatch(req, ota_post_handler);
+    if (dispatch_ret != ESP_ERR_INVALID_STATE) {
+        return dispatch_ret;
+    }
+    
+    // Upload binário: gravar firmware em streaming
+    char content_type[48] = {0};
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) == ESP_OK &&
+        strstr(content_type, "application/octet-stream")) {
+        // Um upload por vez: outro na segunda worker disputaria a sessão OTA
+        if (__atomic_exchange_n(&s_ota_upload_active, true, __ATOMIC_ACQUIRE)) {
+            server_response_t response = {0};
+            response.success = false;
+            response.code = 409;
+            strcpy(response.message, "Upload OTA já em andamento");
+            httpd_resp_set_status(req, "409 Conflict");
+            return send_ota_result(req, &response);
+        }
+        
+        esp_err_t ret = ota_stream_upload(req);
+        __atomic_store_n(&s_ota_upload_active, false, __ATOMIC_RELEASE);
+        return ret;
+    }
+    
+    // Requisição JSON apenas com metadados do upgrade
     char buffer[512];
     esp_err_t ret = extract_post_data(req, buffer, sizeof(buffer));
     if (ret != ESP_OK) {
@@ -842,44 +819,352 @@ esp_err_t ota_post_handler(httpd_req_t *req)
     
     cJSON_Delete(json);
     
-    // Processar OTA (simplificado)
+    // Com o tamanho anunciado, apagar apenas os setores necessários
+    if (config.file_size > 0) {
+        ota_pre_erase_start(config.partition, config.file_size);
+    }
+    
+    // Os bytes do firmware chegam depois, via upload binário para /ota
     server_response_t response = {0};
     response.success = true;
     response.code = 200;
-    strcpy(response.message, "Upgrade OTA iniciado com sucesso");
+    strcpy(response.message, "Metadados recebidos, envie o firmware como application/octet-stream");
     
-    // Enviar resposta JSON
-    cJSON *response_json = cJSON_CreateObject();
-    cJSON_AddBoolToObject(response_json, "success", response.success);
-    cJSON_AddStringToObject(response_json, "message", response.message);
+    return send_ota_result(req, &response);
+}
+
+/**
+ * @brief Interpretar filtros da API de scan (?min_rssi=, ?auth=, ?limit=)
+ */
+static void parse_scan_filter(const char *query, wifi_scan_filter_t *filter)
+{
+    char value[16];
     
-    char *response_str = cJSON_Print(response_json);
-    esp_err_t send_ret = send_json_response(req, response_str);
+    memset(filter, 0, sizeof(*filter));
+    filter->min_rssi = -128;
     
-    free(response_str);
-    cJSON_Delete(response_json);
+    if (httpd_query_key_value(query, "min_rssi", value, sizeof(value)) == ESP_OK) {
+        filter->min_rssi = atoi(value);
+    }
+    if (httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK && atoi(value) > 0) {
+        filter->limit = atoi(value) > UINT16_MAX ? UINT16_MAX : atoi(value);
+    }
+    httpd_query_key_value(query, "auth", filter->auth, sizeof(filter->auth));
+}
+
+/**
+ * @brief Decodificar %XX e '+' de um valor de query string (no lugar)
+ */
+static void url_decode(char *value)
+{
+    char *out = value;
+    for (char *in = value; *in; in++) {
+        if (*in == '%' && isxdigit((unsigned char)in[1]) && isxdigit((unsigned char)in[2])) {
+            char hex[3] = {in[1], in[2], '\0'};
+            *out++ = (char)strtol(hex, NULL, 16);
+            in += 2;
+        } else {
+            *out++ = (*in == '+') ? ' ' : *in;
+        }
+    }
+    *out = '\0';
+}
+
+/**
+ * @brief Interpretar perfil de scan (?mode=, ?channel=, ?ssid=, ?dwell=)
+ * 
+ * @return true se algum parâmetro de perfil foi informado
+ */
+static bool parse_scan_params(const char *query, wifi_scan_params_t *params)
+{
+    char value[16];
+    bool found = false;
     
-    return send_ret;
+    memset(params, 0, sizeof(*params));
+    
+    if (httpd_query_key_value(query, "mode", value, sizeof(value)) == ESP_OK) {
+        for (int mode = WIFI_SCAN_MODE_FULL; mode <= WIFI_SCAN_MODE_PASSIVE; mode++) {
+            if (strcasecmp(value, wifi_manager_scan_mode_name(mode)) == 0) {
+                params->mode = mode;
+            }
+        }
+        found = true;
+    }
+    if (httpd_query_key_value(query, "channel", value, sizeof(value)) == ESP_OK) {
+        params->channel = atoi(value) > 0 && atoi(value) <= 14 ? atoi(value) : 0;
+        found = true;
+    }
+    if (httpd_query_key_value(query, "dwell", value, sizeof(value)) == ESP_OK) {
+        params->dwell_ms = atoi(value) > 0 && atoi(value) <= WIFI_SCAN_MAX_DWELL_MS ? atoi(value) : 0;
+        found = true;
+    }
+    if (httpd_query_key_value(query, "ssid", params->ssid, sizeof(params->ssid)) == ESP_OK) {
+        url_decode(params->ssid);
+        found = true;
+    }
+    return found;
 }
 
 esp_err_t wifi_scan_api_handler(httpd_req_t *req)
 {
-    return send_json_response(req, get_wifi_scan_results());
+    char query[192] = "";
+    char value[8];
+    wifi_scan_filter_t filter;
+    wifi_scan_params_t params;
+    
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    parse_scan_filter(query, &filter);
+    
+    // Perfil informado ou ?refresh=1: novo scan em segundo plano; a
+    // resposta traz o cache atual
+    if (parse_scan_params(query, &params)) {
+        wifi_manager_scan_request(&params);
+    } else if (httpd_query_key_value(query, "refresh", value, sizeof(value)) == ESP_OK &&
+               strcmp(value, "1") == 0) {
+        wifi_manager_scan_request(NULL);
+    }
+    
+    char buffer[WEB_JSON_CHUNK_SIZE];
+    json_writer_t w;
+    
+    set_json_headers(req);
+    json_writer_init_httpd(&w, req, buffer, sizeof(buffer));
+    get_wifi_scan_results(&w, &filter);
+    return json_writer_finish(&w);
 }
 
 esp_err_t status_api_handler(httpd_req_t *req)
 {
-    return send_json_response(req, get_system_status());
+    return send_json_stream(req, get_system_status);
 }
 
 esp_err_t firmware_api_handler(httpd_req_t *req)
 {
-    return send_json_response(req, get_firmware_info());
+    return send_json_stream(req, get_firmware_info);
+}
+
+esp_err_t boot_api_handler(httpd_req_t *req)
+{
+    return send_json_stream(req, boot_trace_write_json);
+}
+
+esp_err_t metrics_api_handler(httpd_req_t *req)
+{
+    // Formato Prometheus com ?format=prometheus ou Accept: text/plain
+    char query[32];
+    char format[16];
+    bool prometheus = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK) {
+        prometheus = strcmp(format, "prometheus") == 0;
+    } else {
+        char accept[64];
+        if (httpd_req_get_hdr_value_str(req, "Accept", accept, sizeof(accept)) == ESP_OK) {
+            prometheus = strstr(accept, "text/plain") != NULL;
+        }
+    }
+    
+    if (prometheus) {
+        return http_metrics_send_prometheus(req);
+    }
+    return send_json_stream(req, http_metrics_write_json);
 }
 
 esp_err_t ota_partitions_api_handler(httpd_req_t *req)
 {
-    return send_json_response(req, get_ota_partitions());
+    return send_json_stream(req, get_ota_partitions);
+}
+
+/**
+ * @brief Extrair o label de "/api/partition/<label>/dump[?query]"
+ */
+static esp_err_t parse_dump_label(const char *uri, char *label, size_t label_size)
+{
+    const char *prefix = "/api/partition/";
+    if (strncmp(uri, prefix, strlen(prefix)) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    const char *start = uri + strlen(prefix);
+    const char *end = strchr(start, '/');
+    if (!end || end == start || (size_t)(end - start) >= label_size ||
+        strncmp(end, "/dump", 5) != 0 || (end[5] != '\0' && end[5] != '?')) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    memcpy(label, start, end - start);
+    label[end - start] = '\0';
+    return ESP_OK;
+}
+
+/**
+ * @brief Localizar partição pelo label entre as listadas por ota_get_partitions
+ */
+static const esp_partition_t* find_dump_partition(const char *label)
+{
+    ota_partition_info_t partitions[16] = {0};
+    uint16_t count = 0;
+    
+    if (ota_get_partitions(partitions, 16, &count) != ESP_OK) {
+        return NULL;
+    }
+    
+    for (uint16_t i = 0; i < count; i++) {
+        if (strcmp(partitions[i].name, label) == 0) {
+            return esp_partition_find_first(partitions[i].type, partitions[i].subtype, label);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Enviar o conteúdo (ou intervalo) da partição em blocos
+ * 
+ * Cada leitura termina em um limite de setor, com um único buffer de
+ * WEB_PARTITION_DUMP_CHUNK_SIZE bytes. Com sha256_trailer, o hash dos
+ * dados enviados é calculado durante o envio e acrescentado ao final
+ * (apenas na partição inteira: em um 206 o corpo deve ser exatamente o
+ * intervalo declarado em Content-Range).
+ */
+static esp_err_t partition_dump_stream(httpd_req_t *req, const esp_partition_t *partition, bool sha256_trailer)
+{
+    // Sem ETag: o conteúdo da partição pode mudar (If-Range nunca corresponde)
+    http_range_t range;
+    if (http_range_parse(req, partition->size, NULL, &range) != ESP_OK) {
+        return http_range_send_unsatisfiable(req, partition->size);
+    }
+    
+    if (range.partial && sha256_trailer) {
+        ESP_LOGW(TAG, "sha256=1 ignorado em requisição com Range");
+        sha256_trailer = false;
+    }
+    
+    uint8_t *buffer = malloc(WEB_PARTITION_DUMP_CHUNK_SIZE);
+    if (!buffer) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Memória insuficiente");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    char disposition[64];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s.bin\"", partition->label);
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    if (sha256_trailer) {
+        httpd_resp_set_hdr(req, "X-SHA256-Trailer", "32");
+    }
+    
+    ESP_LOGI(TAG, "Dump da partição %s: %u bytes a partir de 0x%x",
+             partition->label, (unsigned)range.length, (unsigned)range.start);
+    
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    
+    esp_err_t ret = ESP_OK;
+    size_t offset = range.start;
+    size_t end = range.start + range.length;
+    while (ret == ESP_OK && offset < end) {
+        size_t n = WEB_PARTITION_DUMP_CHUNK_SIZE - (offset % WEB_PARTITION_DUMP_CHUNK_SIZE);
+        if (n > end - offset) {
+            n = end - offset;
+        }
+        
+        ret = esp_partition_read(partition, offset, buffer, n);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Erro ao ler %s em 0x%x: %s", partition->label, (unsigned)offset, esp_err_to_name(ret));
+            break;
+        }
+        
+        if (sha256_trailer) {
+            mbedtls_sha256_update(&sha, buffer, n);
+        }
+        ret = httpd_resp_send_chunk(req, (const char *)buffer, n);
+        offset += n;
+    }
+    
+    if (ret == ESP_OK && sha256_trailer) {
+        mbedtls_sha256_finish(&sha, buffer);
+        ret = httpd_resp_send_chunk(req, (const char *)buffer, 32);
+    }
+    mbedtls_sha256_free(&sha);
+    free(buffer);
+    
+    // Em caso de erro a resposta fica incompleta e o httpd fecha a conexão
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
+
+esp_err_t partition_dump_handler(httpd_req_t *req)
+{
+    // Até uma partição inteira lida da flash: em uma worker
+    esp_err_t ret = http_async_dispatch(req, partition_dump_handler);
+    if (ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    
+    char label[17];
+    if (parse_dump_label(req->uri, label, sizeof(label)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Endpoint não encontrado");
+        return ESP_FAIL;
+    }
+    
+    const esp_partition_t *partition = find_dump_partition(label);
+    if (!partition) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Partição não encontrada");
+        return ESP_FAIL;
+    }
+    
+#if !WEB_PARTITION_DUMP_ALLOW_NVS
+    if (partition->type == ESP_PARTITION_TYPE_DATA &&
+        (partition->subtype == ESP_PARTITION_SUBTYPE_DATA_NVS ||
+         partition->subtype == ESP_PARTITION_SUBTYPE_DATA_NVS_KEYS)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Dump de partição nvs não permitido");
+        return ESP_FAIL;
+    }
+#endif
+    
+    char query[32];
+    char value[8];
+    bool sha256_trailer = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                          httpd_query_key_value(query, "sha256", value, sizeof(value)) == ESP_OK &&
+                          strcmp(value, "1") == 0;
+    
+    return partition_dump_stream(req, partition, sha256_trailer);
+}
+
+esp_err_t ota_ws_handler(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+    
+    // Handshake concluído: registrar cliente e enviar o estado atual
+    if (req->method == HTTP_GET) {
+        if (!ota_ws_add_client(fd)) {
+            ESP_LOGW(TAG, "Limite de clientes WebSocket OTA atingido");
+            return ESP_FAIL;
+        }
+        
+        ota_progress_t progress = {0};
+        ota_get_progress(&progress);
+        return ota_ws_send_progress(fd, &progress);
+    }
+    
+    // Canal somente de envio: descartar mensagens do cliente
+    uint8_t buffer[64];
+    httpd_ws_frame_t frame = { .payload = buffer };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret == ESP_OK && frame.len > 0 && frame.len <= sizeof(buffer)) {
+        ret = httpd_ws_recv_frame(req, &frame, sizeof(buffer));
+    } else if (ret == ESP_OK && frame.len > sizeof(buffer)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    
+    if (ret != ESP_OK) {
+        ota_ws_remove_client(fd);
+    }
+    return ret;
 }
 
 esp_err_t wechat_handler(httpd_req_t *req)
@@ -894,52 +1179,21 @@ esp_err_t wechat_handler(httpd_req_t *req)
 
 esp_err_t static_file_handler(httpd_req_t *req)
 {
-    const char *uri = req->uri;
-    ESP_LOGI(TAG, "Solicitando arquivo: %s", uri);
-    
-    if (strstr(uri, "maya-logo.png")) {
-        // Retornar uma imagem PNG simples (1x1 pixel transparente)
-        const unsigned char png_data[] = {
-            0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
-            0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
-            0x08, 0x06, 0x00, 0x00, 0x00, 0x1F, 0x15, 0xC4, 0x89, 0x00, 0x00, 0x00,
-            0x0A, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0x00, 0x01, 0x00, 0x00,
-            0x05, 0x00, 0x01, 0x0D, 0x0A, 0x2D, 0xDB, 0x00, 0x00, 0x00, 0x00, 0x49,
-            0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82
-        };
-        httpd_resp_set_type(req, "image/png");
-        httpd_resp_send(req, (const char*)png_data, sizeof(png_data));
-        return ESP_OK;
-    }
-    
-    if (strstr(uri, "maya-background.jpg")) {
-        // Retornar uma imagem JPG simples (1x1 pixel)
-        const unsigned char jpg_data[] = {
-            0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A, 0x46, 0x49, 0x46, 0x00, 0x01,
-            0x01, 0x01, 0x00, 0x48, 0x00, 0x48, 0x00, 0x00, 0xFF, 0xDB, 0x00, 0x43,
-            0x00, 0x08, 0x06, 0x06, 0x07, 0x06, 0x05, 0x08, 0x07, 0x07, 0x07, 0x09,
-            0x09, 0x08, 0x0A, 0x0C, 0x14, 0x0D, 0x0C, 0x0B, 0x0B, 0x0C, 0x19, 0x12,
-            0x13, 0x0F, 0x14, 0x1D, 0x1A, 0x1F, 0x1E, 0x1D, 0x1A, 0x1C, 0x1C, 0x20,
-            0x24, 0x2E, 0x27, 0x20, 0x22, 0x2C, 0x23, 0x1C, 0x1C, 0x28, 0x37, 0x29,
-            0x2C, 0x30, 0x31, 0x34, 0x34, 0x34, 0x1F, 0x27, 0x39, 0x3D, 0x38, 0x32,
-            0x3C, 0x2E, 0x33, 0x34, 0x32, 0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x01,
-            0x00, 0x01, 0x01, 0x01, 0x11, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01,
-            0xFF, 0xC4, 0x00, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0xFF, 0xC4,
-            0x00, 0x14, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xDA, 0x00, 0x0C,
-            0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00, 0xAA, 0xFF, 0xD9
-        };
-        httpd_resp_set_type(req, "image/jpeg");
-        httpd_resp_send(req, (const char*)jpg_data, sizeof(jpg_data));
-        return ESP_OK;
+    ESP_LOGI(TAG, "Solicitando arquivo: %s", req->uri);
+    
+    // Partição spiffs; assets embutidos no firmware como alternativa
+    const static_file_t *file = static_files_find(req->uri);
+    if (file) {
+        // Arquivos grandes da spiffs: em uma worker
+        if (file->size > WEB_ASYNC_STATIC_MIN_SIZE) {
+            esp_err_t ret = http_async_dispatch(req, static_file_handler);
+            if (ret != ESP_ERR_INVALID_STATE) {
+                return ret;
+            }
+        }
+        return static_files_send(req, file);
     }
-    
-    // Para outros arquivos, retornar 404
-    httpd_resp_set_status(req, "404 Not Found");
-    httpd_resp_set_type(req, "text/plain");
-    httpd_resp_send(req, "File not found", HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
+    return web_assets_send(req, web_assets_find(req->uri));
 }
 
 // Implementação das funções auxiliares
@@ -984,183 +1238,246 @@ server_response_t process_ota_upgrade(const ota_config_data_t *data,
 {
     server_response_t response = {0};
     
-    // Implementação simplificada - em produção, usar esp_ota_ops
-    if (file_size == 0) {
+    if (!file_data || file_size == 0) {
         response.success = false;
         response.code = 400;
         strcpy(response.message, "Arquivo vazio");
         return response;
     }
     
-    // Simular sucesso
-    response.success = true;
-    response.code = 200;
-    strcpy(response.message, "Upgrade OTA concluído com sucesso");
+    esp_err_t ret = ota_start_upgrade(data->partition, file_data, file_size);
+    if (ret == ESP_OK) {
+        // ota_write_data() finaliza o upgrade ao gravar o último byte
+        ret = ota_write_data(file_data, file_size);
+    }
+    
+    if (ret == ESP_OK) {
+        response.success = true;
+        response.code = 200;
+        strcpy(response.message, "Upgrade OTA concluído com sucesso");
+    } else {
+        response.success = false;
+        response.code = 500;
+        strcpy(response.message, "Erro ao aplicar upgrade OTA");
+    }
     
     return response;
 }
 
-const char* get_wifi_scan_results(void)
+/**
+ * @brief Nome do modo de autenticação para a API de scan
+ */
+static const char* auth_mode_name(wifi_auth_mode_t auth_mode)
 {
-    static char json_buffer[2048];
-    cJSON *json = cJSON_CreateObject();
-    cJSON *networks = cJSON_CreateArray();
-    
-    // Fazer scan real de redes Wi-Fi
-    wifi_scan_result_t scan_results[20];
-    uint16_t scan_count = 0;
+    switch (auth_mode) {
+        case WIFI_AUTH_OPEN:
+            return "Open";
+        case WIFI_AUTH_WEP:
+            return "WEP";
+        case WIFI_AUTH_WPA_PSK:
+            return "WPA";
+        case WIFI_AUTH_WPA2_PSK:
+            return "WPA2";
+        case WIFI_AUTH_WPA_WPA2_PSK:
+            return "WPA/WPA2";
+        case WIFI_AUTH_WPA3_PSK:
+            return "WPA3";
+        default:
+            return "Unknown";
+    }
+}
+
+/**
+ * @brief Escrever BSSID no formato aa:bb:cc:dd:ee:ff
+ */
+static void add_bssid(json_writer_t *w, const char *key, const uint8_t bssid[6])
+{
+    char text[18];
+    snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x",
+             bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+    json_writer_add_string(w, key, text);
+}
+
+esp_err_t get_wifi_scan_results(json_writer_t *w, const wifi_scan_filter_t *filter)
+{
+    // Apenas o cache: o scan roda na task do wifi_manager
+    const wifi_scan_store_t *store = wifi_manager_scan_acquire();
+    wifi_scan_cache_info_t info = {0};
+    wifi_manager_get_scan_cache(NULL, 0, &info);
+    
+    // Cache vazio: iniciar o primeiro scan (o cliente consulta de novo)
+    if (!store && !info.scanning) {
+        info.scanning = wifi_manager_scan_request(NULL) == ESP_OK;
+    }
     
-    esp_err_t ret = wifi_manager_scan(scan_results, 20, &scan_count);
-    if (ret == ESP_OK && scan_count > 0) {
-        ESP_LOGI(TAG, "Scan real: %d redes encontradas", scan_count);
+    // Redes já ordenadas por RSSI; o filtro de sinal vale também por BSSID
+    int count = 0;
+    json_writer_object_begin(w, NULL);
+    json_writer_array_begin(w, "networks");
+    for (int i = 0; store && i < store->network_count; i++) {
+        const wifi_scan_result_t *network = &store->networks[i];
+        if (filter->limit > 0 && count >= filter->limit) {
+            break;
+        }
+        if (network->rssi < filter->min_rssi ||
+            (filter->auth[0] && strcasecmp(filter->auth, auth_mode_name(network->auth_mode)) != 0)) {
+            continue;
+        }
         
-        for (int i = 0; i < scan_count; i++) {
-            cJSON *network = cJSON_CreateObject();
-            cJSON_AddStringToObject(network, "ssid", scan_results[i].ssid);
-            cJSON_AddNumberToObject(network, "rssi", scan_results[i].rssi);
-            
-            // Converter auth_mode para string
-            const char *auth_str = "Open";
-            switch (scan_results[i].auth_mode) {
-                case WIFI_AUTH_OPEN:
-                    auth_str = "Open";
-                    break;
-                case WIFI_AUTH_WEP:
-                    auth_str = "WEP";
-                    break;
-                case WIFI_AUTH_WPA_PSK:
-                    auth_str = "WPA";
-                    break;
-                case WIFI_AUTH_WPA2_PSK:
-                    auth_str = "WPA2";
-                    break;
-                case WIFI_AUTH_WPA_WPA2_PSK:
-                    auth_str = "WPA/WPA2";
-                    break;
-                case WIFI_AUTH_WPA3_PSK:
-                    auth_str = "WPA3";
-                    break;
-                default:
-                    auth_str = "Unknown";
-                    break;
+        json_writer_object_begin(w, NULL);
+        json_writer_add_string(w, "ssid", network->ssid);
+        json_writer_add_int(w, "rssi", network->rssi);
+        json_writer_add_string(w, "auth", auth_mode_name(network->auth_mode));
+        json_writer_add_int(w, "channel", network->channel);
+        add_bssid(w, "bssid", network->bssid);
+        json_writer_array_begin(w, "bssids");
+        for (int j = 0; j < network->ap_count; j++) {
+            const wifi_scan_ap_t *ap = &store->aps[network->first_ap + j];
+            if (ap->rssi < filter->min_rssi) {
+                break;
             }
-            
-            cJSON_AddStringToObject(network, "auth", auth_str);
-            cJSON_AddNumberToObject(network, "channel", scan_results[i].channel);
-            cJSON_AddItemToArray(networks, network);
+            json_writer_object_begin(w, NULL);
+            add_bssid(w, "bssid", ap->bssid);
+            json_writer_add_int(w, "rssi", ap->rssi);
+            json_writer_add_int(w, "channel", ap->channel);
+            json_writer_object_end(w);
         }
-    } else {
-        ESP_LOGW(TAG, "Erro no scan ou nenhuma rede encontrada: %s", esp_err_to_name(ret));
-        
-        // Adicionar rede de fallback para debug
-        cJSON *network = cJSON_CreateObject();
-        cJSON_AddStringToObject(network, "ssid", "pos_softap");
-        cJSON_AddNumberToObject(network, "rssi", -30);
-        cJSON_AddStringToObject(network, "auth", "WPA2");
-        cJSON_AddNumberToObject(network, "channel", 11);
-        cJSON_AddItemToArray(networks, network);
+        json_writer_array_end(w);
+        json_writer_object_end(w);
+        count++;
     }
-    
-    cJSON_AddItemToObject(json, "networks", networks);
-    cJSON_AddNumberToObject(json, "count", scan_count);
-    
-    char *json_string = cJSON_Print(json);
-    strncpy(json_buffer, json_string, sizeof(json_buffer) - 1);
-    json_buffer[sizeof(json_buffer) - 1] = '\0';
-    
-    free(json_string);
-    cJSON_Delete(json);
-    
-    return json_buffer;
+    json_writer_array_end(w);
+    json_writer_add_int(w, "count", count);
+    json_writer_add_int(w, "total", store ? store->network_count : 0);
+    json_writer_add_int(w, "ap_count", store ? store->ap_count : 0);
+    json_writer_add_string(w, "mode", wifi_manager_scan_mode_name(store ? store->params.mode : WIFI_SCAN_MODE_FULL));
+    json_writer_add_bool(w, "partial", store && (store->params.channel != 0 || store->params.ssid[0] != '\0'));
+    json_writer_add_int(w, "age_ms", info.age_ms);
+    json_writer_add_bool(w, "scanning", info.scanning);
+    json_writer_object_end(w);
+    
+    wifi_manager_scan_release(store);
+    return w->error;
 }
 
-const char* get_system_status(void)
+esp_err_t get_system_status(json_writer_t *w)
 {
-    static char json_buffer[1024];
-    cJSON *json = cJSON_CreateObject();
+    json_writer_object_begin(w, NULL);
     
     // Status Wi-Fi
     bool wifi_connected = wifi_manager_is_connected();
-    cJSON_AddBoolToObject(json, "wifi_connected", wifi_connected);
-    cJSON_AddStringToObject(json, "wifi_ssid", wifi_connected ? "Conectado" : "Desconectado");
+    json_writer_add_bool(w, "wifi_connected", wifi_connected);
+    json_writer_add_string(w, "wifi_ssid", wifi_connected ? "Conectado" : "Desconectado");
+    
+    // Reconexão automática do STA
+    wifi_reconnect_stats_t reconnect;
+    wifi_reconnect_get_stats(&reconnect);
+    json_writer_object_begin(w, "wifi_reconnect");
+    json_writer_add_int(w, "disconnects", reconnect.state.disconnects);
+    json_writer_add_int(w, "attempts", reconnect.state.attempts);
+    json_writer_add_int(w, "consecutive", reconnect.state.consecutive);
+    json_writer_add_int(w, "last_reason", reconnect.state.last_reason);
+    json_writer_add_string(w, "policy", reconnect.state.disconnects ?
+                           wifi_reconnect_policy_name(wifi_reconnect_classify(reconnect.state.last_reason)) : NULL);
+    json_writer_add_int(w, "last_delay_ms", reconnect.state.last_delay_ms);
+    json_writer_add_int(w, "next_attempt_ms", reconnect.next_attempt_ms);
+    json_writer_add_bool(w, "gave_up", reconnect.state.gave_up);
+    json_writer_object_end(w);
+    
+    // Pool de handlers lentos
+    http_async_stats_t async_stats;
+    http_async_get_stats(&async_stats);
+    json_writer_object_begin(w, "http_async");
+    json_writer_add_int(w, "workers", HTTP_ASYNC_WORKERS);
+    json_writer_add_int(w, "busy", async_stats.busy);
+    json_writer_add_int(w, "queued", async_stats.queued);
+    json_writer_add_int(w, "dispatched", async_stats.dispatched);
+    json_writer_add_int(w, "rejected", async_stats.rejected);
+    json_writer_add_int(w, "max_wait_us", async_stats.max_wait_us);
+    json_writer_object_end(w);
     
     // SoftAP sempre ativo
-    cJSON_AddBoolToObject(json, "ap_active", true);
-    cJSON_AddStringToObject(json, "ap_ssid", "pos_softap");
-    cJSON_AddStringToObject(json, "ap_ip", "192.168.4.1");
+    json_writer_add_bool(w, "ap_active", true);
+    json_writer_add_string(w, "ap_ssid", "pos_softap");
+    json_writer_add_string(w, "ap_ip", "192.168.4.1");
     
     // Uptime em segundos (usando FreeRTOS tick count)
     uint32_t uptime_seconds = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
-    cJSON_AddNumberToObject(json, "uptime", uptime_seconds);
+    json_writer_add_int(w, "uptime", uptime_seconds);
     
     // Memória
-    cJSON_AddNumberToObject(json, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(json, "min_free_heap", esp_get_minimum_free_heap_size());
+    json_writer_add_int(w, "free_heap", esp_get_free_heap_size());
+    json_writer_add_int(w, "min_free_heap", esp_get_minimum_free_heap_size());
     
     // Informações do sistema
-    cJSON_AddStringToObject(json, "version", "Maya Gateway v1.0.0");
-    cJSON_AddStringToObject(json, "chip_model", "ESP32-C6");
-    cJSON_AddNumberToObject(json, "cpu_freq", 160);
+    json_writer_add_string(w, "version", "Maya Gateway v1.0.0");
+    json_writer_add_string(w, "chip_model", "ESP32-C6");
+    json_writer_add_int(w, "cpu_freq", 160);
     
     // Status geral
-    cJSON_AddStringToObject(json, "status", "online");
-    cJSON_AddStringToObject(json, "author", "Eng. Klaus Q. Terra - Hiperenge");
-    
-    char *json_string = cJSON_Print(json);
-    strncpy(json_buffer, json_string, sizeof(json_buffer) - 1);
-    json_buffer[sizeof(json_buffer) - 1] = '\0';
-    
-    free(json_string);
-    cJSON_Delete(json);
+    json_writer_add_string(w, "status", "online");
+    json_writer_add_string(w, "author", "Eng. Klaus Q. Terra - Hiperenge");
     
-    return json_buffer;
+    json_writer_object_end(w);
+    return w->error;
 }
 
-const char* get_firmware_info(void)
+esp_err_t get_firmware_info(json_writer_t *w)
 {
-    static char json_buffer[256];
-    cJSON *json = cJSON_CreateObject();
-    
-    cJSON_AddStringToObject(json, "version", "1.0.0");
-    cJSON_AddStringToObject(json, "at_core", "2.4.0.0");
-    cJSON_AddStringToObject(json, "build_date", __DATE__ " " __TIME__);
-    
-    char *json_string = cJSON_Print(json);
-    strncpy(json_buffer, json_string, sizeof(json_buffer) - 1);
-    json_buffer[sizeof(json_buffer) - 1] = '\0';
-    
-    free(json_string);
-    cJSON_Delete(json);
+    json_writer_object_begin(w, NULL);
+    
+    json_writer_add_string(w, "version", "1.0.0");
+    json_writer_add_string(w, "at_core", "2.4.0.0");
+    json_writer_add_string(w, "build_date", __DATE__ " " __TIME__);
+    
+    // Hash em cache: calculado apenas na primeira requisição
+    uint8_t hash[OTA_SHA256_SIZE];
+    if (ota_get_firmware_hash(hash, sizeof(hash)) == ESP_OK) {
+        char hash_hex[2 * OTA_SHA256_SIZE + 1];
+        for (int i = 0; i < OTA_SHA256_SIZE; i++) {
+            sprintf(hash_hex + 2 * i, "%02x", hash[i]);
+        }
+        json_writer_add_string(w, "sha256", hash_hex);
+    }
     
-    return json_buffer;
+    json_writer_object_end(w);
+    return w->error;
 }
 
-const char* get_ota_partitions(void)
+esp_err_t get_ota_partitions(json_writer_t *w)
 {
-    static char json_buffer[512];
-    cJSON *json = cJSON_CreateObject();
-    cJSON *partitions = cJSON_CreateArray();
+    json_writer_object_begin(w, NULL);
+    json_writer_array_begin(w, "partitions");
+    
+    // Upload interrompido que pode ser retomado via Content-Range
+    ota_resume_info_t resume = {0};
+    bool has_resume = ota_get_resume_info(&resume) == ESP_OK;
     
     // Simular partições (em produção, usar esp_ota_get_partition_table)
     const char *partition_names[] = {"ota_0", "ota_1", "nvs", "spiffs"};
     const int partition_sizes[] = {1048576, 1048576, 24576, 1048576};
     
     for (int i = 0; i < 4; i++) {
-        cJSON *partition = cJSON_CreateObject();
-        cJSON_AddStringToObject(partition, "name", partition_names[i]);
-        cJSON_AddNumberToObject(partition, "size", partition_sizes[i]);
-        cJSON_AddStringToObject(partition, "type", i < 2 ? "app" : "data");
-        cJSON_AddItemToArray(partitions, partition);
+        json_writer_object_begin(w, NULL);
+        json_writer_add_string(w, "name", partition_names[i]);
+        json_writer_add_int(w, "size", partition_sizes[i]);
+        json_writer_add_string(w, "type", i < 2 ? "app" : "data");
+        json_writer_add_int(w, "resume_offset",
+                            has_resume && strcmp(resume.partition, partition_names[i]) == 0 ?
+                            resume.offset : 0);
+        json_writer_object_end(w);
     }
     
-    cJSON_AddItemToObject(json, "partitions", partitions);
+    json_writer_array_end(w);
     
-    char *json_string = cJSON_Print(json);
-    strncpy(json_buffer, json_string, sizeof(json_buffer) - 1);
-    json_buffer[sizeof(json_buffer) - 1] = '\0';
-    
-    free(json_string);
-    cJSON_Delete(json);
+    if (has_resume) {
+        json_writer_object_begin(w, "resume");
+        json_writer_add_string(w, "partition", resume.partition);
+        json_writer_add_int(w, "offset", resume.offset);
+        json_writer_add_int(w, "total", resume.total_bytes);
+        json_writer_object_end(w);
+    }
     
-    return json_buffer;
+    json_writer_object_end(w);
+    return w->error;
 }
@@ -11,11 +11,29 @@
 
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "json_writer.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Leitura de partições da flash via /api/partition/<label>/dump, sem
+// autenticação: desabilitada por padrão, habilitar só para diagnóstico
+#define WEB_PARTITION_DUMP_ENABLED 0
+
+// Permitir o dump de partições nvs (contêm as credenciais Wi-Fi salvas)
+#define WEB_PARTITION_DUMP_ALLOW_NVS 0
+
+// Buffer (na pilha do handler) das respostas JSON enviadas em blocos
+#define WEB_JSON_CHUNK_SIZE 512
+
+// Bloco de leitura do dump: um setor da flash
+#define WEB_PARTITION_DUMP_CHUNK_SIZE 4096
+
+// Arquivos da spiffs acima deste tamanho são enviados por um worker
+// (http_async); os menores, direto na task do httpd
+#define WEB_ASYNC_STATIC_MIN_SIZE (16 * 1024)
+
 // Estrutura para dados de configuração Wi-Fi
 typedef struct {
     char ssid[32];
@@ -30,6 +48,13 @@ typedef struct {
     char file_name[64];
 } ota_config_data_t;
 
+// Filtros da API de scan
+typedef struct {
+    int min_rssi;               // Sinal mínimo em dBm (-128: sem filtro)
+    char auth[16];              // Nome do modo, ex.: "WPA2" ("": qualquer)
+    uint16_t limit;             // Máximo de redes (0: sem limite)
+} wifi_scan_filter_t;
+
 // Estrutura para resposta do servidor
 typedef struct {
     int code;
@@ -52,34 +77,6 @@ esp_err_t web_server_init(void);
  */
 esp_err_t register_web_handlers(httpd_handle_t server);
 
-/**
- * @brief Obter página principal
- * 
- * @return const char* HTML da página principal
- */
-const char* get_main_page(void);
-
-/**
- * @brief Obter página de dashboard
- * 
- * @return const char* HTML da página de dashboard
- */
-const char* get_dashboard_page(void);
-
-/**
- * @brief Obter página de configuração Wi-Fi
- * 
- * @return const char* HTML da página de configuração
- */
-const char* get_wifi_config_page(void);
-
-/**
- * @brief Obter página OTA
- * 
- * @return const char* HTML da página OTA
- */
-const char* get_ota_page(void);
-
 /**
  * @brief Processar configuração Wi-Fi
  * 
@@ -100,48 +97,57 @@ server_response_t process_ota_upgrade(const ota_config_data_t *data,
                                      const uint8_t *file_data, 
                                      size_t file_size);
 
-/**
- * @brief Obter lista de redes Wi-Fi
+/*
+ * Geradores das respostas JSON da API.
  * 
- * @return const char* JSON com lista de redes
+ * Escrevem no json_writer_t do chamador, sem estado compartilhado entre
+ * requisições. Os handlers usam json_writer_init_httpd() (a resposta é
+ * enviada em blocos, sem limite de tamanho); para obter o JSON em memória,
+ * use json_writer_init() com um buffer próprio e verifique o retorno de
+ * json_writer_finish() (w.total informa o tamanho necessário).
  */
-const char* get_wifi_scan_results(void);
 
 /**
- * @brief Obter status do sistema
+ * @brief Escrever lista de redes Wi-Fi
  * 
- * @return const char* JSON com status
- */
-const char* get_system_status(void);
-
-/**
- * @brief Obter informações de firmware
+ * Usa apenas o cache do serviço de scan (não bloqueia), com a idade dos
+ * resultados em "age_ms" e "scanning" indicando scan em andamento. Redes
+ * saem ordenadas por RSSI, cada uma com a lista de BSSIDs do mesmo SSID.
  * 
- * @return const char* JSON com informações de firmware
+ * @param w Emissor JSON
+ * @param filter Filtros de sinal, autenticação e quantidade
+ * @return esp_err_t Estado do emissor
  */
-const char* get_firmware_info(void);
+esp_err_t get_wifi_scan_results(json_writer_t *w, const wifi_scan_filter_t *filter);
 
 /**
- * @brief Obter lista de partições OTA
+ * @brief Escrever status do sistema
  * 
- * @return const char* JSON com lista de partições
+ * @param w Emissor JSON
+ * @return esp_err_t Estado do emissor
  */
-const char* get_ota_partitions(void);
+esp_err_t get_system_status(json_writer_t *w);
 
 /**
- * @brief Handler para página principal
+ * @brief Escrever informações de firmware
+ * 
+ * @param w Emissor JSON
+ * @return esp_err_t Estado do emissor
  */
-esp_err_t root_get_handler(httpd_req_t *req);
+esp_err_t get_firmware_info(json_writer_t *w);
 
 /**
- * @brief Handler para dashboard
+ * @brief Escrever lista de partições OTA
+ * 
+ * @param w Emissor JSON
+ * @return esp_err_t Estado do emissor
  */
-esp_err_t dashboard_get_handler(httpd_req_t *req);
+esp_err_t get_ota_partitions(json_writer_t *w);
 
 /**
- * @brief Handler para configuração Wi-Fi
+ * @brief Handler para configuração Wi-Fi (as páginas HTML são servidas
+ *        por web_assets_handler())
  */
-esp_err_t wifi_config_get_handler(httpd_req_t *req);
 esp_err_t wifi_config_post_handler(httpd_req_t *req);
 
 /**
@@ -165,11 +171,38 @@ esp_err_t status_api_handler(httpd_req_t *req);
  */
 esp_err_t firmware_api_handler(httpd_req_t *req);
 
+/**
+ * @brief Handler para API da linha do tempo do boot
+ */
+esp_err_t boot_api_handler(httpd_req_t *req);
+
+/**
+ * @brief Handler para API de métricas HTTP (JSON ou Prometheus)
+ */
+esp_err_t metrics_api_handler(httpd_req_t *req);
+
 /**
  * @brief Handler para API de partições OTA
  */
 esp_err_t ota_partitions_api_handler(httpd_req_t *req);
 
+/**
+ * @brief Handler de leitura de partição (/api/partition/<label>/dump)
+ * 
+ * Envia o conteúdo da partição direto da flash, em blocos de um setor.
+ * Aceita Range (um intervalo) e, com "?sha256=1", acrescenta ao final do
+ * corpo os 32 bytes do SHA-256 dos dados enviados.
+ */
+esp_err_t partition_dump_handler(httpd_req_t *req);
+
+/**
+ * @brief Handler WebSocket de progresso OTA (/ws/ota)
+ * 
+ * Canal somente de envio: cada mensagem é um ota_progress_t em JSON,
+ * publicada quando o percentual ou o estado do upgrade mudam.
+ */
+esp_err_t ota_ws_handler(httpd_req_t *req);
+
 /**
  * @brief Handler para arquivos estáticos
  */
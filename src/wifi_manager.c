@@ -4,14 +4,20 @@
  */
 
 #include "wifi_manager.h"
+#include "wifi_reconnect.h"
+#include "boot_trace.h"
 #include "esp_log.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
+#include "esp_netif.h"
 #include "nvs.h"
 #include "nvs_flash.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include <stdlib.h>
+#include <string.h>
 
 static const char *TAG = "WIFI_MANAGER";
 
@@ -20,6 +26,8 @@ static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
 #define WIFI_SCAN_DONE_BIT BIT2
+#define WIFI_SCAN_REQUEST_BIT BIT3
+#define WIFI_SCAN_UPDATED_BIT BIT4
 
 // Configurações atuais
 static wifi_ap_config_t s_ap_config = {0};
@@ -27,18 +35,116 @@ static wifi_sta_config_t s_sta_config = {0};
 static bool s_ap_started = false;
 static bool s_sta_connected = false;
 
+// Conexão rápida e endereçamento do STA
+static wifi_sta_last_ap_t s_last_ap = {0};
+static wifi_sta_ip_config_t s_sta_ip_config = {0};
+static bool s_fast_attempt = false;         // Tentativa atual usa o BSSID salvo
+static bool s_bssid_pinned = false;         // Configuração do driver fixa BSSID/canal
+static int64_t s_connect_start_us = 0;
+
 // Callbacks
 static wifi_connected_cb_t s_connected_cb = NULL;
 static wifi_disconnected_cb_t s_disconnected_cb = NULL;
 static wifi_scan_done_cb_t s_scan_done_cb = NULL;
 
-// Resultados do scan
-static wifi_scan_result_t s_scan_results[20];
-static uint16_t s_scan_count = 0;
+// Cache do scan: último resultado publicado pela task de scan
+static wifi_scan_store_t *s_scan_store = NULL;
+static bool s_scan_in_progress = false;
+static bool s_scan_pending = false;         // Pedido ainda não atendido pela task
+static wifi_scan_params_t s_scan_params = {0};  // Perfil do pedido pendente
+static wifi_scan_params_t s_scan_active = {0};  // Perfil do scan em andamento
+static wifi_scan_params_t s_scan_last = {0};    // Perfil do último scan encerrado
+static esp_err_t s_scan_last_err = ESP_OK;      // Resultado do último scan encerrado
+static TaskHandle_t s_scan_task = NULL;
+static portMUX_TYPE s_scan_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // NVS namespace
 #define NVS_NAMESPACE "wifi_config"
 
+/**
+ * @brief Configurar o driver do STA (com BSSID/canal salvos, se houver)
+ */
+static esp_err_t apply_sta_config(void)
+{
+    wifi_config_t wifi_config = {
+        .sta = {
+            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+            .pmf_cfg = {
+                .capable = true,
+                .required = false
+            },
+        },
+    };
+    
+    strcpy((char*)wifi_config.sta.ssid, (char*)s_sta_config.ssid);
+    strcpy((char*)wifi_config.sta.password, (char*)s_sta_config.password);
+    
+    bool pin = WIFI_FAST_CONNECT_ENABLED && s_last_ap.valid;
+    if (pin) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, s_last_ap.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = s_last_ap.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    }
+    
+    esp_err_t ret = esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao configurar STA: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    s_bssid_pinned = pin;
+    s_fast_attempt = pin;
+    return ESP_OK;
+}
+
+/**
+ * @brief Aplicar IP fixo ou DHCP na interface do STA
+ */
+static esp_err_t apply_sta_ip_config(void)
+{
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (!netif) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    if (!s_sta_ip_config.static_ip) {
+        // Com CONFIG_LWIP_DHCP_RESTORE_LAST_IP, o DHCP pede direto o último IP
+        esp_err_t ret = esp_netif_dhcpc_start(netif);
+        return ret == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED ? ESP_OK : ret;
+    }
+    
+    esp_err_t ret = esp_netif_dhcpc_stop(netif);
+    if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        return ret;
+    }
+    
+    ret = esp_netif_set_ip_info(netif, &s_sta_ip_config.ip_info);
+    if (ret == ESP_OK && s_sta_ip_config.dns.addr != 0) {
+        esp_netif_dns_info_t dns = {0};
+        dns.ip.u_addr.ip4 = s_sta_ip_config.dns;
+        dns.ip.type = ESP_IPADDR_TYPE_V4;
+        ret = esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+    }
+    return ret;
+}
+
+/**
+ * @brief Guardar BSSID/canal do AP conectado (NVS só quando mudam)
+ */
+static void remember_last_ap(const uint8_t *bssid, uint8_t channel)
+{
+    if (s_last_ap.valid && s_last_ap.channel == channel &&
+        memcmp(s_last_ap.bssid, bssid, sizeof(s_last_ap.bssid)) == 0) {
+        return;
+    }
+    
+    s_last_ap.valid = true;
+    memcpy(s_last_ap.bssid, bssid, sizeof(s_last_ap.bssid));
+    s_last_ap.channel = channel;
+    wifi_manager_save_config();
+}
+
 /**
  * @brief Handler de eventos Wi-Fi
  */
@@ -51,39 +157,69 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                 ESP_LOGI(TAG, "SoftAP iniciado");
                 s_ap_started = true;
                 break;
-                
+            
             case WIFI_EVENT_AP_STOP:
                 ESP_LOGI(TAG, "SoftAP parado");
                 s_ap_started = false;
                 break;
-                
+            
             case WIFI_EVENT_STA_START:
                 ESP_LOGI(TAG, "STA iniciado");
-                esp_wifi_connect();
+                // Reconectar à rede salva (com BSSID/canal, se conhecidos)
+                if (strlen((char*)s_sta_config.ssid) > 0 && wifi_manager_connect_sta() != ESP_OK) {
+                    ESP_LOGW(TAG, "Conexão à rede salva não iniciada");
+                }
                 break;
-                
+            
             case WIFI_EVENT_STA_CONNECTED:
-                ESP_LOGI(TAG, "STA conectado ao AP");
+                {
+                    wifi_event_sta_connected_t* event = (wifi_event_sta_connected_t*) event_data;
+                    ESP_LOGI(TAG, "STA conectado ao AP (canal %d) em %lld ms", event->channel,
+                             (long long)(esp_timer_get_time() - s_connect_start_us) / 1000);
+                    s_fast_attempt = false;
+                    remember_last_ap(event->bssid, event->channel);
+                }
                 break;
-                
+            
             case WIFI_EVENT_STA_DISCONNECTED:
-                ESP_LOGI(TAG, "STA desconectado");
-                s_sta_connected = false;
-                xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-                
-                if (s_disconnected_cb) {
-                    s_disconnected_cb();
+                {
+                    wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+                    ESP_LOGI(TAG, "STA desconectado (motivo %d)", event->reason);
+                    s_sta_connected = false;
+                    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+                    
+                    if (s_disconnected_cb) {
+                        s_disconnected_cb();
+                    }
+                    
+                    // Com BSSID fixo, a reconexão tenta o mesmo AP uma vez; se
+                    // falhar, o BSSID é liberado e a rede é buscada pelo SSID
+                    // (qualquer AP), inclusive após quedas com a conexão já feita
+                    bool fallback = false;
+                    if (s_bssid_pinned) {
+                        if (s_fast_attempt) {
+                            ESP_LOGW(TAG, "AP salvo não respondeu, buscando a rede pelo SSID");
+                            fallback = true;
+                            s_last_ap.valid = false;
+                            if (apply_sta_config() != ESP_OK) {
+                                ESP_LOGW(TAG, "BSSID salvo mantido na configuração do driver");
+                            }
+                        } else {
+                            s_fast_attempt = true;
+                        }
+                    }
+                    
+                    // Reconectar com backoff conforme o motivo (a busca pelo
+                    // SSID após a tentativa rápida sai sem esperar o backoff)
+                    wifi_reconnect_schedule(event->reason, fallback);
                 }
-                
-                // Tentar reconectar automaticamente
-                esp_wifi_connect();
                 break;
-                
+            
             case WIFI_EVENT_SCAN_DONE:
                 ESP_LOGI(TAG, "Scan de Wi-Fi concluído");
                 xEventGroupSetBits(s_wifi_event_group, WIFI_SCAN_DONE_BIT);
                 break;
-                
+            
             default:
                 break;
         }
@@ -92,16 +228,20 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
             case IP_EVENT_STA_GOT_IP:
                 {
                     ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-                    ESP_LOGI(TAG, "IP obtida:" IPSTR, IP2STR(&event->ip_info.ip));
+                    ESP_LOGI(TAG, "IP obtida:" IPSTR " (%lld ms desde o início da conexão)",
+                             IP2STR(&event->ip_info.ip),
+                             (long long)(esp_timer_get_time() - s_connect_start_us) / 1000);
                     s_sta_connected = true;
                     xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+                    wifi_reconnect_notify_connected();
+                    boot_trace_mark("event.sta_got_ip");
                     
                     if (s_connected_cb) {
                         s_connected_cb();
                     }
                 }
                 break;
-                
+            
             default:
                 break;
         }
@@ -109,42 +249,276 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
 }
 
 /**
- * @brief Task para processar resultados do scan
+ * @brief Montar a configuração do driver para um perfil de scan
+ */
+static void scan_build_config(const wifi_scan_params_t *params, wifi_scan_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->ssid = params->ssid[0] ? (uint8_t *)params->ssid : NULL;
+    config->channel = params->channel;
+    config->show_hidden = params->show_hidden;
+    
+    uint32_t dwell = params->dwell_ms > WIFI_SCAN_MAX_DWELL_MS ? WIFI_SCAN_MAX_DWELL_MS : params->dwell_ms;
+    switch (params->mode) {
+        case WIFI_SCAN_MODE_PASSIVE:
+            config->scan_type = WIFI_SCAN_TYPE_PASSIVE;
+            config->scan_time.passive = dwell ? dwell : WIFI_SCAN_PASSIVE_DWELL_MS;
+            break;
+        
+        case WIFI_SCAN_MODE_FAST:
+            // Sem mínimo: o canal é deixado assim que não houver respostas
+            config->scan_type = WIFI_SCAN_TYPE_ACTIVE;
+            config->scan_time.active.min = 0;
+            config->scan_time.active.max = dwell ? dwell : WIFI_SCAN_FAST_DWELL_MS;
+            break;
+        
+        case WIFI_SCAN_MODE_FULL:
+        default:
+            config->scan_type = WIFI_SCAN_TYPE_ACTIVE;
+            config->scan_time.active.min = dwell ? dwell : WIFI_SCAN_FULL_DWELL_MIN_MS;
+            config->scan_time.active.max = dwell ? dwell : WIFI_SCAN_FULL_DWELL_MAX_MS;
+            break;
+    }
+}
+
+/**
+ * @brief Comparar perfis de scan
+ */
+static bool scan_params_equal(const wifi_scan_params_t *a, const wifi_scan_params_t *b)
+{
+    return a->mode == b->mode && a->channel == b->channel && a->dwell_ms == b->dwell_ms &&
+           a->show_hidden == b->show_hidden && strcmp(a->ssid, b->ssid) == 0;
+}
+
+/**
+ * @brief Copiar um perfil de scan (NULL: scan completo)
+ */
+static void scan_params_copy(const wifi_scan_params_t *src, wifi_scan_params_t *dst)
+{
+    memset(dst, 0, sizeof(*dst));
+    if (src) {
+        dst->mode = src->mode;
+        dst->channel = src->channel;
+        dst->dwell_ms = src->dwell_ms;
+        dst->show_hidden = src->show_hidden;
+        strncpy(dst->ssid, src->ssid, sizeof(dst->ssid) - 1);
+    }
+}
+
+/**
+ * @brief Encerrar o scan em andamento sem resultado e acordar quem aguarda
+ */
+static void scan_fail(esp_err_t err)
+{
+    taskENTER_CRITICAL(&s_scan_lock);
+    s_scan_in_progress = false;
+    s_scan_last = s_scan_active;
+    s_scan_last_err = err;
+    taskEXIT_CRITICAL(&s_scan_lock);
+    xEventGroupSetBits(s_wifi_event_group, WIFI_SCAN_UPDATED_BIT);
+}
+
+/**
+ * @brief Iniciar scan sem bloquear (conclusão via WIFI_EVENT_SCAN_DONE)
+ */
+static void scan_start(void)
+{
+    // s_scan_active só é alterado aqui e lido na conclusão (mesma task)
+    taskENTER_CRITICAL(&s_scan_lock);
+    s_scan_active = s_scan_params;
+    memset(&s_scan_params, 0, sizeof(s_scan_params));
+    s_scan_pending = false;
+    taskEXIT_CRITICAL(&s_scan_lock);
+    
+    wifi_scan_config_t scan_config;
+    scan_build_config(&s_scan_active, &scan_config);
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Erro ao iniciar scan: %s", esp_err_to_name(ret));
+        // Quem aguarda este perfil recebe o erro; o cache não muda
+        scan_fail(ret);
+    } else {
+        taskENTER_CRITICAL(&s_scan_lock);
+        s_scan_in_progress = true;
+        taskEXIT_CRITICAL(&s_scan_lock);
+        
+        ESP_LOGD(TAG, "Scan %s iniciado (canal %d) em %lld us",
+                 wifi_manager_scan_mode_name(s_scan_active.mode), s_scan_active.channel,
+                 (long long)(esp_timer_get_time() - start_us));
+    }
+}
+
+/**
+ * @brief Ordenar registros do driver por SSID e, em cada SSID, por RSSI
+ */
+static int compare_ap_records(const void *a, const void *b)
+{
+    const wifi_ap_record_t *ra = a;
+    const wifi_ap_record_t *rb = b;
+    int cmp = strcmp((const char *)ra->ssid, (const char *)rb->ssid);
+    return cmp ? cmp : rb->rssi - ra->rssi;
+}
+
+/**
+ * @brief Ordenar redes por RSSI (melhor primeiro)
+ */
+static int compare_networks(const void *a, const void *b)
+{
+    return ((const wifi_scan_result_t *)b)->rssi - ((const wifi_scan_result_t *)a)->rssi;
+}
+
+/**
+ * @brief Montar o resultado a partir dos registros do driver
+ * 
+ * APs com o mesmo SSID viram uma rede (SSIDs vazios não são agrupados).
+ * Redes e APs ficam em um único bloco alocado, liberado com free().
+ */
+static wifi_scan_store_t* scan_store_build(wifi_ap_record_t *records, uint16_t count)
+{
+    if (count > 1) {
+        qsort(records, count, sizeof(wifi_ap_record_t), compare_ap_records);
+    }
+    
+    uint16_t network_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || records[i].ssid[0] == '\0' ||
+            strcmp((const char *)records[i].ssid, (const char *)records[i - 1].ssid) != 0) {
+            network_count++;
+        }
+    }
+    
+    wifi_scan_store_t *store = calloc(1, sizeof(wifi_scan_store_t) +
+                                      network_count * sizeof(wifi_scan_result_t) +
+                                      count * sizeof(wifi_scan_ap_t));
+    if (!store) {
+        return NULL;
+    }
+    store->networks = (wifi_scan_result_t *)(store + 1);
+    store->aps = (wifi_scan_ap_t *)(store->networks + network_count);
+    store->ap_count = count;
+    store->timestamp_us = esp_timer_get_time();
+    store->params = s_scan_active;
+    store->refs = 1;
+    
+    wifi_scan_result_t *network = NULL;
+    for (int i = 0; i < count; i++) {
+        wifi_scan_ap_t *ap = &store->aps[i];
+        memcpy(ap->bssid, records[i].bssid, sizeof(ap->bssid));
+        ap->rssi = records[i].rssi;
+        ap->channel = records[i].primary;
+        
+        // Primeiro registro de um SSID: o de melhor sinal
+        if (!network || records[i].ssid[0] == '\0' ||
+            strcmp((const char *)records[i].ssid, network->ssid) != 0) {
+            network = &store->networks[store->network_count++];
+            strncpy(network->ssid, (const char *)records[i].ssid, sizeof(network->ssid) - 1);
+            network->rssi = ap->rssi;
+            network->auth_mode = records[i].authmode;
+            network->channel = ap->channel;
+            memcpy(network->bssid, ap->bssid, sizeof(network->bssid));
+            network->first_ap = i;
+        }
+        network->ap_count++;
+    }
+    
+    if (store->network_count > 1) {
+        qsort(store->networks, store->network_count, sizeof(wifi_scan_result_t), compare_networks);
+    }
+    return store;
+}
+
+/**
+ * @brief Ler os resultados do driver e publicar no cache
+ */
+static void scan_collect(void)
+{
+    uint16_t ap_count = 0;
+    esp_wifi_scan_get_ap_num(&ap_count);
+    
+    wifi_ap_record_t *ap_records = NULL;
+    if (ap_count > 0) {
+        ap_records = malloc(ap_count * sizeof(wifi_ap_record_t));
+        if (!ap_records) {
+            ESP_LOGE(TAG, "Memória insuficiente para resultados do scan");
+            ap_count = 0;
+        }
+    }
+    
+    // Sempre chamado: libera a lista mantida pelo driver
+    if (esp_wifi_scan_get_ap_records(&ap_count, ap_records) != ESP_OK) {
+        ap_count = 0;
+    }
+    
+    wifi_scan_store_t *store = scan_store_build(ap_records, ap_count);
+    free(ap_records);
+    
+    if (store && s_scan_done_cb) {
+        s_scan_done_cb(store->networks, store->network_count);
+    }
+    
+    // Substituir o resultado publicado; leitores do anterior o liberam
+    taskENTER_CRITICAL(&s_scan_lock);
+    wifi_scan_store_t *old = store ? s_scan_store : NULL;
+    if (store) {
+        s_scan_store = store;
+    }
+    s_scan_in_progress = false;
+    s_scan_last = s_scan_active;
+    s_scan_last_err = store ? ESP_OK : ESP_ERR_NO_MEM;
+    taskEXIT_CRITICAL(&s_scan_lock);
+    wifi_manager_scan_release(old);
+    
+    if (store) {
+        ESP_LOGI(TAG, "Scan %s concluído: %d redes, %d APs",
+                 wifi_manager_scan_mode_name(store->params.mode), store->network_count, store->ap_count);
+    } else {
+        ESP_LOGE(TAG, "Memória insuficiente para o resultado do scan");
+    }
+    xEventGroupSetBits(s_wifi_event_group, WIFI_SCAN_UPDATED_BIT);
+}
+
+/**
+ * @brief Task do serviço de scan
+ * 
+ * Única dona do rádio para scans: atende pedidos (WIFI_SCAN_REQUEST_BIT),
+ * o agendamento WIFI_SCAN_PERIOD_MS e a conclusão do driver, de modo que
+ * quem consulta o cache nunca espera pelo rádio.
  */
 static void scan_task(void *pvParameters)
 {
     while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (s_scan_in_progress) {
+            wait = pdMS_TO_TICKS(WIFI_SCAN_TIMEOUT_MS);
+        } else if (WIFI_SCAN_PERIOD_MS > 0) {
+            wait = pdMS_TO_TICKS(WIFI_SCAN_PERIOD_MS);
+        }
+        
         EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-                                             WIFI_SCAN_DONE_BIT,
+                                             WIFI_SCAN_DONE_BIT | WIFI_SCAN_REQUEST_BIT,
                                              pdTRUE,
                                              pdFALSE,
-                                             portMAX_DELAY);
+                                             wait);
+        bool timeout = !(bits & (WIFI_SCAN_DONE_BIT | WIFI_SCAN_REQUEST_BIT));
         
         if (bits & WIFI_SCAN_DONE_BIT) {
-            uint16_t ap_count = 0;
-            esp_wifi_scan_get_ap_num(&ap_count);
-            
-            if (ap_count > 0) {
-                wifi_ap_record_t *ap_records = malloc(ap_count * sizeof(wifi_ap_record_t));
-                if (ap_records) {
-                    esp_wifi_scan_get_ap_records(&ap_count, ap_records);
-                    
-                    s_scan_count = (ap_count > 20) ? 20 : ap_count;
-                    
-                    for (int i = 0; i < s_scan_count; i++) {
-                        strncpy(s_scan_results[i].ssid, (char*)ap_records[i].ssid, 32);
-                        s_scan_results[i].rssi = ap_records[i].rssi;
-                        s_scan_results[i].auth_mode = ap_records[i].authmode;
-                        s_scan_results[i].channel = ap_records[i].primary;
-                    }
-                    
-                    free(ap_records);
-                    
-                    if (s_scan_done_cb) {
-                        s_scan_done_cb(s_scan_results, s_scan_count);
-                    }
-                }
-            }
+            scan_collect();
+        } else if (timeout && s_scan_in_progress) {
+            ESP_LOGE(TAG, "Timeout no scan de Wi-Fi");
+            esp_wifi_scan_stop();
+            scan_fail(ESP_ERR_TIMEOUT);
+            continue;
+        }
+        
+        // Pedidos com o mesmo perfil do scan em andamento são atendidos por
+        // ele; os demais ficam pendentes e rodam em seguida
+        taskENTER_CRITICAL(&s_scan_lock);
+        bool pending = s_scan_pending;
+        taskEXIT_CRITICAL(&s_scan_lock);
+        if (!s_scan_in_progress && ((bits & WIFI_SCAN_REQUEST_BIT) || timeout || pending)) {
+            scan_start();
         }
     }
 }
@@ -165,16 +539,22 @@ esp_err_t wifi_manager_init(void)
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
     
     // Inicializar Wi-Fi
+    int trace = boot_trace_begin("wifi.esp_wifi_init");
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
+    boot_trace_end(trace);
     
     // Carregar configurações salvas
+    trace = boot_trace_begin("wifi.load_config");
     wifi_manager_load_config();
+    boot_trace_end(trace);
+    
+    ESP_ERROR_CHECK(wifi_reconnect_init());
     
-    // Criar task de scan
-    xTaskCreate(scan_task, "scan_task", 4096, NULL, 5, NULL);
+    // Criar task do serviço de scan
+    xTaskCreate(scan_task, "scan_task", 4096, NULL, 5, &s_scan_task);
     
     ESP_LOGI(TAG, "Gerenciador de Wi-Fi inicializado");
     return ESP_OK;
@@ -198,6 +578,11 @@ esp_err_t wifi_manager_set_sta_config(const wifi_sta_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
+    // Outra rede: o BSSID salvo não vale mais
+    if (strncmp((char*)s_sta_config.ssid, (char*)config->ssid, sizeof(s_sta_config.ssid)) != 0) {
+        s_last_ap.valid = false;
+    }
+    
     memcpy(&s_sta_config, config, sizeof(wifi_sta_config_t));
     ESP_LOGI(TAG, "Configuração STA atualizada: %s", s_sta_config.ssid);
     
@@ -234,77 +619,239 @@ esp_err_t wifi_manager_connect_sta(void)
         return ESP_ERR_INVALID_STATE;
     }
     
-    wifi_config_t wifi_config = {
-        .sta = {
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-            .pmf_cfg = {
-                .capable = true,
-                .required = false
-            },
-        },
-    };
+    // Conexão manual: descarta backoff e desistência anteriores
+    wifi_reconnect_reset();
     
-    strcpy((char*)wifi_config.sta.ssid, (char*)s_sta_config.ssid);
-    strcpy((char*)wifi_config.sta.password, (char*)s_sta_config.password);
+    s_connect_start_us = esp_timer_get_time();
+    esp_err_t ret = apply_sta_config();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = apply_sta_ip_config();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Erro ao configurar IP do STA: %s", esp_err_to_name(ret));
+    }
+    
+    // Chamado também do loop de eventos e de handlers HTTP: com uma
+    // reconexão em andamento o driver pode recusar (ESP_ERR_WIFI_CONN)
+    ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao conectar STA: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    if (s_fast_attempt) {
+        ESP_LOGI(TAG, "Conectando STA a: %s (BSSID salvo, canal %d)", s_sta_config.ssid, s_last_ap.channel);
+    } else {
+        ESP_LOGI(TAG, "Conectando STA a: %s", s_sta_config.ssid);
+    }
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_set_sta_ip_config(const wifi_sta_ip_config_t *config)
+{
+    if (config && config->static_ip && config->ip_info.ip.addr == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (config) {
+        memcpy(&s_sta_ip_config, config, sizeof(wifi_sta_ip_config_t));
+    } else {
+        memset(&s_sta_ip_config, 0, sizeof(wifi_sta_ip_config_t));
+    }
+    
+    ESP_LOGI(TAG, "Endereçamento STA: %s", s_sta_ip_config.static_ip ? "IP fixo" : "DHCP");
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_get_sta_ip_config(wifi_sta_ip_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_connect());
+    memcpy(config, &s_sta_ip_config, sizeof(wifi_sta_ip_config_t));
+    return ESP_OK;
+}
+
+esp_err_t wifi_manager_get_last_ap(wifi_sta_last_ap_t *last_ap)
+{
+    if (!last_ap) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    ESP_LOGI(TAG, "Conectando STA a: %s", s_sta_config.ssid);
+    memcpy(last_ap, &s_last_ap, sizeof(wifi_sta_last_ap_t));
     return ESP_OK;
 }
 
 esp_err_t wifi_manager_disconnect_sta(void)
 {
-    ESP_ERROR_CHECK(esp_wifi_disconnect());
+    wifi_reconnect_reset();
+    esp_err_t ret = esp_wifi_disconnect();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao desconectar STA: %s", esp_err_to_name(ret));
+        return ret;
+    }
     s_sta_connected = false;
     ESP_LOGI(TAG, "STA desconectado");
     return ESP_OK;
 }
 
 esp_err_t wifi_manager_scan(wifi_scan_result_t *results, uint16_t max_results, uint16_t *count)
+{
+    return wifi_manager_scan_with_params(NULL, results, max_results, count);
+}
+
+esp_err_t wifi_manager_scan_with_params(const wifi_scan_params_t *params,
+                                        wifi_scan_result_t *results, uint16_t max_results,
+                                        uint16_t *count)
 {
     if (!results || !count) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = false,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time = {
-            .active = {
-                .min = 100,
-                .max = 300
-            }
+    wifi_scan_params_t requested;
+    scan_params_copy(params, &requested);
+    
+    // Um scan de outro perfil em andamento termina antes do pedido
+    int64_t deadline_us = esp_timer_get_time() + 2 * WIFI_SCAN_TIMEOUT_MS * 1000LL;
+    while (true) {
+        xEventGroupClearBits(s_wifi_event_group, WIFI_SCAN_UPDATED_BIT);
+        esp_err_t ret = wifi_manager_scan_request(&requested);
+        if (ret != ESP_OK) {
+            return ret;
         }
-    };
+        
+        // Aguardar a task de scan encerrar um scan
+        int64_t left_us = deadline_us - esp_timer_get_time();
+        EventBits_t bits = 0;
+        if (left_us > 0) {
+            bits = xEventGroupWaitBits(s_wifi_event_group,
+                                       WIFI_SCAN_UPDATED_BIT,
+                                       pdFALSE,
+                                       pdFALSE,
+                                       pdMS_TO_TICKS(left_us / 1000) + 1);
+        }
+        
+        if (!(bits & WIFI_SCAN_UPDATED_BIT)) {
+            ESP_LOGE(TAG, "Timeout no scan de Wi-Fi");
+            return ESP_ERR_TIMEOUT;
+        }
+        
+        // O bit vale para qualquer scan: só interessa o do perfil pedido
+        taskENTER_CRITICAL(&s_scan_lock);
+        bool done = scan_params_equal(&s_scan_last, &requested);
+        ret = s_scan_last_err;
+        taskEXIT_CRITICAL(&s_scan_lock);
+        if (!done) {
+            continue;
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        
+        // Outro scan pode ter substituído o resultado antes da leitura
+        const wifi_scan_store_t *store = wifi_manager_scan_acquire();
+        bool match = store && scan_params_equal(&store->params, &requested);
+        if (match) {
+            *count = store->network_count > max_results ? max_results : store->network_count;
+            memcpy(results, store->networks, *count * sizeof(wifi_scan_result_t));
+        }
+        wifi_manager_scan_release(store);
+        if (match) {
+            return ESP_OK;
+        }
+    }
+}
+
+esp_err_t wifi_manager_scan_request(const wifi_scan_params_t *params)
+{
+    if (!s_scan_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Erro ao iniciar scan: %s", esp_err_to_name(ret));
-        return ret;
+    wifi_scan_params_t requested;
+    scan_params_copy(params, &requested);
+    
+    taskENTER_CRITICAL(&s_scan_lock);
+    if (!s_scan_in_progress ||
+        !scan_params_equal(&requested, &s_scan_active)) {
+        // Perfil diferente do scan em andamento: novo scan ao concluir
+        s_scan_params = requested;
+        s_scan_pending = true;
     }
+    taskEXIT_CRITICAL(&s_scan_lock);
     
-    // Aguardar conclusão do scan
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-                                         WIFI_SCAN_DONE_BIT,
-                                         pdTRUE,
-                                         pdFALSE,
-                                         pdMS_TO_TICKS(10000));
+    xEventGroupSetBits(s_wifi_event_group, WIFI_SCAN_REQUEST_BIT);
+    return ESP_OK;
+}
+
+const char* wifi_manager_scan_mode_name(wifi_scan_mode_t mode)
+{
+    switch (mode) {
+        case WIFI_SCAN_MODE_FAST:
+            return "fast";
+        case WIFI_SCAN_MODE_PASSIVE:
+            return "passive";
+        case WIFI_SCAN_MODE_FULL:
+        default:
+            return "full";
+    }
+}
+
+const wifi_scan_store_t* wifi_manager_scan_acquire(void)
+{
+    taskENTER_CRITICAL(&s_scan_lock);
+    wifi_scan_store_t *store = s_scan_store;
+    if (store) {
+        store->refs++;
+    }
+    taskEXIT_CRITICAL(&s_scan_lock);
+    return store;
+}
+
+void wifi_manager_scan_release(const wifi_scan_store_t *store)
+{
+    if (!store) {
+        return;
+    }
+    
+    wifi_scan_store_t *owned = (wifi_scan_store_t *)store;
+    taskENTER_CRITICAL(&s_scan_lock);
+    bool last = --owned->refs == 0;
+    taskEXIT_CRITICAL(&s_scan_lock);
     
-    if (!(bits & WIFI_SCAN_DONE_BIT)) {
-        ESP_LOGE(TAG, "Timeout no scan de Wi-Fi");
-        return ESP_ERR_TIMEOUT;
+    if (last) {
+        free(owned);
     }
+}
+
+esp_err_t wifi_manager_get_scan_cache(wifi_scan_result_t *results, uint16_t max_results,
+                                      wifi_scan_cache_info_t *info)
+{
+    if (!info || (!results && max_results > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const wifi_scan_store_t *store = wifi_manager_scan_acquire();
     
-    // Copiar resultados
-    *count = (s_scan_count > max_results) ? max_results : s_scan_count;
-    memcpy(results, s_scan_results, *count * sizeof(wifi_scan_result_t));
+    info->count = 0;
+    info->age_ms = -1;
+    if (store) {
+        info->count = results ? (store->network_count > max_results ? max_results : store->network_count) :
+                      store->network_count;
+        if (results && info->count > 0) {
+            memcpy(results, store->networks, info->count * sizeof(wifi_scan_result_t));
+        }
+        info->age_ms = (esp_timer_get_time() - store->timestamp_us) / 1000;
+    }
     
-    ESP_LOGI(TAG, "Scan concluído: %d redes encontradas", *count);
+    taskENTER_CRITICAL(&s_scan_lock);
+    info->scanning = s_scan_in_progress || s_scan_pending;
+    taskEXIT_CRITICAL(&s_scan_lock);
+    
+    wifi_manager_scan_release(store);
     return ESP_OK;
 }
 
@@ -408,6 +955,12 @@ esp_err_t wifi_manager_save_config(void)
         // Salvar configuração STA
         ret = nvs_set_blob(nvs_handle, "sta_config", &s_sta_config, sizeof(wifi_sta_config_t));
     }
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, "sta_ip", &s_sta_ip_config, sizeof(wifi_sta_ip_config_t));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, "sta_last_ap", &s_last_ap, sizeof(wifi_sta_last_ap_t));
+    }
     
     if (ret == ESP_OK) {
         ret = nvs_commit(nvs_handle);
@@ -437,6 +990,18 @@ esp_err_t wifi_manager_load_config(void)
         ret = nvs_get_blob(nvs_handle, "sta_config", &s_sta_config, &required_size);
     }
     
+    // Opcionais (ausentes em configurações salvas por versões anteriores)
+    if (ret == ESP_OK) {
+        required_size = sizeof(wifi_sta_ip_config_t);
+        if (nvs_get_blob(nvs_handle, "sta_ip", &s_sta_ip_config, &required_size) != ESP_OK) {
+            memset(&s_sta_ip_config, 0, sizeof(wifi_sta_ip_config_t));
+        }
+        required_size = sizeof(wifi_sta_last_ap_t);
+        if (nvs_get_blob(nvs_handle, "sta_last_ap", &s_last_ap, &required_size) != ESP_OK) {
+            memset(&s_last_ap, 0, sizeof(wifi_sta_last_ap_t));
+        }
+    }
+    
     nvs_close(nvs_handle);
     
     if (ret == ESP_OK) {
@@ -19,14 +19,90 @@ extern "C" {
 // Usar as estruturas padrão do ESP-IDF
 // wifi_ap_config_t e wifi_sta_config_t já estão definidas em esp_wifi_types.h
 
-// Estrutura para informações de rede
+// Serviço de scan em segundo plano: resultados mantidos em cache
+#define WIFI_SCAN_TIMEOUT_MS  10000
+
+// Intervalo entre scans automáticos (0 = apenas sob demanda). Cada scan
+// percorre todos os canais e interrompe brevemente o tráfego do SoftAP.
+#define WIFI_SCAN_PERIOD_MS 0
+
+// Tempo de permanência por canal (ms) de cada perfil de scan
+#define WIFI_SCAN_FULL_DWELL_MIN_MS 100
+#define WIFI_SCAN_FULL_DWELL_MAX_MS 300
+#define WIFI_SCAN_FAST_DWELL_MS     30
+#define WIFI_SCAN_PASSIVE_DWELL_MS  360
+#define WIFI_SCAN_MAX_DWELL_MS      1500
+
+// Perfis de scan
+typedef enum {
+    WIFI_SCAN_MODE_FULL = 0,    // Ativo, todos os canais (padrão)
+    WIFI_SCAN_MODE_FAST,        // Ativo, dwell curto; use com canal/SSID conhecidos
+    WIFI_SCAN_MODE_PASSIVE,     // Só escuta beacons, sem probe requests
+} wifi_scan_mode_t;
+
+// Parâmetros de um scan (zerado = scan completo padrão)
 typedef struct {
-    char ssid[32];
+    wifi_scan_mode_t mode;
+    uint8_t channel;            // 0: todos os canais
+    char ssid[33];              // "": todas as redes
+    uint16_t dwell_ms;          // 0: padrão do perfil
+    bool show_hidden;
+} wifi_scan_params_t;
+
+// Conexão rápida: reconectar direto ao último BSSID/canal salvos, sem
+// varrer todos os canais (volta à conexão normal se o AP não responder)
+#define WIFI_FAST_CONNECT_ENABLED 1
+
+// Último AP ao qual o STA se conectou (salvo em NVS)
+typedef struct {
+    bool valid;
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_sta_last_ap_t;
+
+// Endereçamento IP do STA (salvo em NVS)
+typedef struct {
+    bool static_ip;             // false: DHCP (com reuso do último lease)
+    esp_netif_ip_info_t ip_info;    // IP, máscara e gateway fixos
+    esp_ip4_addr_t dns;         // DNS fixo (0: não alterar)
+} wifi_sta_ip_config_t;
+
+// Ponto de acesso (BSSID) encontrado no scan
+typedef struct {
+    uint8_t bssid[6];
     int8_t rssi;
-    wifi_auth_mode_t auth_mode;
     uint8_t channel;
+} wifi_scan_ap_t;
+
+// Estrutura para informações de rede (APs com o mesmo SSID agrupados)
+typedef struct {
+    char ssid[33];
+    int8_t rssi;                // Melhor RSSI entre os APs da rede
+    wifi_auth_mode_t auth_mode; // Do AP com melhor sinal
+    uint8_t channel;            // Do AP com melhor sinal
+    uint8_t bssid[6];           // AP com melhor sinal
+    uint16_t first_ap;          // Índice em wifi_scan_store_t.aps
+    uint16_t ap_count;          // APs (BSSIDs) desta rede
 } wifi_scan_result_t;
 
+// Resultado completo de um scan (imutável, com contagem de referências)
+typedef struct {
+    wifi_scan_result_t *networks;   // Ordenadas por RSSI, do melhor ao pior
+    uint16_t network_count;
+    wifi_scan_ap_t *aps;            // Agrupados por rede, ordenados por RSSI
+    uint16_t ap_count;
+    int64_t timestamp_us;           // esp_timer_get_time() na conclusão
+    wifi_scan_params_t params;      // Perfil usado (canal/SSID: resultado parcial)
+    uint32_t refs;                  // Uso interno
+} wifi_scan_store_t;
+
+// Estado do cache de scan
+typedef struct {
+    uint16_t count;             // Redes copiadas (ou no cache, sem array)
+    int64_t age_ms;             // Idade do último scan concluído (-1 = nenhum)
+    bool scanning;              // Scan em andamento
+} wifi_scan_cache_info_t;
+
 // Callbacks
 typedef void (*wifi_connected_cb_t)(void);
 typedef void (*wifi_disconnected_cb_t)(void);
@@ -65,10 +141,40 @@ esp_err_t wifi_manager_start_ap(void);
 /**
  * @brief Conectar STA
  * 
+ * Com WIFI_FAST_CONNECT_ENABLED e um AP salvo, conecta direto ao último
+ * BSSID/canal; se essa tentativa falhar, repete com a busca normal.
+ * Também aplica o endereçamento de wifi_manager_set_sta_ip_config().
+ * 
  * @return esp_err_t 
  */
 esp_err_t wifi_manager_connect_sta(void);
 
+/**
+ * @brief Definir endereçamento IP do STA (DHCP ou IP fixo)
+ * 
+ * Aplicado na próxima conexão; persistido por wifi_manager_save_config().
+ * 
+ * @param config Configuração (NULL volta ao DHCP)
+ * @return esp_err_t 
+ */
+esp_err_t wifi_manager_set_sta_ip_config(const wifi_sta_ip_config_t *config);
+
+/**
+ * @brief Obter endereçamento IP configurado para o STA
+ * 
+ * @param config Configuração atual
+ * @return esp_err_t 
+ */
+esp_err_t wifi_manager_get_sta_ip_config(wifi_sta_ip_config_t *config);
+
+/**
+ * @brief Obter o último AP (BSSID/canal) usado pela conexão rápida
+ * 
+ * @param last_ap Último AP (valid false se nenhum salvo)
+ * @return esp_err_t 
+ */
+esp_err_t wifi_manager_get_last_ap(wifi_sta_last_ap_t *last_ap);
+
 /**
  * @brief Desconectar STA
  * 
@@ -77,7 +183,11 @@ esp_err_t wifi_manager_connect_sta(void);
 esp_err_t wifi_manager_disconnect_sta(void);
 
 /**
- * @brief Escanear redes disponíveis
+ * @brief Escanear redes disponíveis (bloqueante, scan completo)
+ * 
+ * Solicita um scan ao serviço e aguarda a conclusão (ver
+ * wifi_manager_scan_with_params()). Não usar em handlers HTTP: prefira
+ * wifi_manager_scan_request() e wifi_manager_get_scan_cache().
  * 
  * @param results Array para armazenar resultados
  * @param max_results Tamanho máximo do array
@@ -86,6 +196,71 @@ esp_err_t wifi_manager_disconnect_sta(void);
  */
 esp_err_t wifi_manager_scan(wifi_scan_result_t *results, uint16_t max_results, uint16_t *count);
 
+/**
+ * @brief Escanear com um perfil específico (bloqueante)
+ * 
+ * Ex.: para reconectar, WIFI_SCAN_MODE_FAST com o canal e o SSID salvos
+ * conclui em algumas dezenas de milissegundos. Só retorna o resultado de um
+ * scan com este perfil: um scan de outro perfil em andamento é aguardado
+ * (até 2 * WIFI_SCAN_TIMEOUT_MS no total) e não é devolvido.
+ * 
+ * @param params Perfil do scan (NULL: scan completo)
+ * @param results Array para armazenar resultados
+ * @param max_results Tamanho máximo do array
+ * @param count Ponteiro para número de resultados encontrados
+ * @return esp_err_t ESP_ERR_TIMEOUT sem resultado no prazo; o erro do
+ *         driver se o scan não pôde ser iniciado
+ */
+esp_err_t wifi_manager_scan_with_params(const wifi_scan_params_t *params,
+                                        wifi_scan_result_t *results, uint16_t max_results,
+                                        uint16_t *count);
+
+/**
+ * @brief Solicitar scan em segundo plano (não bloqueia)
+ * 
+ * Com um scan do mesmo perfil em andamento, o pedido é atendido por ele;
+ * com perfil diferente, fica pendente e roda logo após a conclusão. A
+ * conclusão atualiza o cache e chama o callback de scan. Pedidos ainda não
+ * iniciados são substituídos pelo mais recente.
+ * 
+ * @param params Perfil do scan (NULL: scan completo)
+ * @return esp_err_t ESP_ERR_INVALID_STATE se o serviço não foi iniciado
+ */
+esp_err_t wifi_manager_scan_request(const wifi_scan_params_t *params);
+
+/**
+ * @brief Nome do perfil de scan ("full", "fast" ou "passive")
+ */
+const char* wifi_manager_scan_mode_name(wifi_scan_mode_t mode);
+
+/**
+ * @brief Obter o resultado completo do último scan (não bloqueia)
+ * 
+ * O resultado permanece válido até wifi_manager_scan_release(), mesmo que
+ * um novo scan seja concluído nesse intervalo.
+ * 
+ * @return const wifi_scan_store_t* NULL se nenhum scan foi concluído
+ */
+const wifi_scan_store_t* wifi_manager_scan_acquire(void);
+
+/**
+ * @brief Liberar resultado obtido com wifi_manager_scan_acquire()
+ * 
+ * @param store Resultado (NULL é ignorado)
+ */
+void wifi_manager_scan_release(const wifi_scan_store_t *store);
+
+/**
+ * @brief Copiar as melhores redes do último scan (não bloqueia)
+ * 
+ * @param results Array para os resultados (pode ser NULL com max_results 0)
+ * @param max_results Tamanho do array
+ * @param info Estado do cache (quantidade copiada, idade, scan em andamento)
+ * @return esp_err_t 
+ */
+esp_err_t wifi_manager_get_scan_cache(wifi_scan_result_t *results, uint16_t max_results,
+                                      wifi_scan_cache_info_t *info);
+
 /**
  * @brief Obter status da conexão
  * 
@@ -140,6 +315,9 @@ esp_err_t wifi_manager_clear_saved_config(void);
 /**
  * @brief Salvar configuração atual
  * 
+ * Inclui AP, STA, endereçamento IP do STA e o último AP conectado (este
+ * também é salvo automaticamente quando muda).
+ * 
  * @return esp_err_t 
  */
 esp_err_t wifi_manager_save_config(void);
@@ -0,0 +1,208 @@
+/**
+ * @file wifi_reconnect.c
+ * @brief Agendador de reconexão do STA com backoff exponencial
+ */
+
+#include "wifi_reconnect.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+static const char *TAG = "WIFI_RECONNECT";
+
+static wifi_reconnect_state_t s_state = {0};
+static esp_timer_handle_t s_timer = NULL;
+static int64_t s_next_attempt_us = 0;       // 0 = nenhuma agendada
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+wifi_reconnect_policy_t wifi_reconnect_classify(uint8_t reason)
+{
+    switch (reason) {
+        case WIFI_REASON_ASSOC_LEAVE:
+            return WIFI_RECONNECT_POLICY_NONE;
+        
+        // Timeouts de handshake (4-way incluído) vêm de enlace fraco tanto
+        // quanto de senha errada: seguem o backoff comum
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_802_1X_AUTH_FAILED:
+            return WIFI_RECONNECT_POLICY_AUTH;
+        
+        case WIFI_REASON_NO_AP_FOUND:
+        case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
+        case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
+        case WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD:
+            return WIFI_RECONNECT_POLICY_AP_MISSING;
+        
+        default:
+            return WIFI_RECONNECT_POLICY_RETRY;
+    }
+}
+
+const char* wifi_reconnect_policy_name(wifi_reconnect_policy_t policy)
+{
+    switch (policy) {
+        case WIFI_RECONNECT_POLICY_AP_MISSING:
+            return "ap_missing";
+        case WIFI_RECONNECT_POLICY_AUTH:
+            return "auth";
+        case WIFI_RECONNECT_POLICY_NONE:
+            return "none";
+        case WIFI_RECONNECT_POLICY_RETRY:
+        default:
+            return "retry";
+    }
+}
+
+uint32_t wifi_reconnect_next_delay(wifi_reconnect_state_t *state, uint8_t reason,
+                                   bool fallback, uint32_t random)
+{
+    wifi_reconnect_policy_t policy = wifi_reconnect_classify(reason);
+    
+    state->disconnects++;
+    state->last_reason = reason;
+    
+    if (policy == WIFI_RECONNECT_POLICY_AUTH) {
+        state->auth_failures++;
+        if (state->auth_failures >= WIFI_RECONNECT_AUTH_MAX_FAILURES) {
+            state->gave_up = true;
+        }
+    } else {
+        state->auth_failures = 0;
+    }
+    
+    if (policy == WIFI_RECONNECT_POLICY_NONE) {
+        state->last_delay_ms = 0;
+        return WIFI_RECONNECT_NEVER;
+    }
+    
+    // O AP salvo não respondeu (em geral NO_AP_FOUND), mas a rede pode
+    // estar em outro AP: a busca pelo SSID sai logo, fora do backoff
+    if (fallback && !state->gave_up) {
+        state->last_delay_ms = WIFI_RECONNECT_BASE_MS;
+        return WIFI_RECONNECT_BASE_MS;
+    }
+    
+    // base * 2^n, limitado (o deslocamento também, para não estourar).
+    // Após desistir, o intervalo fica no limite: um dispositivo sem
+    // supervisão volta sozinho quando a senha ou o AP forem corrigidos
+    uint32_t delay = policy == WIFI_RECONNECT_POLICY_AP_MISSING ?
+                     WIFI_RECONNECT_AP_MISSING_MS : WIFI_RECONNECT_BASE_MS;
+    for (uint32_t i = 0; i < state->consecutive && delay < WIFI_RECONNECT_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > WIFI_RECONNECT_MAX_MS || state->gave_up) {
+        delay = WIFI_RECONNECT_MAX_MS;
+    }
+    
+    // Jitter: entre metade e o valor cheio, para dispositivos não
+    // reconectarem todos juntos quando o AP volta
+    delay = delay / 2 + random % (delay / 2 + 1);
+    
+    state->consecutive++;
+    state->last_delay_ms = delay;
+    return delay;
+}
+
+/**
+ * @brief Disparo do timer: nova tentativa de conexão
+ */
+static void reconnect_timer_cb(void *arg)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_next_attempt_us = 0;
+    s_state.attempts++;
+    taskEXIT_CRITICAL(&s_lock);
+    
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Erro ao reconectar: %s", esp_err_to_name(ret));
+    }
+}
+
+esp_err_t wifi_reconnect_init(void)
+{
+    if (s_timer) {
+        return ESP_OK;
+    }
+    
+    const esp_timer_create_args_t timer_args = {
+        .callback = reconnect_timer_cb,
+        .name = "wifi_reconnect"
+    };
+    return esp_timer_create(&timer_args, &s_timer);
+}
+
+void wifi_reconnect_schedule(uint8_t reason, bool fallback)
+{
+    if (!s_timer) {
+        return;
+    }
+    
+    esp_timer_stop(s_timer);
+    
+    taskENTER_CRITICAL(&s_lock);
+    bool gave_up = s_state.gave_up;
+    uint32_t delay = wifi_reconnect_next_delay(&s_state, reason, fallback, esp_random());
+    s_next_attempt_us = delay == WIFI_RECONNECT_NEVER ? 0 : esp_timer_get_time() + delay * 1000LL;
+    uint32_t consecutive = s_state.consecutive;
+    bool gave_up_now = s_state.gave_up && !gave_up;
+    taskEXIT_CRITICAL(&s_lock);
+    
+    wifi_reconnect_policy_t policy = wifi_reconnect_classify(reason);
+    if (delay == WIFI_RECONNECT_NEVER) {
+        ESP_LOGI(TAG, "Desconexão pedida (motivo %d), sem reconexão", reason);
+        return;
+    }
+    
+    if (gave_up_now) {
+        ESP_LOGE(TAG, "Falhas de autenticação seguidas (motivo %d), novas tentativas a cada %d s",
+                 reason, WIFI_RECONNECT_MAX_MS / 1000);
+    }
+    ESP_LOGI(TAG, "Reconexão em %lu ms (motivo %d, %s%s, tentativa %lu)",
+             (unsigned long)delay, reason, wifi_reconnect_policy_name(policy),
+             fallback ? ", busca pelo SSID" : "", (unsigned long)consecutive);
+    esp_timer_start_once(s_timer, delay * 1000ULL);
+}
+
+void wifi_reconnect_notify_connected(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_state.consecutive = 0;
+    s_state.auth_failures = 0;
+    s_state.gave_up = false;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void wifi_reconnect_reset(void)
+{
+    if (s_timer) {
+        esp_timer_stop(s_timer);
+    }
+    
+    taskENTER_CRITICAL(&s_lock);
+    s_next_attempt_us = 0;
+    s_state.consecutive = 0;
+    s_state.auth_failures = 0;
+    s_state.gave_up = false;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t wifi_reconnect_get_stats(wifi_reconnect_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int64_t now = esp_timer_get_time();
+    
+    taskENTER_CRITICAL(&s_lock);
+    stats->state = s_state;
+    stats->next_attempt_ms = s_next_attempt_us == 0 ? -1 :
+                             (s_next_attempt_us > now ? (s_next_attempt_us - now) / 1000 : 0);
+    taskEXIT_CRITICAL(&s_lock);
+    
+    return ESP_OK;
+}
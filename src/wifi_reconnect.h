@@ -0,0 +1,133 @@
+/**
+ * @file wifi_reconnect.h
+ * @brief Agendador de reconexão do STA com backoff exponencial
+ * 
+ * Em vez de chamar esp_wifi_connect() logo após cada desconexão, o próximo
+ * esp_wifi_connect() é agendado em um esp_timer, com intervalo que dobra a
+ * cada falha (com jitter) e política conforme o motivo da desconexão:
+ * senha errada passa ao intervalo máximo após algumas tentativas, AP
+ * ausente espera mais e desconexão pedida pela aplicação não reconecta.
+ * 
+ * O cálculo do intervalo (wifi_reconnect_next_delay) não depende do
+ * driver nem do timer e pode ser exercitado fora do ESP32 com uma
+ * sequência simulada de motivos.
+ */
+
+#ifndef WIFI_RECONNECT_H
+#define WIFI_RECONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Intervalo da primeira tentativa e limite do backoff (ms)
+#define WIFI_RECONNECT_BASE_MS         500
+#define WIFI_RECONNECT_MAX_MS          60000
+
+// AP ausente (desligado ou fora de alcance): começa com intervalo maior
+#define WIFI_RECONNECT_AP_MISSING_MS   5000
+
+// Falhas de autenticação seguidas até desistir do backoff (senha errada);
+// depois disso, uma tentativa a cada WIFI_RECONNECT_MAX_MS
+#define WIFI_RECONNECT_AUTH_MAX_FAILURES 3
+
+// Retorno de wifi_reconnect_next_delay(): não reconectar
+#define WIFI_RECONNECT_NEVER UINT32_MAX
+
+// Política por motivo de desconexão
+typedef enum {
+    WIFI_RECONNECT_POLICY_RETRY = 0,    // Backoff a partir de WIFI_RECONNECT_BASE_MS
+    WIFI_RECONNECT_POLICY_AP_MISSING,   // Backoff a partir de WIFI_RECONNECT_AP_MISSING_MS
+    WIFI_RECONNECT_POLICY_AUTH,         // Backoff; intervalo máximo após WIFI_RECONNECT_AUTH_MAX_FAILURES
+    WIFI_RECONNECT_POLICY_NONE,         // Desconexão pedida: não reconectar
+} wifi_reconnect_policy_t;
+
+// Estado e contadores
+typedef struct {
+    uint32_t disconnects;       // Desconexões desde o boot
+    uint32_t attempts;          // Reconexões disparadas desde o boot
+    uint32_t consecutive;       // Tentativas desde a última conexão com IP
+    uint32_t auth_failures;     // Falhas de autenticação seguidas
+    uint8_t last_reason;        // wifi_err_reason_t da última desconexão
+    uint32_t last_delay_ms;     // Último intervalo agendado
+    bool gave_up;               // Desistiu do backoff (senha errada): intervalo máximo
+} wifi_reconnect_state_t;
+
+// Cópia para a API de status
+typedef struct {
+    wifi_reconnect_state_t state;
+    int64_t next_attempt_ms;    // Tempo até a próxima tentativa (-1: nenhuma)
+} wifi_reconnect_stats_t;
+
+/**
+ * @brief Política para um motivo de desconexão (wifi_err_reason_t)
+ */
+wifi_reconnect_policy_t wifi_reconnect_classify(uint8_t reason);
+
+/**
+ * @brief Registrar desconexão e calcular o intervalo até a próxima tentativa
+ * 
+ * Função pura sobre o estado: intervalo = base * 2^tentativas, limitado a
+ * WIFI_RECONNECT_MAX_MS, sorteado entre a metade e o valor cheio. Com
+ * fallback, a tentativa seguinte sai em WIFI_RECONNECT_BASE_MS, sem jitter
+ * e sem contar no backoff.
+ * 
+ * @param state Estado (atualizado)
+ * @param reason Motivo da desconexão (wifi_err_reason_t)
+ * @param fallback true se a desconexão encerra a tentativa rápida (BSSID
+ *                 salvo) e a próxima busca a rede pelo SSID
+ * @param random Valor aleatório para o jitter (ex.: esp_random())
+ * @return uint32_t Intervalo em ms, ou WIFI_RECONNECT_NEVER
+ */
+uint32_t wifi_reconnect_next_delay(wifi_reconnect_state_t *state, uint8_t reason,
+                                   bool fallback, uint32_t random);
+
+/**
+ * @brief Criar o timer de reconexão
+ * 
+ * @return esp_err_t
+ */
+esp_err_t wifi_reconnect_init(void);
+
+/**
+ * @brief Agendar reconexão após uma desconexão
+ * 
+ * @param reason Motivo da desconexão (wifi_event_sta_disconnected_t.reason)
+ * @param fallback true se a desconexão encerra a tentativa rápida (BSSID salvo)
+ */
+void wifi_reconnect_schedule(uint8_t reason, bool fallback);
+
+/**
+ * @brief Conexão obtida (IP): zera o backoff
+ */
+void wifi_reconnect_notify_connected(void);
+
+/**
+ * @brief Cancelar tentativa agendada e zerar o backoff
+ * 
+ * Usado em conexões/desconexões manuais; limpa também a desistência.
+ */
+void wifi_reconnect_reset(void);
+
+/**
+ * @brief Obter contadores e próxima tentativa
+ * 
+ * @param stats Contadores
+ * @return esp_err_t
+ */
+esp_err_t wifi_reconnect_get_stats(wifi_reconnect_stats_t *stats);
+
+/**
+ * @brief Nome da política (para logs e API)
+ */
+const char* wifi_reconnect_policy_name(wifi_reconnect_policy_t policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_RECONNECT_H
@@ -0,0 +1,535 @@
+/**
+ * @file bench_json_writer.c
+ * @brief Alocações e bytes dos getters JSON: json_writer contra cJSON
+ * 
+ * Monta os mesmos documentos dos getters de web_server.c (status do sistema
+ * e resultado do scan com N redes) com o json_writer, em blocos de 512 bytes
+ * como send_json_stream(), e com o caminho cJSON que ele substituiu (árvore,
+ * cJSON_Print e cópia para o buffer estático da resposta). malloc, calloc,
+ * realloc e free são interceptados no link (-Wl,--wrap) para contar as
+ * alocações de cada documento:
+ * 
+ *   bench_json_writer [iterações] [redes no scan]
+ * 
+ * Sem cJSON no build (BENCH_HAVE_CJSON indefinido), mede só o json_writer.
+ */
+
+#include "host_test.h"
+#include "json_writer.h"
+#include "esp_timer.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef BENCH_HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+#define BENCH_CHUNK_SIZE 512        // WEB_JSON_CHUNK_SIZE
+#define BENCH_OUTPUT_SIZE 32768     // Buffer estático do caminho cJSON
+#define BENCH_MAX_NETWORKS 64
+#define BENCH_APS_PER_NETWORK 2
+
+// ============================================================================
+// CONTAGEM DE ALOCAÇÕES
+// ============================================================================
+
+typedef struct {
+    size_t allocs;          // Blocos novos (malloc, calloc, realloc de NULL)
+    size_t reallocs;        // Redimensionamentos de blocos existentes
+    size_t frees;
+    size_t bytes;           // Bytes pedidos, inclusive nos redimensionamentos
+} alloc_stats_t;
+
+static bool s_counting;
+static alloc_stats_t s_stats;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    if (s_counting) {
+        s_stats.allocs++;
+        s_stats.bytes += size;
+    }
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    if (s_counting) {
+        s_stats.allocs++;
+        s_stats.bytes += n * size;
+    }
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (s_counting) {
+        if (ptr) {
+            s_stats.reallocs++;
+        } else {
+            s_stats.allocs++;
+        }
+        s_stats.bytes += size;
+    }
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (s_counting && ptr) {
+        s_stats.frees++;
+    }
+    __real_free(ptr);
+}
+
+// ============================================================================
+// DADOS DOS DOCUMENTOS
+// ============================================================================
+
+typedef struct {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+} bench_ap_t;
+
+typedef struct {
+    char ssid[33];
+    int8_t rssi;
+    const char *auth;
+    uint8_t channel;
+    bench_ap_t aps[BENCH_APS_PER_NETWORK];
+} bench_network_t;
+
+static bench_network_t s_networks[BENCH_MAX_NETWORKS];
+static int s_network_count;
+
+static void make_networks(int count)
+{
+    static const char *auth[] = { "OPEN", "WPA2_PSK", "WPA_WPA2_PSK", "WPA3_PSK" };
+    s_network_count = count;
+    for (int i = 0; i < count; i++) {
+        bench_network_t *n = &s_networks[i];
+        snprintf(n->ssid, sizeof(n->ssid), "Rede \"%02d\" 2.4GHz", i);
+        n->rssi = (int8_t)(-40 - i);
+        n->auth = auth[i % 4];
+        n->channel = (uint8_t)(1 + i % 13);
+        for (int j = 0; j < BENCH_APS_PER_NETWORK; j++) {
+            bench_ap_t *ap = &n->aps[j];
+            for (int k = 0; k < 6; k++) {
+                ap->bssid[k] = (uint8_t)(0x10 * k + i + j);
+            }
+            ap->rssi = (int8_t)(n->rssi - 3 * j);
+            ap->channel = n->channel;
+        }
+    }
+}
+
+static void format_bssid(char text[18], const uint8_t bssid[6])
+{
+    snprintf(text, 18, "%02x:%02x:%02x:%02x:%02x:%02x",
+             bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+}
+
+// ============================================================================
+// JSON_WRITER (get_system_status / get_wifi_scan_results)
+// ============================================================================
+
+static void writer_status(json_writer_t *w)
+{
+    json_writer_object_begin(w, NULL);
+    json_writer_add_bool(w, "wifi_connected", true);
+    json_writer_add_string(w, "wifi_ssid", "Conectado");
+    json_writer_object_begin(w, "wifi_reconnect");
+    json_writer_add_int(w, "disconnects", 3);
+    json_writer_add_int(w, "attempts", 5);
+    json_writer_add_int(w, "consecutive", 0);
+    json_writer_add_int(w, "last_reason", 201);
+    json_writer_add_string(w, "policy", "backoff");
+    json_writer_add_int(w, "last_delay_ms", 4000);
+    json_writer_add_int(w, "next_attempt_ms", 0);
+    json_writer_add_bool(w, "gave_up", false);
+    json_writer_object_end(w);
+    json_writer_object_begin(w, "http_async");
+    json_writer_add_int(w, "workers", 2);
+    json_writer_add_int(w, "busy", 0);
+    json_writer_add_int(w, "queued", 0);
+    json_writer_add_int(w, "dispatched", 1234);
+    json_writer_add_int(w, "rejected", 0);
+    json_writer_add_int(w, "max_wait_us", 850);
+    json_writer_object_end(w);
+    json_writer_add_bool(w, "ap_active", true);
+    json_writer_add_string(w, "ap_ssid", "pos_softap");
+    json_writer_add_string(w, "ap_ip", "192.168.4.1");
+    json_writer_add_int(w, "uptime", 86400);
+    json_writer_add_int(w, "free_heap", 182344);
+    json_writer_add_int(w, "min_free_heap", 150112);
+    json_writer_add_string(w, "version", "Maya Gateway v1.0.0");
+    json_writer_add_string(w, "chip_model", "ESP32-C6");
+    json_writer_add_int(w, "cpu_freq", 160);
+    json_writer_add_string(w, "status", "online");
+    json_writer_add_string(w, "author", "Eng. Klaus Q. Terra - Hiperenge");
+    json_writer_object_end(w);
+}
+
+static void writer_scan(json_writer_t *w)
+{
+    char text[18];
+    json_writer_object_begin(w, NULL);
+    json_writer_array_begin(w, "networks");
+    for (int i = 0; i < s_network_count; i++) {
+        const bench_network_t *n = &s_networks[i];
+        json_writer_object_begin(w, NULL);
+        json_writer_add_string(w, "ssid", n->ssid);
+        json_writer_add_int(w, "rssi", n->rssi);
+        json_writer_add_string(w, "auth", n->auth);
+        json_writer_add_int(w, "channel", n->channel);
+        format_bssid(text, n->aps[0].bssid);
+        json_writer_add_string(w, "bssid", text);
+        json_writer_array_begin(w, "bssids");
+        for (int j = 0; j < BENCH_APS_PER_NETWORK; j++) {
+            json_writer_object_begin(w, NULL);
+            format_bssid(text, n->aps[j].bssid);
+            json_writer_add_string(w, "bssid", text);
+            json_writer_add_int(w, "rssi", n->aps[j].rssi);
+            json_writer_add_int(w, "channel", n->aps[j].channel);
+            json_writer_object_end(w);
+        }
+        json_writer_array_end(w);
+        json_writer_object_end(w);
+    }
+    json_writer_array_end(w);
+    json_writer_add_int(w, "count", s_network_count);
+    json_writer_add_int(w, "total", s_network_count);
+    json_writer_add_int(w, "ap_count", s_network_count * BENCH_APS_PER_NETWORK);
+    json_writer_add_string(w, "mode", "full");
+    json_writer_add_bool(w, "partial", false);
+    json_writer_add_int(w, "age_ms", 1500);
+    json_writer_add_bool(w, "scanning", false);
+    json_writer_object_end(w);
+}
+
+// Saída dos blocos descarregados, para conferir o documento
+typedef struct {
+    char data[BENCH_OUTPUT_SIZE];
+    size_t len;
+    int chunks;
+} bench_sink_t;
+
+static esp_err_t sink_flush(void *ctx, const char *data, size_t len)
+{
+    bench_sink_t *sink = ctx;
+    if (sink->len + len >= sizeof(sink->data)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    sink->chunks++;
+    return ESP_OK;
+}
+
+static esp_err_t run_writer(void (*write_json)(json_writer_t *w), bench_sink_t *sink)
+{
+    char buffer[BENCH_CHUNK_SIZE];
+    json_writer_t w;
+    
+    sink->len = 0;
+    sink->chunks = 0;
+    json_writer_init_stream(&w, buffer, sizeof(buffer), sink_flush, sink);
+    write_json(&w);
+    return json_writer_finish(&w);
+}
+
+// ============================================================================
+// CJSON (caminho anterior dos getters)
+// ============================================================================
+
+#ifdef BENCH_HAVE_CJSON
+
+static cJSON *cjson_status(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "wifi_connected", true);
+    cJSON_AddStringToObject(json, "wifi_ssid", "Conectado");
+    cJSON *reconnect = cJSON_AddObjectToObject(json, "wifi_reconnect");
+    cJSON_AddNumberToObject(reconnect, "disconnects", 3);
+    cJSON_AddNumberToObject(reconnect, "attempts", 5);
+    cJSON_AddNumberToObject(reconnect, "consecutive", 0);
+    cJSON_AddNumberToObject(reconnect, "last_reason", 201);
+    cJSON_AddStringToObject(reconnect, "policy", "backoff");
+    cJSON_AddNumberToObject(reconnect, "last_delay_ms", 4000);
+    cJSON_AddNumberToObject(reconnect, "next_attempt_ms", 0);
+    cJSON_AddBoolToObject(reconnect, "gave_up", false);
+    cJSON *async = cJSON_AddObjectToObject(json, "http_async");
+    cJSON_AddNumberToObject(async, "workers", 2);
+    cJSON_AddNumberToObject(async, "busy", 0);
+    cJSON_AddNumberToObject(async, "queued", 0);
+    cJSON_AddNumberToObject(async, "dispatched", 1234);
+    cJSON_AddNumberToObject(async, "rejected", 0);
+    cJSON_AddNumberToObject(async, "max_wait_us", 850);
+    cJSON_AddBoolToObject(json, "ap_active", true);
+    cJSON_AddStringToObject(json, "ap_ssid", "pos_softap");
+    cJSON_AddStringToObject(json, "ap_ip", "192.168.4.1");
+    cJSON_AddNumberToObject(json, "uptime", 86400);
+    cJSON_AddNumberToObject(json, "free_heap", 182344);
+    cJSON_AddNumberToObject(json, "min_free_heap", 150112);
+    cJSON_AddStringToObject(json, "version", "Maya Gateway v1.0.0");
+    cJSON_AddStringToObject(json, "chip_model", "ESP32-C6");
+    cJSON_AddNumberToObject(json, "cpu_freq", 160);
+    cJSON_AddStringToObject(json, "status", "online");
+    cJSON_AddStringToObject(json, "author", "Eng. Klaus Q. Terra - Hiperenge");
+    return json;
+}
+
+static cJSON *cjson_scan(void)
+{
+    char text[18];
+    cJSON *json = cJSON_CreateObject();
+    cJSON *networks = cJSON_AddArrayToObject(json, "networks");
+    for (int i = 0; i < s_network_count; i++) {
+        const bench_network_t *n = &s_networks[i];
+        cJSON *network = cJSON_CreateObject();
+        cJSON_AddStringToObject(network, "ssid", n->ssid);
+        cJSON_AddNumberToObject(network, "rssi", n->rssi);
+        cJSON_AddStringToObject(network, "auth", n->auth);
+        cJSON_AddNumberToObject(network, "channel", n->channel);
+        format_bssid(text, n->aps[0].bssid);
+        cJSON_AddStringToObject(network, "bssid", text);
+        cJSON *bssids = cJSON_AddArrayToObject(network, "bssids");
+        for (int j = 0; j < BENCH_APS_PER_NETWORK; j++) {
+            cJSON *ap = cJSON_CreateObject();
+            format_bssid(text, n->aps[j].bssid);
+            cJSON_AddStringToObject(ap, "bssid", text);
+            cJSON_AddNumberToObject(ap, "rssi", n->aps[j].rssi);
+            cJSON_AddNumberToObject(ap, "channel", n->aps[j].channel);
+            cJSON_AddItemToArray(bssids, ap);
+        }
+        cJSON_AddItemToArray(networks, network);
+    }
+    cJSON_AddNumberToObject(json, "count", s_network_count);
+    cJSON_AddNumberToObject(json, "total", s_network_count);
+    cJSON_AddNumberToObject(json, "ap_count", s_network_count * BENCH_APS_PER_NETWORK);
+    cJSON_AddStringToObject(json, "mode", "full");
+    cJSON_AddBoolToObject(json, "partial", false);
+    cJSON_AddNumberToObject(json, "age_ms", 1500);
+    cJSON_AddBoolToObject(json, "scanning", false);
+    return json;
+}
+
+/**
+ * @brief Montar a árvore, imprimir e copiar para o buffer estático
+ */
+static size_t run_cjson(cJSON *(*build)(void), bool formatted, char *output)
+{
+    cJSON *json = build();
+    char *json_string = formatted ? cJSON_Print(json) : cJSON_PrintUnformatted(json);
+    size_t len = json_string ? strlen(json_string) : 0;
+    if (json_string) {
+        strncpy(output, json_string, BENCH_OUTPUT_SIZE - 1);
+        output[BENCH_OUTPUT_SIZE - 1] = '\0';
+        free(json_string);
+    }
+    cJSON_Delete(json);
+    return len;
+}
+
+#endif // BENCH_HAVE_CJSON
+
+// ============================================================================
+// VALIDAÇÃO
+// ============================================================================
+
+static const char *skip_ws(const char *p)
+{
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Consumir um valor JSON; NULL se a sintaxe for inválida
+ */
+static const char *parse_value(const char *p, int depth)
+{
+    p = skip_ws(p);
+    if (depth > JSON_WRITER_MAX_DEPTH) {
+        return NULL;
+    }
+    if (*p == '"') {
+        for (p++; *p != '"'; p++) {
+            if ((unsigned char)*p < 0x20) {
+                return NULL;
+            }
+            if (*p == '\\' && *++p == '\0') {
+                return NULL;
+            }
+        }
+        return p + 1;
+    }
+    if (*p == '{' || *p == '[') {
+        char close = *p == '{' ? '}' : ']';
+        p = skip_ws(p + 1);
+        if (*p == close) {
+            return p + 1;
+        }
+        for (;;) {
+            if (close == '}') {
+                p = skip_ws(p);
+                if (*p != '"' || !(p = parse_value(p, depth + 1))) {
+                    return NULL;
+                }
+                p = skip_ws(p);
+                if (*p++ != ':') {
+                    return NULL;
+                }
+            }
+            if (!(p = parse_value(p, depth + 1))) {
+                return NULL;
+            }
+            p = skip_ws(p);
+            if (*p == close) {
+                return p + 1;
+            }
+            if (*p++ != ',') {
+                return NULL;
+            }
+        }
+    }
+    if (strncmp(p, "true", 4) == 0 || strncmp(p, "null", 4) == 0) {
+        return p + 4;
+    }
+    if (strncmp(p, "false", 5) == 0) {
+        return p + 5;
+    }
+    const char *start = p;
+    if (*p == '-') {
+        p++;
+    }
+    while (isdigit((unsigned char)*p)) {
+        p++;
+    }
+    return p > start && isdigit((unsigned char)p[-1]) ? p : NULL;
+}
+
+static bool json_valid(const char *text)
+{
+    const char *end = parse_value(text, 0);
+    return end && *skip_ws(end) == '\0';
+}
+
+// ============================================================================
+// MEDIÇÃO
+// ============================================================================
+
+typedef struct {
+    alloc_stats_t stats;    // Por documento
+    size_t output;
+    double ns;
+} bench_result_t;
+
+static void print_result(const char *doc, const bench_result_t *r, const char *path)
+{
+    printf("%-7s %9zu %10zu %8zu %10.0f  %s\n", doc,
+           r->stats.allocs + r->stats.reallocs, r->stats.bytes, r->output, r->ns, path);
+}
+
+static void bench_writer(const char *doc, void (*write_json)(json_writer_t *w), int iterations,
+                         bench_sink_t *sink)
+{
+    bench_result_t r = {0};
+    
+    // Uma execução fora da medição para conferir o documento
+    CHECK_EQ(run_writer(write_json, sink), ESP_OK);
+    CHECK(json_valid(sink->data));
+    
+    s_stats = (alloc_stats_t){0};
+    s_counting = true;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        run_writer(write_json, sink);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    s_counting = false;
+    
+    // O json_writer não aloca
+    CHECK_EQ(s_stats.allocs + s_stats.reallocs, 0);
+    CHECK_EQ(s_stats.frees, 0);
+    
+    r.output = sink->len;
+    r.ns = elapsed * 1000.0 / iterations;
+    print_result(doc, &r, "json_writer");
+}
+
+#ifdef BENCH_HAVE_CJSON
+
+static void bench_cjson(const char *doc, cJSON *(*build)(void), bool formatted, int iterations,
+                        const bench_sink_t *writer_output)
+{
+    static char output[BENCH_OUTPUT_SIZE];
+    bench_result_t r = {0};
+    
+    r.output = run_cjson(build, formatted, output);
+    CHECK(json_valid(output));
+    if (!formatted) {
+        // Mesmo documento, byte a byte, que o json_writer
+        CHECK_EQ(r.output, writer_output->len);
+        CHECK(strcmp(output, writer_output->data) == 0);
+    }
+    
+    s_stats = (alloc_stats_t){0};
+    s_counting = true;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        run_cjson(build, formatted, output);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    s_counting = false;
+    
+    // Toda alocação é liberada no fim do documento
+    CHECK_EQ(s_stats.allocs, s_stats.frees);
+    
+    r.stats.allocs = s_stats.allocs / iterations;
+    r.stats.reallocs = s_stats.reallocs / iterations;
+    r.stats.bytes = s_stats.bytes / iterations;
+    r.ns = elapsed * 1000.0 / iterations;
+    print_result(doc, &r, formatted ? "cJSON_Print + cópia" : "cJSON_PrintUnformatted + cópia");
+}
+
+#endif // BENCH_HAVE_CJSON
+
+int main(int argc, char **argv)
+{
+    static bench_sink_t status_sink;
+    static bench_sink_t scan_sink;
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    int networks = argc > 2 ? atoi(argv[2]) : 20;
+    CHECK_RANGE(iterations, 1, 10000000);
+    CHECK_RANGE(networks, 0, BENCH_MAX_NETWORKS);
+    make_networks(networks);
+    
+    printf("%d iterações; scan com %d redes (%d BSSIDs); blocos de %d bytes\n",
+           iterations, networks, networks * BENCH_APS_PER_NETWORK, BENCH_CHUNK_SIZE);
+    printf("doc     alocações      bytes    saída     ns/doc  caminho\n");
+    
+    bench_writer("status", writer_status, iterations, &status_sink);
+    bench_writer("scan", writer_scan, iterations, &scan_sink);
+    printf("status: %d blocos; scan: %d blocos\n", status_sink.chunks, scan_sink.chunks);
+
+#ifdef BENCH_HAVE_CJSON
+    bench_cjson("status", cjson_status, true, iterations, &status_sink);
+    bench_cjson("status", cjson_status, false, iterations, &status_sink);
+    bench_cjson("scan", cjson_scan, true, iterations, &scan_sink);
+    bench_cjson("scan", cjson_scan, false, iterations, &scan_sink);
+#else
+    printf("cJSON indisponível neste build: defina CJSON_DIR (ou IDF_PATH) para comparar\n");
+#endif
+
+    return 0;
+}
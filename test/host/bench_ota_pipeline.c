@@ -0,0 +1,119 @@
+/**
+ * @file bench_ota_pipeline.c
+ * @brief Vazão do upload OTA em série e em pipeline com flash de apagamento lento
+ * 
+ * A recepção de cada bloco de 4 KB leva um tempo fixo (taxa do enlace) e a
+ * flash falsa simula a duração de apagamento e gravação. Mede-se o tempo de
+ * ponta a ponta, de ota_begin_streaming() até a imagem instalada, como o
+ * cliente HTTP o percebe:
+ * 
+ *   bench_ota_pipeline [KB da imagem] [us de recepção por 4 KB]
+ *                      [us de apagamento por setor] [us de gravação por KB]
+ */
+
+#include "host_test.h"
+#include "fake_idf.h"
+#include "ota_test_util.h"
+#include "ota_handler.h"
+#include "esp_ota_ops.h"
+#include "esp_timer.h"
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    size_t image_size;
+    uint32_t recv_us;
+    uint32_t erase_us;
+    uint32_t write_us_per_kb;
+} bench_params_t;
+
+/**
+ * @brief Upload em série: recebe um bloco e só então o grava
+ */
+static esp_err_t stream_serial(const uint8_t *data, size_t len, uint32_t recv_us)
+{
+    while (len > 0) {
+        size_t n = len < OTA_STREAM_CHUNK_SIZE ? len : OTA_STREAM_CHUNK_SIZE;
+        usleep(recv_us);
+        esp_err_t ret = ota_write_data(data, n);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Gravar a imagem num modo e retornar a vazão em MB/s
+ */
+static double run_mode(const bench_params_t *p, const uint8_t *image, bool pipelined, bool pre_erase)
+{
+    ota_test_setup();
+    fake_flash_set_timing(p->erase_us, p->write_us_per_kb);
+    ota_set_pre_erase_enabled(pre_erase);
+    
+    int64_t start = esp_timer_get_time();
+    CHECK_EQ(ota_begin_streaming(NULL, p->image_size), ESP_OK);
+    esp_err_t ret = pipelined ? ota_test_stream_pipelined(image, p->image_size, p->recv_us) :
+                                stream_serial(image, p->image_size, p->recv_us);
+    int64_t elapsed = esp_timer_get_time() - start;
+    
+    CHECK_EQ(ret, ESP_OK);
+    CHECK(memcmp(fake_flash_data("ota_0"), image, p->image_size) == 0);
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "ota_0") == 0);
+    
+    // Aguardar o fim do pré-apagamento antes do próximo modo
+    ota_test_wait_erase_idle();
+    
+    double mbps = (double)p->image_size / (double)elapsed;
+    printf("%8.1f ms  %6.2f MB/s  %s\n", elapsed / 1000.0, mbps,
+           pipelined ? (pre_erase ? "pipeline + pré-apagamento" : "pipeline") :
+                       (pre_erase ? "série + pré-apagamento" : "série"));
+    return mbps;
+}
+
+int main(int argc, char **argv)
+{
+    // Escala reduzida: enlace de ~4 MB/s, apagamento mais lento que o enlace
+    bench_params_t p = {
+        .image_size = 512 * 1024,
+        .recv_us = 1000,
+        .erase_us = 1500,
+        .write_us_per_kb = 250,
+    };
+    if (argc > 1) {
+        p.image_size = (size_t)atoi(argv[1]) * 1024;
+    }
+    if (argc > 2) {
+        p.recv_us = (uint32_t)atoi(argv[2]);
+    }
+    if (argc > 3) {
+        p.erase_us = (uint32_t)atoi(argv[3]);
+    }
+    if (argc > 4) {
+        p.write_us_per_kb = (uint32_t)atoi(argv[4]);
+    }
+    CHECK_RANGE(p.image_size, 64 * 1024, 0x100000);
+    
+    uint8_t *image = ota_test_image(p.image_size, 42);
+    
+    printf("Imagem de %u KB; recepção %u us/4 KB (enlace %.2f MB/s); apagamento %u us/setor; "
+           "gravação %u us/KB\n",
+           (unsigned)(p.image_size / 1024), (unsigned)p.recv_us,
+           p.recv_us > 0 ? (double)OTA_STREAM_CHUNK_SIZE / p.recv_us : 0.0,
+           (unsigned)p.erase_us, (unsigned)p.write_us_per_kb);
+    
+    double serial = run_mode(&p, image, false, false);
+    double pipelined = run_mode(&p, image, true, false);
+    run_mode(&p, image, false, true);
+    double pipelined_pre_erase = run_mode(&p, image, true, true);
+    
+    printf("pipeline / série: %.2fx; pipeline + pré-apagamento / série: %.2fx\n",
+           pipelined / serial, pipelined_pre_erase / serial);
+    
+    free(image);
+    return 0;
+}
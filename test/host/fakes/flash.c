@@ -0,0 +1,435 @@
+/**
+ * @file flash.c
+ * @brief Flash NOR em memória, partições de partitions.csv e esp_ota_*
+ * 
+ * Apagar leva os bytes a 0xFF e gravar faz AND com o conteúdo atual, como
+ * na flash real: gravar sobre uma região não apagada corrompe os dados e é
+ * detectado pela comparação final dos testes.
+ */
+
+#include "fake_idf.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+#include "esp_image_format.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FAKE_SECTOR_SIZE 4096
+
+// Conteúdo inicial das partições: nem apagado, nem zero
+#define FAKE_FLASH_GARBAGE 0xA5
+
+typedef struct {
+    esp_partition_t info;
+    uint8_t *data;
+    size_t image_len;     // Imagem carregada por fake_flash_load()
+} fake_partition_t;
+
+static fake_partition_t s_partitions[] = {
+    { .info = { .type = ESP_PARTITION_TYPE_DATA, .subtype = ESP_PARTITION_SUBTYPE_DATA_NVS,
+                .address = 0x9000, .size = 0x6000, .label = "nvs" } },
+    { .info = { .type = ESP_PARTITION_TYPE_DATA, .subtype = ESP_PARTITION_SUBTYPE_DATA_PHY,
+                .address = 0xf000, .size = 0x1000, .label = "phy_init" } },
+    { .info = { .type = ESP_PARTITION_TYPE_APP, .subtype = ESP_PARTITION_SUBTYPE_APP_FACTORY,
+                .address = 0x10000, .size = 0x100000, .label = "factory" } },
+    { .info = { .type = ESP_PARTITION_TYPE_APP, .subtype = ESP_PARTITION_SUBTYPE_APP_OTA_0,
+                .address = 0x110000, .size = 0x100000, .label = "ota_0" } },
+    { .info = { .type = ESP_PARTITION_TYPE_APP, .subtype = ESP_PARTITION_SUBTYPE_APP_OTA_1,
+                .address = 0x210000, .size = 0x100000, .label = "ota_1" } },
+    { .info = { .type = ESP_PARTITION_TYPE_DATA, .subtype = ESP_PARTITION_SUBTYPE_DATA_SPIFFS,
+                .address = 0x310000, .size = 0xE0000, .label = "spiffs" } },
+};
+
+#define FAKE_PARTITION_COUNT (sizeof(s_partitions) / sizeof(s_partitions[0]))
+
+static const esp_partition_t *s_boot = NULL;
+
+// Tempo simulado das operações (0 = instantâneas)
+static uint32_t s_erase_us_per_sector = 0;
+static uint32_t s_write_us_per_kb = 0;
+
+// Contadores lidos pelos testes (o pré-apagamento roda em outra task)
+static pthread_mutex_t s_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t s_erased_bytes = 0;
+
+static fake_partition_t *find_fake(const esp_partition_t *partition)
+{
+    for (size_t i = 0; i < FAKE_PARTITION_COUNT; i++) {
+        if (&s_partitions[i].info == partition) {
+            return &s_partitions[i];
+        }
+    }
+    return NULL;
+}
+
+static fake_partition_t *find_by_label(const char *label)
+{
+    for (size_t i = 0; i < FAKE_PARTITION_COUNT; i++) {
+        if (strcmp(s_partitions[i].info.label, label) == 0) {
+            return &s_partitions[i];
+        }
+    }
+    return NULL;
+}
+
+void fake_flash_reset(void)
+{
+    for (size_t i = 0; i < FAKE_PARTITION_COUNT; i++) {
+        fake_partition_t *p = &s_partitions[i];
+        if (!p->data) {
+            p->data = malloc(p->info.size);
+            if (!p->data) {
+                abort();
+            }
+        }
+        memset(p->data, FAKE_FLASH_GARBAGE, p->info.size);
+        p->image_len = 0;
+        p->info.erase_size = FAKE_SECTOR_SIZE;
+    }
+    s_boot = NULL;
+    s_erase_us_per_sector = 0;
+    s_write_us_per_kb = 0;
+    
+    pthread_mutex_lock(&s_stats_lock);
+    s_erased_bytes = 0;
+    pthread_mutex_unlock(&s_stats_lock);
+}
+
+void fake_flash_load(const char *label, const uint8_t *image, size_t len)
+{
+    fake_partition_t *p = find_by_label(label);
+    if (!p || len > p->info.size) {
+        abort();
+    }
+    memset(p->data, 0xFF, p->info.size);
+    memcpy(p->data, image, len);
+    p->image_len = len;
+}
+
+const uint8_t *fake_flash_data(const char *label)
+{
+    fake_partition_t *p = find_by_label(label);
+    return p ? p->data : NULL;
+}
+
+void fake_flash_set_timing(uint32_t erase_us_per_sector, uint32_t write_us_per_kb)
+{
+    s_erase_us_per_sector = erase_us_per_sector;
+    s_write_us_per_kb = write_us_per_kb;
+}
+
+size_t fake_flash_erased_bytes(void)
+{
+    pthread_mutex_lock(&s_stats_lock);
+    size_t erased = s_erased_bytes;
+    pthread_mutex_unlock(&s_stats_lock);
+    return erased;
+}
+
+// Partições
+
+struct fake_partition_iterator {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    const char *label;
+    size_t index;
+};
+
+static bool iterator_matches(const struct fake_partition_iterator *it, const fake_partition_t *p)
+{
+    return (it->type == ESP_PARTITION_TYPE_ANY || it->type == p->info.type) &&
+           (it->subtype == ESP_PARTITION_SUBTYPE_ANY || it->subtype == p->info.subtype) &&
+           (!it->label || strcmp(it->label, p->info.label) == 0);
+}
+
+/**
+ * @brief Avançar até a próxima partição compatível (a partir de index)
+ * 
+ * @return NULL, liberando o iterador, se não houver mais partições
+ */
+static esp_partition_iterator_t iterator_seek(esp_partition_iterator_t it)
+{
+    while (it->index < FAKE_PARTITION_COUNT && !iterator_matches(it, &s_partitions[it->index])) {
+        it->index++;
+    }
+    if (it->index == FAKE_PARTITION_COUNT) {
+        free(it);
+        return NULL;
+    }
+    return it;
+}
+
+esp_partition_iterator_t esp_partition_find(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                            const char *label)
+{
+    struct fake_partition_iterator *it = calloc(1, sizeof(*it));
+    if (!it) {
+        return NULL;
+    }
+    it->type = type;
+    it->subtype = subtype;
+    it->label = label;
+    return iterator_seek(it);
+}
+
+const esp_partition_t *esp_partition_get(esp_partition_iterator_t iterator)
+{
+    return &s_partitions[iterator->index].info;
+}
+
+esp_partition_iterator_t esp_partition_next(esp_partition_iterator_t iterator)
+{
+    iterator->index++;
+    return iterator_seek(iterator);
+}
+
+void esp_partition_iterator_release(esp_partition_iterator_t iterator)
+{
+    free(iterator);
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    fake_partition_t *p = find_fake(partition);
+    if (!p || !dst) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (src_offset > p->info.size || size > p->info.size - src_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, p->data + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    fake_partition_t *p = find_fake(partition);
+    if (!p || !src) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dst_offset > p->info.size || size > p->info.size - dst_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    const uint8_t *bytes = src;
+    for (size_t i = 0; i < size; i++) {
+        p->data[dst_offset + i] &= bytes[i];
+    }
+    
+    if (s_write_us_per_kb > 0) {
+        usleep((useconds_t)((uint64_t)size * s_write_us_per_kb / 1024));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    fake_partition_t *p = find_fake(partition);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset % FAKE_SECTOR_SIZE != 0 || size % FAKE_SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > p->info.size || size > p->info.size - offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    memset(p->data + offset, 0xFF, size);
+    
+    pthread_mutex_lock(&s_stats_lock);
+    s_erased_bytes += size;
+    pthread_mutex_unlock(&s_stats_lock);
+    
+    if (s_erase_us_per_sector > 0) {
+        usleep((useconds_t)(size / FAKE_SECTOR_SIZE) * s_erase_us_per_sector);
+    }
+    return ESP_OK;
+}
+
+// Imagens
+
+esp_err_t esp_image_get_metadata(const esp_partition_pos_t *part, esp_image_metadata_t *metadata)
+{
+    for (size_t i = 0; i < FAKE_PARTITION_COUNT; i++) {
+        fake_partition_t *p = &s_partitions[i];
+        if (p->info.address != part->offset) {
+            continue;
+        }
+        if (p->image_len == 0 || p->data[0] != ESP_IMAGE_HEADER_MAGIC) {
+            return ESP_ERR_IMAGE_INVALID;
+        }
+        memset(metadata, 0, sizeof(*metadata));
+        metadata->start_addr = part->offset;
+        memcpy(&metadata->image, p->data, sizeof(metadata->image));
+        metadata->image_len = p->image_len;
+        return ESP_OK;
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+// Sessões OTA (uma por vez, como basta aos testes)
+
+typedef struct {
+    esp_ota_handle_t handle;
+    const esp_partition_t *partition;
+    size_t wrote_size;
+    size_t erased_end;    // Prefixo apagado (somente escrita sequencial)
+    bool sequential;
+} fake_ota_session_t;
+
+static fake_ota_session_t s_session = {0};
+static esp_ota_handle_t s_next_handle = 1;
+
+static bool is_app_partition(const esp_partition_t *partition)
+{
+    return find_fake(partition) && partition->type == ESP_PARTITION_TYPE_APP;
+}
+
+static esp_err_t session_open(const esp_partition_t *partition, size_t erase_size, size_t offset,
+                              esp_ota_handle_t *out_handle)
+{
+    if (!is_app_partition(partition) || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (partition == esp_ota_get_running_partition()) {
+        return ESP_ERR_OTA_PARTITION_CONFLICT;
+    }
+    if (s_session.handle != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    bool sequential = erase_size == OTA_WITH_SEQUENTIAL_WRITES;
+    size_t erase_end = offset;
+    if (!sequential) {
+        erase_end = (erase_size == 0 || erase_size == OTA_SIZE_UNKNOWN) ?
+                    partition->size : offset + erase_size;
+    }
+    erase_end = (erase_end + FAKE_SECTOR_SIZE - 1) & ~(size_t)(FAKE_SECTOR_SIZE - 1);
+    if (erase_end > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // O setor do offset de retomada já contém dados gravados
+    size_t erase_start = (offset + FAKE_SECTOR_SIZE - 1) & ~(size_t)(FAKE_SECTOR_SIZE - 1);
+    if (!sequential && erase_end > erase_start) {
+        esp_err_t ret = esp_partition_erase_range(partition, erase_start, erase_end - erase_start);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    s_session.handle = s_next_handle++;
+    s_session.partition = partition;
+    s_session.wrote_size = offset;
+    s_session.erased_end = sequential ? erase_start : erase_end;
+    s_session.sequential = sequential;
+    *out_handle = s_session.handle;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+    return session_open(partition, image_size, 0, out_handle);
+}
+
+esp_err_t esp_ota_resume(const esp_partition_t *partition, size_t erase_size, size_t image_offset,
+                         esp_ota_handle_t *out_handle)
+{
+    if (image_offset == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return session_open(partition, erase_size, image_offset, out_handle);
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+    if (handle == 0 || handle != s_session.handle || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_session.wrote_size == 0 && size > 0 && ((const uint8_t *)data)[0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    if (size > s_session.partition->size - s_session.wrote_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    size_t end = s_session.wrote_size + size;
+    if (s_session.sequential && end > s_session.erased_end) {
+        size_t erase_end = (end + FAKE_SECTOR_SIZE - 1) & ~(size_t)(FAKE_SECTOR_SIZE - 1);
+        esp_err_t ret = esp_partition_erase_range(s_session.partition, s_session.erased_end,
+                                                  erase_end - s_session.erased_end);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        s_session.erased_end = erase_end;
+    }
+    
+    esp_err_t ret = esp_partition_write(s_session.partition, s_session.wrote_size, data, size);
+    if (ret == ESP_OK) {
+        s_session.wrote_size = end;
+    }
+    return ret;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+    if (handle == 0 || handle != s_session.handle) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // O handle é liberado mesmo em caso de erro
+    fake_partition_t *p = find_fake(s_session.partition);
+    size_t wrote_size = s_session.wrote_size;
+    memset(&s_session, 0, sizeof(s_session));
+    
+    if (wrote_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (p->data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+    if (handle == 0 || handle != s_session.handle) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memset(&s_session, 0, sizeof(s_session));
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+    fake_partition_t *p = find_fake(partition);
+    if (!p || partition->type != ESP_PARTITION_TYPE_APP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (p->data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    s_boot = partition;
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_ota_get_boot_partition(void)
+{
+    return s_boot ? s_boot : esp_ota_get_running_partition();
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+    // O "dispositivo" nunca reinicia: roda sempre a imagem de fábrica
+    return &find_by_label("factory")->info;
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+    const esp_partition_t *from = start_from ? start_from : esp_ota_get_running_partition();
+    const char *next = from->subtype == ESP_PARTITION_SUBTYPE_APP_OTA_0 ? "ota_1" : "ota_0";
+    return &find_by_label(next)->info;
+}
@@ -0,0 +1,373 @@
+/**
+ * @file freertos.c
+ * @brief FreeRTOS sobre pthreads
+ * 
+ * Cada objeto tem um mutex e uma condição; as esperas com ticks finitos
+ * usam pthread_cond_timedwait (1 tick = 1 ms).
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Seções críticas: um mutex recursivo para todo o "núcleo"
+static pthread_mutex_t s_critical;
+static pthread_once_t s_critical_once = PTHREAD_ONCE_INIT;
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    pthread_once(&s_critical_once, critical_init);
+    pthread_mutex_lock(&s_critical);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+/**
+ * @brief Esperar a condição até o prazo (portMAX_DELAY: sem prazo)
+ * 
+ * @return false se o prazo expirou
+ */
+static bool cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *deadline)
+{
+    if (!deadline) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+/**
+ * @brief Converter ticks em prazo absoluto (NULL para portMAX_DELAY)
+ */
+static const struct timespec *make_deadline(TickType_t ticks, struct timespec *ts)
+{
+    if (ticks == portMAX_DELAY) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Tasks
+
+struct fake_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_count;
+};
+
+static __thread struct fake_task *s_current = NULL;
+
+static struct fake_task *task_alloc(TaskFunction_t fn, void *arg)
+{
+    struct fake_task *task = calloc(1, sizeof(*task));
+    if (task) {
+        task->fn = fn;
+        task->arg = arg;
+        pthread_mutex_init(&task->lock, NULL);
+        pthread_cond_init(&task->notified, NULL);
+    }
+    return task;
+}
+
+static void *task_entry(void *param)
+{
+    s_current = param;
+    s_current->fn(s_current->arg);
+    // Uma task do FreeRTOS não retorna: vTaskDelete(NULL) encerra a thread
+    abort();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *created_task)
+{
+    struct fake_task *task = task_alloc(fn, arg);
+    if (!task) {
+        return pdFAIL;
+    }
+    
+    // O handle existe antes de a task começar a rodar, como no FreeRTOS
+    if (created_task) {
+        *created_task = task;
+    }
+    
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task && task != s_current) {
+        abort();
+    }
+    
+    // Como no FreeRTOS, o handle deixa de ser válido
+    struct fake_task *self = s_current;
+    s_current = NULL;
+    pthread_mutex_destroy(&self->lock);
+    pthread_cond_destroy(&self->notified);
+    free(self);
+    pthread_exit(NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    // Thread principal do teste: task criada no primeiro uso
+    if (!s_current) {
+        s_current = task_alloc(NULL, NULL);
+        s_current->thread = pthread_self();
+    }
+    return s_current;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct fake_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec ts;
+    const struct timespec *deadline = make_deadline(ticks, &ts);
+    
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_count == 0 && ticks != 0) {
+        if (!cond_wait(&task->notified, &task->lock, deadline)) {
+            break;
+        }
+    }
+    uint32_t count = task->notify_count;
+    if (count > 0) {
+        task->notify_count = clear_on_exit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify_count++;
+    pthread_cond_broadcast(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+// Filas
+
+struct fake_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct fake_queue *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size ? item_size : 1);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (!queue) {
+        return;
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->changed);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    struct timespec ts;
+    const struct timespec *deadline = make_deadline(ticks, &ts);
+    
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        if (ticks == 0 || !cond_wait(&queue->changed, &queue->lock, deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    if (queue->item_size > 0) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    struct timespec ts;
+    const struct timespec *deadline = make_deadline(ticks, &ts);
+    
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (ticks == 0 || !cond_wait(&queue->changed, &queue->lock, deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    if (queue->item_size > 0) {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    QueueHandle_t queue = xQueueCreate(1, 0);
+    if (queue) {
+        xQueueSend(queue, NULL, 0);
+    }
+    return queue;
+}
+
+// Event groups
+
+struct fake_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct fake_event_group *group = calloc(1, sizeof(*group));
+    if (group) {
+        pthread_mutex_init(&group->lock, NULL);
+        pthread_cond_init(&group->changed, NULL);
+    }
+    return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    if (!group) {
+        return;
+    }
+    pthread_mutex_destroy(&group->lock);
+    pthread_cond_destroy(&group->changed);
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t current = group->bits;
+    pthread_cond_broadcast(&group->changed);
+    pthread_mutex_unlock(&group->lock);
+    return current;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t current = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return current;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_for_all,
+                                TickType_t ticks)
+{
+    struct timespec ts;
+    const struct timespec *deadline = make_deadline(ticks, &ts);
+    
+    pthread_mutex_lock(&group->lock);
+    while (true) {
+        EventBits_t set = group->bits & bits;
+        bool done = wait_for_all ? set == bits : set != 0;
+        if (done || ticks == 0 || !cond_wait(&group->changed, &group->lock, deadline)) {
+            break;
+        }
+    }
+    EventBits_t current = group->bits;
+    bool done = wait_for_all ? (current & bits) == bits : (current & bits) != 0;
+    if (done && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return current;
+}
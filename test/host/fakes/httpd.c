@@ -0,0 +1,48 @@
+/**
+ * @file httpd.c
+ * @brief Respostas HTTP acumuladas em memória
+ */
+
+#include "esp_http_server.h"
+#include <stdlib.h>
+#include <string.h>
+
+static esp_err_t resp_append(httpd_req_t *r, const char *buf, size_t len)
+{
+    char *resp = realloc(r->resp, r->resp_len + len + 1);
+    if (!resp) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(resp + r->resp_len, buf, len);
+    r->resp = resp;
+    r->resp_len += len;
+    r->resp[r->resp_len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (!r || r->finished) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : (size_t)buf_len;
+    r->finished = true;
+    return resp_append(r, buf ? buf : "", buf ? len : 0);
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (!r || r->finished) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Bloco vazio encerra a resposta
+    if (!buf || buf_len == 0) {
+        r->finished = true;
+        return ESP_OK;
+    }
+    
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : (size_t)buf_len;
+    r->chunks++;
+    return resp_append(r, buf, len);
+}
@@ -0,0 +1,196 @@
+/**
+ * @file idf.c
+ * @brief Erros, log, relógio, timers, esp_random(), sistema e Wi-Fi falsos
+ */
+
+#include "fake_idf.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_wifi.h"
+#include "esp_system.h"
+#include "esp_app_format.h"
+#include "esp_image_format.h"
+#include "esp_ota_ops.h"
+#include "nvs.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                   return "ESP_OK";
+        case ESP_FAIL:                 return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION:  return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_INVALID_MAC:      return "ESP_ERR_INVALID_MAC";
+        case ESP_ERR_NOT_FINISHED:     return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NOT_ALLOWED:      return "ESP_ERR_NOT_ALLOWED";
+        case ESP_ERR_NVS_NOT_FOUND:    return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_OTA_VALIDATE_FAILED: return "ESP_ERR_OTA_VALIDATE_FAILED";
+        case ESP_ERR_IMAGE_INVALID:    return "ESP_ERR_IMAGE_INVALID";
+        default:                       return "UNKNOWN ERROR";
+    }
+}
+
+void fake_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > ESP_LOG_WARN && !getenv("HOST_TEST_VERBOSE")) {
+        return;
+    }
+    
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%s) ", letters[level], tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// Relógio
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Timers: disparados somente por fake_timer_fire()
+
+#define FAKE_TIMER_MAX 8
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool active;
+};
+
+static struct esp_timer s_timers[FAKE_TIMER_MAX];
+static int s_timer_count = 0;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    if (!args || !out_handle || !args->callback) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_timer_count == FAKE_TIMER_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    struct esp_timer *timer = &s_timers[s_timer_count++];
+    timer->args = *args;
+    timer->active = false;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    timer->active = false;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer->active;
+}
+
+bool fake_timer_fire(const char *name)
+{
+    for (int i = 0; i < s_timer_count; i++) {
+        struct esp_timer *timer = &s_timers[i];
+        if (timer->active && timer->args.name && strcmp(timer->args.name, name) == 0) {
+            timer->active = false;
+            timer->args.callback(timer->args.arg);
+            return true;
+        }
+    }
+    return false;
+}
+
+// esp_random(): xorshift32, reprodutível entre execuções
+
+static uint32_t s_random = 0x12345678;
+
+void fake_random_seed(uint32_t seed)
+{
+    s_random = seed ? seed : 0x12345678;
+}
+
+uint32_t esp_random(void)
+{
+    s_random ^= s_random << 13;
+    s_random ^= s_random >> 17;
+    s_random ^= s_random << 5;
+    return s_random;
+}
+
+// Wi-Fi
+
+static int s_wifi_connect_calls = 0;
+
+esp_err_t esp_wifi_connect(void)
+{
+    s_wifi_connect_calls++;
+    return ESP_OK;
+}
+
+int fake_wifi_connect_calls(void)
+{
+    return s_wifi_connect_calls;
+}
+
+// Sistema
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+void esp_restart(void)
+{
+    fprintf(stderr, "esp_restart() chamado durante o teste\n");
+    abort();
+}
+
+const esp_app_desc_t *esp_app_get_description(void)
+{
+    static const esp_app_desc_t desc = {
+        .magic_word = 0xABCD5432,
+        .version = "host-test",
+        .project_name = "webserver_at",
+        .idf_ver = "host",
+    };
+    return &desc;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file esp_crc.h
+ * @brief Incluído por ota_handler.c; nenhuma função de CRC é usada
+ */
+
+#ifndef FAKE_ESP_CRC_H
+#define FAKE_ESP_CRC_H
+
+#include <stdint.h>
+
+#endif // FAKE_ESP_CRC_H
@@ -0,0 +1,43 @@
+/**
+ * @file esp_err.h
+ * @brief esp_err_t e códigos de erro (mesmos valores do ESP-IDF)
+ */
+
+#ifndef FAKE_ESP_ERR_H
+#define FAKE_ESP_ERR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                   0
+#define ESP_FAIL                 -1
+#define ESP_ERR_NO_MEM           0x101
+#define ESP_ERR_INVALID_ARG      0x102
+#define ESP_ERR_INVALID_STATE    0x103
+#define ESP_ERR_INVALID_SIZE     0x104
+#define ESP_ERR_NOT_FOUND        0x105
+#define ESP_ERR_NOT_SUPPORTED    0x106
+#define ESP_ERR_TIMEOUT          0x107
+#define ESP_ERR_INVALID_RESPONSE 0x108
+#define ESP_ERR_INVALID_CRC      0x109
+#define ESP_ERR_INVALID_VERSION  0x10A
+#define ESP_ERR_INVALID_MAC      0x10B
+#define ESP_ERR_NOT_FINISHED     0x10C
+#define ESP_ERR_NOT_ALLOWED      0x10D
+
+const char *esp_err_to_name(esp_err_t code);
+
+#define ESP_ERROR_CHECK(x) do { \
+        esp_err_t err_ = (x); \
+        if (err_ != ESP_OK) { \
+            fprintf(stderr, "ESP_ERROR_CHECK: %s em %s:%d\n", esp_err_to_name(err_), __FILE__, __LINE__); \
+            abort(); \
+        } \
+    } while (0)
+
+#endif // FAKE_ESP_ERR_H
@@ -0,0 +1,24 @@
+/**
+ * @file esp_http_server.h
+ * @brief Requisição HTTP que acumula a resposta em memória
+ */
+
+#ifndef FAKE_ESP_HTTP_SERVER_H
+#define FAKE_ESP_HTTP_SERVER_H
+
+#include "esp_err.h"
+#include <sys/types.h>
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+typedef struct httpd_req {
+    char *resp;           // Corpo recebido até agora (terminado em zero)
+    size_t resp_len;
+    int chunks;           // Chamadas a httpd_resp_send_chunk() com dados
+    bool finished;
+} httpd_req_t;
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+
+#endif // FAKE_ESP_HTTP_SERVER_H
@@ -0,0 +1,28 @@
+/**
+ * @file esp_image_format.h
+ * @brief Metadados de imagem: só o tamanho da imagem carregada no teste
+ */
+
+#ifndef FAKE_ESP_IMAGE_FORMAT_H
+#define FAKE_ESP_IMAGE_FORMAT_H
+
+#include "esp_err.h"
+#include "esp_app_format.h"
+
+#define ESP_ERR_IMAGE_BASE    0x2000
+#define ESP_ERR_IMAGE_INVALID (ESP_ERR_IMAGE_BASE + 2)
+
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} esp_partition_pos_t;
+
+typedef struct {
+    uint32_t start_addr;
+    esp_image_header_t image;
+    uint32_t image_len;
+} esp_image_metadata_t;
+
+esp_err_t esp_image_get_metadata(const esp_partition_pos_t *part, esp_image_metadata_t *metadata);
+
+#endif // FAKE_ESP_IMAGE_FORMAT_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_random.h
+ * @brief Gerador pseudoaleatório determinístico (fake_random_seed())
+ */
+
+#ifndef FAKE_ESP_RANDOM_H
+#define FAKE_ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif // FAKE_ESP_RANDOM_H
@@ -0,0 +1,30 @@
+/**
+ * @file esp_system.h
+ * @brief Motivo do reset e reinício
+ */
+
+#ifndef FAKE_ESP_SYSTEM_H
+#define FAKE_ESP_SYSTEM_H
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason(void);
+
+// Nenhum teste deve reiniciar o "dispositivo": encerra o processo com erro
+void esp_restart(void) __attribute__((noreturn));
+
+#endif // FAKE_ESP_SYSTEM_H
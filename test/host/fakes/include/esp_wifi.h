@@ -0,0 +1,32 @@
+/**
+ * @file esp_wifi.h
+ * @brief Motivos de desconexão e esp_wifi_connect() (contado pelo teste)
+ */
+
+#ifndef FAKE_ESP_WIFI_H
+#define FAKE_ESP_WIFI_H
+
+#include "esp_err.h"
+
+// Mesmos valores de wifi_err_reason_t no ESP-IDF
+typedef enum {
+    WIFI_REASON_UNSPECIFIED                        = 1,
+    WIFI_REASON_AUTH_EXPIRE                        = 2,
+    WIFI_REASON_AUTH_LEAVE                         = 3,
+    WIFI_REASON_ASSOC_LEAVE                        = 8,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT             = 15,
+    WIFI_REASON_802_1X_AUTH_FAILED                 = 23,
+    WIFI_REASON_BEACON_TIMEOUT                     = 200,
+    WIFI_REASON_NO_AP_FOUND                        = 201,
+    WIFI_REASON_AUTH_FAIL                          = 202,
+    WIFI_REASON_ASSOC_FAIL                         = 203,
+    WIFI_REASON_HANDSHAKE_TIMEOUT                  = 204,
+    WIFI_REASON_CONNECTION_FAIL                    = 205,
+    WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY  = 210,
+    WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD  = 211,
+    WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD      = 212,
+} wifi_err_reason_t;
+
+esp_err_t esp_wifi_connect(void);
+
+#endif // FAKE_ESP_WIFI_H
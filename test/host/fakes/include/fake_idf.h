@@ -0,0 +1,68 @@
+/**
+ * @file fake_idf.h
+ * @brief Controle das implementações falsas do IDF pelos testes
+ */
+
+#ifndef FAKE_IDF_H
+#define FAKE_IDF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Reiniciar a sequência de esp_random()
+ */
+void fake_random_seed(uint32_t seed);
+
+/**
+ * @brief Disparar o timer com este nome, se estiver ativo
+ * 
+ * @return true se o callback foi executado
+ */
+bool fake_timer_fire(const char *name);
+
+/**
+ * @brief Chamadas a esp_wifi_connect() desde o início do processo
+ */
+int fake_wifi_connect_calls(void);
+
+/**
+ * @brief Restaurar a tabela de partições
+ * 
+ * Todas as partições voltam a um conteúdo não apagado, a de fábrica é a
+ * de execução e boot, e as operações deixam de ter tempo simulado.
+ */
+void fake_flash_reset(void);
+
+/**
+ * @brief Gravar uma imagem na partição (restante apagado)
+ * 
+ * O tamanho passa a ser o informado por esp_image_get_metadata().
+ */
+void fake_flash_load(const char *label, const uint8_t *image, size_t len);
+
+/**
+ * @brief Conteúdo atual da partição
+ */
+const uint8_t *fake_flash_data(const char *label);
+
+/**
+ * @brief Simular a duração das operações de flash
+ * 
+ * @param erase_us_per_sector Tempo de apagamento de cada setor de 4 KB
+ * @param write_us_per_kb Tempo de gravação por KB
+ */
+void fake_flash_set_timing(uint32_t erase_us_per_sector, uint32_t write_us_per_kb);
+
+/**
+ * @brief Bytes apagados desde fake_flash_reset()
+ */
+size_t fake_flash_erased_bytes(void);
+
+/**
+ * @brief Apagar todas as chaves do NVS
+ */
+void fake_nvs_reset(void);
+
+#endif // FAKE_IDF_H
@@ -0,0 +1,25 @@
+/**
+ * @file event_groups.h
+ * @brief Event groups do FreeRTOS
+ */
+
+#ifndef FAKE_FREERTOS_EVENT_GROUPS_H
+#define FAKE_FREERTOS_EVENT_GROUPS_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct fake_event_group *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+
+// Retorna os bits no momento em que a espera terminou (antes de limpar)
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_for_all,
+                                TickType_t ticks);
+
+#endif // FAKE_FREERTOS_EVENT_GROUPS_H
@@ -0,0 +1,19 @@
+/**
+ * @file semphr.h
+ * @brief Mutex do FreeRTOS (fila de um item, como no original)
+ */
+
+#ifndef FAKE_FREERTOS_SEMPHR_H
+#define FAKE_FREERTOS_SEMPHR_H
+
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+#define xSemaphoreTake(sem, ticks) xQueueReceive((sem), NULL, (ticks))
+#define xSemaphoreGive(sem)        xQueueSend((sem), NULL, 0)
+#define vSemaphoreDelete(sem)      vQueueDelete(sem)
+
+#endif // FAKE_FREERTOS_SEMPHR_H
@@ -0,0 +1,29 @@
+/**
+ * @file sha256.h
+ * @brief SHA-256 com a API do mbedTLS
+ * 
+ * O contexto não guarda ponteiros, então pode ser copiado com memcpy (o
+ * checkpoint OTA o persiste em NVS, como com a aceleração por hardware).
+ */
+
+#ifndef FAKE_MBEDTLS_SHA256_H
+#define FAKE_MBEDTLS_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t total;
+    uint8_t buffer[64];
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx);
+void mbedtls_sha256_clone(mbedtls_sha256_context *dst, const mbedtls_sha256_context *src);
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen);
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char output[32]);
+int mbedtls_sha256(const unsigned char *input, size_t ilen, unsigned char output[32], int is224);
+
+#endif // FAKE_MBEDTLS_SHA256_H
@@ -0,0 +1,41 @@
+/**
+ * @file miniz.h
+ * @brief tinfl_decompress() da ROM implementado sobre a zlib do host
+ * 
+ * Cobre o uso de ota_handler.c: stream deflate "raw" descomprimido numa
+ * janela circular (sem TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF), cujo
+ * tamanho é dado pelo espaço de saída da primeira chamada.
+ */
+
+#ifndef FAKE_MINIZ_H
+#define FAKE_MINIZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#define TINFL_FLAG_PARSE_ZLIB_HEADER 1
+#define TINFL_FLAG_HAS_MORE_INPUT    2
+
+typedef enum {
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct {
+    z_stream zs;
+    int initialized;
+} tinfl_decompressor;
+
+#define tinfl_init(r) do { (r)->initialized = 0; } while (0)
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *in_buf_next, size_t *in_buf_size,
+                              uint8_t *out_buf_start, uint8_t *out_buf_next, size_t *out_buf_size,
+                              uint32_t decomp_flags);
+
+#endif // FAKE_MINIZ_H
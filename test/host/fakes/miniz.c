@@ -0,0 +1,64 @@
+/**
+ * @file miniz.c
+ * @brief tinfl_decompress() sobre a zlib do host
+ * 
+ * A zlib mantém a própria janela de histórico; o buffer circular de
+ * ota_handler.c recebe apenas a saída, como acontece com o tinfl.
+ */
+
+#include "miniz.h"
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const uint8_t *in_buf_next, size_t *in_buf_size,
+                              uint8_t *out_buf_start, uint8_t *out_buf_next, size_t *out_buf_size,
+                              uint32_t decomp_flags)
+{
+    if (!r->initialized) {
+        // A janela é o buffer de saída inteiro (potência de 2)
+        size_t dict_size = (size_t)(out_buf_next - out_buf_start) + *out_buf_size;
+        int window_bits = 0;
+        while (((size_t)1 << window_bits) < dict_size) {
+            window_bits++;
+        }
+        if (((size_t)1 << window_bits) != dict_size || window_bits < 8 || window_bits > 15 ||
+            (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER)) {
+            *in_buf_size = 0;
+            *out_buf_size = 0;
+            return TINFL_STATUS_BAD_PARAM;
+        }
+        
+        r->zs = (z_stream){0};
+        if (inflateInit2(&r->zs, -window_bits) != Z_OK) {
+            *in_buf_size = 0;
+            *out_buf_size = 0;
+            return TINFL_STATUS_FAILED;
+        }
+        r->initialized = 1;
+    }
+    
+    size_t in_avail = *in_buf_size;
+    size_t out_avail = *out_buf_size;
+    r->zs.next_in = (Bytef *)in_buf_next;
+    r->zs.avail_in = (uInt)in_avail;
+    r->zs.next_out = out_buf_next;
+    r->zs.avail_out = (uInt)out_avail;
+    
+    int ret = inflate(&r->zs, Z_NO_FLUSH);
+    *in_buf_size = in_avail - r->zs.avail_in;
+    *out_buf_size = out_avail - r->zs.avail_out;
+    
+    if (ret == Z_STREAM_END) {
+        inflateEnd(&r->zs);
+        r->initialized = 0;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        inflateEnd(&r->zs);
+        r->initialized = 0;
+        return TINFL_STATUS_FAILED;
+    }
+    if (r->zs.avail_out == 0) {
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+    }
+    return (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT :
+                                                        TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
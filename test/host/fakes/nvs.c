@@ -0,0 +1,153 @@
+/**
+ * @file nvs.c
+ * @brief NVS em memória: blobs por namespace, perdidos ao fim do processo
+ */
+
+#include "fake_idf.h"
+#include "nvs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FAKE_NVS_MAX_ENTRIES    16
+#define FAKE_NVS_MAX_NAMESPACES 8
+
+typedef struct {
+    char namespace_name[16];
+    char key[16];
+    uint8_t *value;
+    size_t length;
+} fake_nvs_entry_t;
+
+static fake_nvs_entry_t s_entries[FAKE_NVS_MAX_ENTRIES];
+
+// Handle = índice + 1 na tabela de namespaces abertos
+static char s_namespaces[FAKE_NVS_MAX_NAMESPACES][16];
+static int s_namespace_count = 0;
+
+void fake_nvs_reset(void)
+{
+    for (int i = 0; i < FAKE_NVS_MAX_ENTRIES; i++) {
+        free(s_entries[i].value);
+    }
+    memset(s_entries, 0, sizeof(s_entries));
+}
+
+static const char *handle_namespace(nvs_handle_t handle)
+{
+    return (handle >= 1 && handle <= (nvs_handle_t)s_namespace_count) ? s_namespaces[handle - 1] : NULL;
+}
+
+static fake_nvs_entry_t *find_entry(const char *namespace_name, const char *key)
+{
+    for (int i = 0; i < FAKE_NVS_MAX_ENTRIES; i++) {
+        fake_nvs_entry_t *e = &s_entries[i];
+        if (e->value && strcmp(e->namespace_name, namespace_name) == 0 &&
+            (!key || strcmp(e->key, key) == 0)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (!namespace_name || !out_handle || strlen(namespace_name) >= sizeof(s_namespaces[0])) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Como no IDF, um namespace só passa a existir depois da primeira escrita
+    if (open_mode == NVS_READONLY && !find_entry(namespace_name, NULL)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    
+    for (int i = 0; i < s_namespace_count; i++) {
+        if (strcmp(s_namespaces[i], namespace_name) == 0) {
+            *out_handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    if (s_namespace_count == FAKE_NVS_MAX_NAMESPACES) {
+        return ESP_ERR_NO_MEM;
+    }
+    strcpy(s_namespaces[s_namespace_count++], namespace_name);
+    *out_handle = s_namespace_count;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    const char *namespace_name = handle_namespace(handle);
+    if (!namespace_name || !key || !length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    fake_nvs_entry_t *e = find_entry(namespace_name, key);
+    if (!e) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (!out_value) {
+        *length = e->length;
+        return ESP_OK;
+    }
+    if (*length < e->length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(out_value, e->value, e->length);
+    *length = e->length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    const char *namespace_name = handle_namespace(handle);
+    if (!namespace_name || !key || !value || strlen(key) >= sizeof(s_entries[0].key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    fake_nvs_entry_t *e = find_entry(namespace_name, key);
+    for (int i = 0; !e && i < FAKE_NVS_MAX_ENTRIES; i++) {
+        if (!s_entries[i].value) {
+            e = &s_entries[i];
+        }
+    }
+    if (!e) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    uint8_t *copy = malloc(length ? length : 1);
+    if (!copy) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, value, length);
+    free(e->value);
+    strcpy(e->namespace_name, namespace_name);
+    strcpy(e->key, key);
+    e->value = copy;
+    e->length = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    const char *namespace_name = handle_namespace(handle);
+    if (!namespace_name || !key) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    fake_nvs_entry_t *e = find_entry(namespace_name, key);
+    if (!e) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(e->value);
+    memset(e, 0, sizeof(*e));
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return handle_namespace(handle) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
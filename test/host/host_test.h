@@ -0,0 +1,47 @@
+/**
+ * @file host_test.h
+ * @brief Verificações dos testes no host
+ * 
+ * Uma verificação que falha imprime arquivo, linha e valores e encerra o
+ * processo com erro, o que o ctest registra como falha do teste.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+        long long actual_ = (long long)(actual); \
+        long long expected_ = (long long)(expected); \
+        if (actual_ != expected_) { \
+            fprintf(stderr, "%s:%d: falhou: %s == %s (%lld != %lld)\n", \
+                    __FILE__, __LINE__, #actual, #expected, actual_, expected_); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_RANGE(value, min, max) do { \
+        long long value_ = (long long)(value); \
+        if (value_ < (long long)(min) || value_ > (long long)(max)) { \
+            fprintf(stderr, "%s:%d: falhou: %s = %lld fora de [%lld, %lld]\n", \
+                    __FILE__, __LINE__, #value, value_, (long long)(min), (long long)(max)); \
+            exit(1); \
+        } \
+    } while (0)
+
+// Executar um caso de teste, com o nome no log
+#define RUN_TEST(fn) do { \
+        printf("%s\n", #fn); \
+        fn(); \
+    } while (0)
+
+#endif // HOST_TEST_H
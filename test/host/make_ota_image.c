@@ -0,0 +1,56 @@
+/**
+ * @file make_ota_image.c
+ * @brief Gravar em arquivo uma imagem sintética de ota_test_image()
+ * 
+ * Entrada das ferramentas de tools/ nos testes de contêiner e patch:
+ * 
+ *   make_ota_image saida.bin KB seed
+ *   make_ota_image saida.bin --update base.bin seed   (nova versão de base.bin)
+ */
+
+#include "ota_test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    if (argc != 4 && !(argc == 5 && strcmp(argv[2], "--update") == 0)) {
+        fprintf(stderr, "uso: %s saida.bin KB seed\n"
+                        "     %s saida.bin --update base.bin seed\n", argv[0], argv[0]);
+        return 1;
+    }
+    
+    uint8_t *image;
+    size_t size;
+    if (argc == 5) {
+        FILE *f = fopen(argv[3], "rb");
+        if (!f) {
+            perror(argv[3]);
+            return 1;
+        }
+        fseek(f, 0, SEEK_END);
+        size_t base_len = (size_t)ftell(f);
+        fseek(f, 0, SEEK_SET);
+        uint8_t *base = malloc(base_len);
+        if (!base || fread(base, 1, base_len, f) != base_len) {
+            perror(argv[3]);
+            return 1;
+        }
+        fclose(f);
+        image = ota_test_image_update(base, base_len, (uint32_t)strtoul(argv[4], NULL, 0), &size);
+        free(base);
+    } else {
+        size = (size_t)atoi(argv[2]) * 1024;
+        image = ota_test_image(size, (uint32_t)strtoul(argv[3], NULL, 0));
+    }
+    
+    FILE *f = fopen(argv[1], "wb");
+    if (!f || fwrite(image, 1, size, f) != size || fclose(f) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    
+    free(image);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file ota_test_util.c
+ * @brief Imagens sintéticas e envio em streaming para os testes de OTA
+ */
+
+#include "ota_test_util.h"
+#include "host_test.h"
+#include "fake_idf.h"
+#include "ota_handler.h"
+#include "esp_app_format.h"
+#include "mbedtls/sha256.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void ota_test_setup(void)
+{
+    fake_flash_reset();
+    fake_nvs_reset();
+    ota_set_pre_erase_enabled(false);
+    ESP_ERROR_CHECK(init_ota_handler());
+}
+
+void ota_test_wait_erase_idle(void)
+{
+    ota_progress_t progress;
+    for (int i = 0; i < 5000; i++) {
+        ota_get_progress(&progress);
+        if (!progress.erase_in_progress) {
+            return;
+        }
+        usleep(1000);
+    }
+    CHECK(!progress.erase_in_progress);
+}
+
+void ota_test_sha256(const uint8_t *data, size_t len, uint8_t out[32])
+{
+    mbedtls_sha256(data, len, out, 0);
+}
+
+uint8_t *ota_test_image(size_t size, uint32_t seed)
+{
+    if (size < sizeof(esp_image_header_t) + OTA_SHA256_SIZE) {
+        abort();
+    }
+    
+    uint8_t *image = malloc(size);
+    if (!image) {
+        abort();
+    }
+    
+    uint32_t x = seed ? seed : 1;
+    size_t body_end = size - OTA_SHA256_SIZE;
+    for (size_t i = 0; i < body_end; ) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        
+        // Trechos de até 64 bytes: cópia de dados anteriores ou aleatórios
+        size_t run = 1 + (x & 63);
+        if (run > body_end - i) {
+            run = body_end - i;
+        }
+        size_t back = 1 + ((x >> 8) & 1023);
+        if ((x >> 20) & 1 && back <= i) {
+            for (size_t k = 0; k < run; k++) {
+                image[i + k] = image[i + k - back];
+            }
+        } else {
+            for (size_t k = 0; k < run; k++) {
+                image[i + k] = (uint8_t)((x >> ((k % 4) * 8)) + k);
+            }
+        }
+        i += run;
+    }
+    
+    esp_image_header_t header = {0};
+    header.magic = ESP_IMAGE_HEADER_MAGIC;
+    header.segment_count = 3;
+    header.entry_addr = 0x40800000;
+    header.hash_appended = 1;
+    memcpy(image, &header, sizeof(header));
+    
+    ota_test_sha256(image, body_end, image + body_end);
+    return image;
+}
+
+uint8_t *ota_test_image_update(const uint8_t *base, size_t base_len, uint32_t seed, size_t *out_len)
+{
+    // Uma alteração, uma inserção e uma remoção em cada quarto da imagem
+    const size_t changed = 200, inserted = 1000, removed = 500;
+    size_t body_len = base_len - OTA_SHA256_SIZE;
+    size_t len = base_len + 4 * (inserted - removed);
+    uint8_t *image = malloc(len);
+    if (!image || body_len < 4 * 4096) {
+        abort();
+    }
+    
+    uint32_t x = seed ? seed : 1;
+    size_t src = 0, dst = 0;
+    for (int part = 0; part < 4; part++) {
+        size_t end = body_len * (part + 1) / 4;
+        size_t edit = src + 1024 + (x % 1024);
+        
+        // Trecho inalterado, depois bytes alterados no lugar
+        memcpy(image + dst, base + src, edit - src);
+        dst += edit - src;
+        src = edit;
+        for (size_t k = 0; k < changed; k++) {
+            image[dst++] = base[src++] ^ (uint8_t)(x >> (k % 24));
+        }
+        
+        // Bytes novos e, mais adiante, um trecho removido
+        for (size_t k = 0; k < inserted; k++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            image[dst++] = (uint8_t)x;
+        }
+        size_t cut = src + (end - src) / 2;
+        memcpy(image + dst, base + src, cut - src);
+        dst += cut - src;
+        src = cut + removed;
+        memcpy(image + dst, base + src, end - src);
+        dst += end - src;
+        src = end;
+    }
+    
+    ota_test_sha256(image, dst, image + dst);
+    *out_len = dst + OTA_SHA256_SIZE;
+    return image;
+}
+
+esp_err_t ota_test_stream(const uint8_t *data, size_t len, const size_t *chunks, size_t chunk_count)
+{
+    size_t index = 0;
+    while (len > 0) {
+        size_t n = chunk_count > 0 ? chunks[index++ % chunk_count] : OTA_STREAM_CHUNK_SIZE;
+        if (n > len) {
+            n = len;
+        }
+        
+        esp_err_t ret = ota_write_data(data, n);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ota_test_stream_pipelined(const uint8_t *data, size_t len, uint32_t recv_us)
+{
+    esp_err_t ret = ota_pipeline_begin();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    while (len > 0) {
+        uint8_t *buffer = NULL;
+        size_t capacity = 0;
+        ret = ota_pipeline_get_buffer(&buffer, &capacity);
+        if (ret != ESP_OK) {
+            break;
+        }
+        
+        size_t n = len < capacity ? len : capacity;
+        if (recv_us > 0) {
+            usleep(recv_us);
+        }
+        memcpy(buffer, data, n);
+        ota_pipeline_submit(buffer, n);
+        data += n;
+        len -= n;
+    }
+    
+    esp_err_t end_ret = ota_pipeline_end(false);
+    return (ret != ESP_OK) ? ret : end_ret;
+}
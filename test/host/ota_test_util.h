@@ -0,0 +1,68 @@
+/**
+ * @file ota_test_util.h
+ * @brief Imagens sintéticas e envio em streaming para os testes de OTA
+ */
+
+#ifndef OTA_TEST_UTIL_H
+#define OTA_TEST_UTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Preparar um "dispositivo" novo
+ * 
+ * Flash e NVS restaurados, pré-apagamento desabilitado e handler OTA
+ * inicializado, rodando a partição de fábrica.
+ */
+void ota_test_setup(void);
+
+/**
+ * @brief Aguardar o fim do pré-apagamento em segundo plano
+ */
+void ota_test_wait_erase_idle(void);
+
+/**
+ * @brief Gerar uma imagem sintética com cabeçalho e hash anexado válidos
+ * 
+ * O conteúdo mistura trechos repetidos e aleatórios (compressível, como um
+ * binário real) e é determinado por seed. Liberar com free().
+ */
+uint8_t *ota_test_image(size_t size, uint32_t seed);
+
+/**
+ * @brief Gerar uma "nova versão" de uma imagem, como uma atualização típica
+ * 
+ * Poucas regiões são alteradas, inseridas ou removidas; o restante é
+ * igual à base, deslocado pelas inserções. Cabeçalho e hash anexado são
+ * refeitos. Liberar com free().
+ * 
+ * @param out_len Tamanho da nova imagem
+ */
+uint8_t *ota_test_image_update(const uint8_t *base, size_t base_len, uint32_t seed, size_t *out_len);
+
+/**
+ * @brief SHA-256 de um buffer
+ */
+void ota_test_sha256(const uint8_t *data, size_t len, uint8_t out[32]);
+
+/**
+ * @brief Enviar dados com ota_write_data(), como o upload em série
+ * 
+ * Os tamanhos de bloco são usados em ciclo; sem tamanhos, blocos de
+ * OTA_STREAM_CHUNK_SIZE.
+ * 
+ * @return Primeiro erro de ota_write_data()
+ */
+esp_err_t ota_test_stream(const uint8_t *data, size_t len, const size_t *chunks, size_t chunk_count);
+
+/**
+ * @brief Enviar dados pelo pipeline de gravação, como o upload em pipeline
+ * 
+ * @param recv_us Tempo simulado de recepção de cada buffer (0 = nenhum)
+ * @return Primeiro erro do pipeline
+ */
+esp_err_t ota_test_stream_pipelined(const uint8_t *data, size_t len, uint32_t recv_us);
+
+#endif // OTA_TEST_UTIL_H
@@ -0,0 +1,174 @@
+/**
+ * @file test_ota_delta.c
+ * @brief Patches de tools/ota_delta.py aplicados pelo firmware sobre a partição em execução
+ * 
+ *   test_ota_delta origem.bin nova.bin patch.odlt patch_comprimido.otaz
+ * 
+ * A origem é carregada na partição de fábrica (em execução) e o patch é
+ * gravado em ota_0, que deve ficar igual à nova imagem.
+ */
+
+#include "host_test.h"
+#include "fake_idf.h"
+#include "ota_test_util.h"
+#include "ota_handler.h"
+#include "esp_ota_ops.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} file_t;
+
+static file_t s_old;
+static file_t s_new;
+
+static file_t read_file(const char *path)
+{
+    file_t file = {0};
+    FILE *f = fopen(path, "rb");
+    CHECK(f != NULL);
+    fseek(f, 0, SEEK_END);
+    file.len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    file.data = malloc(file.len);
+    CHECK(file.data != NULL);
+    CHECK_EQ(fread(file.data, 1, file.len, f), file.len);
+    fclose(f);
+    return file;
+}
+
+// Dispositivo rodando a imagem de origem
+static void setup_running_old(void)
+{
+    ota_test_setup();
+    fake_flash_load("factory", s_old.data, s_old.len);
+}
+
+static void check_installed(void)
+{
+    CHECK(memcmp(fake_flash_data("ota_0"), s_new.data, s_new.len) == 0);
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "ota_0") == 0);
+    CHECK(!ota_is_upgrading());
+    
+    // A origem é só lida
+    CHECK(memcmp(fake_flash_data("factory"), s_old.data, s_old.len) == 0);
+}
+
+static void check_rejected(void)
+{
+    CHECK(!ota_is_upgrading());
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "factory") == 0);
+}
+
+static void test_apply(const file_t *patch)
+{
+    // Blocos que cortam cabeçalho, registros de controle e trechos de diff
+    static const size_t chunks[] = { 3, 45, 11, 4096, 1, 1024, 65536, 13 };
+    uint8_t sha[OTA_SHA256_SIZE];
+    ota_test_sha256(s_new.data, s_new.len, sha);
+    
+    setup_running_old();
+    CHECK_EQ(ota_begin_streaming(NULL, patch->len), ESP_OK);
+    CHECK_EQ(ota_set_expected_sha256(sha), ESP_OK);
+    CHECK_EQ(ota_test_stream(patch->data, patch->len, chunks, sizeof(chunks) / sizeof(chunks[0])), ESP_OK);
+    check_installed();
+    
+    setup_running_old();
+    CHECK_EQ(ota_begin_streaming(NULL, patch->len), ESP_OK);
+    CHECK_EQ(ota_test_stream_pipelined(patch->data, patch->len, 0), ESP_OK);
+    check_installed();
+    
+    // Pré-apagamento ampliado para o tamanho da nova imagem
+    setup_running_old();
+    ota_set_pre_erase_enabled(true);
+    CHECK_EQ(ota_begin_streaming(NULL, patch->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(patch->data, patch->len, NULL, 0), ESP_OK);
+    check_installed();
+    ota_test_wait_erase_idle();
+}
+
+static void test_wrong_source(const file_t *patch)
+{
+    // Patch gerado para outra imagem: SHA-256 da origem diferente
+    uint8_t *data = malloc(patch->len);
+    CHECK(data != NULL);
+    memcpy(data, patch->data, patch->len);
+    data[16] ^= 1;
+    
+    setup_running_old();
+    CHECK_EQ(ota_begin_streaming(NULL, patch->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(data, patch->len, NULL, 0), ESP_ERR_INVALID_VERSION);
+    check_rejected();
+    free(data);
+}
+
+/**
+ * @brief Montar um patch com um registro: diff_len, extra_len, seek
+ */
+static size_t build_patch(uint8_t *out, uint32_t new_size, const uint32_t *ctrl, size_t ctrl_count)
+{
+    memcpy(out, OTA_DELTA_MAGIC, 4);
+    memset(out + 4, 0, 4);
+    out[4] = OTA_DELTA_VERSION;
+    memcpy(out + 8, &new_size, 4);
+    uint32_t old_size = (uint32_t)s_old.len;
+    memcpy(out + 12, &old_size, 4);
+    ota_test_sha256(s_old.data, s_old.len, out + 16);
+    
+    // Cada registro só com diff zero: copia a origem
+    size_t len = OTA_DELTA_HEADER_SIZE;
+    for (size_t i = 0; i < ctrl_count; i++) {
+        memcpy(out + len, &ctrl[i * 3], 12);
+        len += 12;
+        memset(out + len, 0, ctrl[i * 3]);
+        len += ctrl[i * 3];
+    }
+    return len;
+}
+
+static void test_out_of_bounds(void)
+{
+    uint8_t patch[256];
+    
+    // Segundo registro lê depois do fim da origem
+    const uint32_t past_source[] = { 16, 0, (uint32_t)s_old.len, 16, 0, 0 };
+    size_t len = build_patch(patch, 32, past_source, 2);
+    setup_running_old();
+    CHECK_EQ(ota_begin_streaming(NULL, len), ESP_OK);
+    CHECK_EQ(ota_test_stream(patch, len, NULL, 0), ESP_ERR_INVALID_SIZE);
+    check_rejected();
+    
+    // Registro maior que a nova imagem
+    const uint32_t too_long[] = { 33, 0, 0 };
+    len = build_patch(patch, 32, too_long, 1);
+    setup_running_old();
+    CHECK_EQ(ota_begin_streaming(NULL, len), ESP_OK);
+    CHECK_EQ(ota_test_stream(patch, len, NULL, 0), ESP_ERR_INVALID_SIZE);
+    check_rejected();
+}
+
+int main(int argc, char **argv)
+{
+    CHECK_EQ(argc, 5);
+    s_old = read_file(argv[1]);
+    s_new = read_file(argv[2]);
+    
+    for (int i = 3; i < argc; i++) {
+        file_t patch = read_file(argv[i]);
+        printf("%s: %u bytes para uma imagem de %u bytes\n", argv[i],
+               (unsigned)patch.len, (unsigned)s_new.len);
+        test_apply(&patch);
+        free(patch.data);
+    }
+    
+    file_t patch = read_file(argv[3]);
+    test_wrong_source(&patch);
+    free(patch.data);
+    test_out_of_bounds();
+    
+    free(s_old.data);
+    free(s_new.data);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_ota_pack.c
+ * @brief Contêineres OTAZ de tools/ota_pack.py descomprimidos pelo firmware
+ * 
+ *   test_ota_pack imagem.bin contêiner.otaz...
+ * 
+ * Cada contêiner (um por --window-bits) é gravado em série com blocos
+ * irregulares e pelo pipeline, e a partição deve ficar igual à imagem.
+ */
+
+#include "host_test.h"
+#include "fake_idf.h"
+#include "ota_test_util.h"
+#include "ota_handler.h"
+#include "esp_ota_ops.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} file_t;
+
+static file_t read_file(const char *path)
+{
+    file_t file = {0};
+    FILE *f = fopen(path, "rb");
+    CHECK(f != NULL);
+    fseek(f, 0, SEEK_END);
+    file.len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    file.data = malloc(file.len);
+    CHECK(file.data != NULL);
+    CHECK_EQ(fread(file.data, 1, file.len, f), file.len);
+    fclose(f);
+    return file;
+}
+
+static void check_installed(const file_t *image, const file_t *pack)
+{
+    CHECK(memcmp(fake_flash_data("ota_0"), image->data, image->len) == 0);
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "ota_0") == 0);
+    
+    // O progresso conta os bytes transferidos, não os descomprimidos
+    ota_progress_t progress;
+    ota_get_progress(&progress);
+    CHECK(!progress.in_progress);
+    CHECK_EQ(progress.bytes_written, pack->len);
+    CHECK_EQ(progress.percentage, 100);
+}
+
+static void check_rejected(void)
+{
+    CHECK(!ota_is_upgrading());
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "factory") == 0);
+}
+
+static void test_round_trip(const file_t *image, const file_t *pack)
+{
+    // Blocos que cortam o cabeçalho do contêiner e o stream deflate
+    static const size_t chunks[] = { 1, 5, 6, 4096, 17, 65536, 4095, 2 };
+    uint8_t sha[OTA_SHA256_SIZE];
+    ota_test_sha256(image->data, image->len, sha);
+    
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_set_expected_sha256(sha), ESP_OK);
+    CHECK_EQ(ota_test_stream(pack->data, pack->len, chunks, sizeof(chunks) / sizeof(chunks[0])), ESP_OK);
+    check_installed(image, pack);
+    
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_test_stream_pipelined(pack->data, pack->len, 0), ESP_OK);
+    check_installed(image, pack);
+    
+    // Pré-apagamento ampliado para o tamanho descomprimido
+    ota_test_setup();
+    ota_set_pre_erase_enabled(true);
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(pack->data, pack->len, NULL, 0), ESP_OK);
+    check_installed(image, pack);
+    ota_test_wait_erase_idle();
+}
+
+static void test_truncated(const file_t *pack)
+{
+    // O último bloco chega sem o fim do stream deflate
+    ota_test_setup();
+    size_t len = pack->len - 16;
+    CHECK_EQ(ota_begin_streaming(NULL, len), ESP_OK);
+    CHECK_EQ(ota_test_stream(pack->data, len, NULL, 0), ESP_ERR_INVALID_RESPONSE);
+    check_rejected();
+}
+
+static void test_trailing_data(const file_t *pack)
+{
+    uint8_t *data = malloc(pack->len + 8);
+    CHECK(data != NULL);
+    memcpy(data, pack->data, pack->len);
+    memset(data + pack->len, 0, 8);
+    
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len + 8), ESP_OK);
+    CHECK_EQ(ota_test_stream(data, pack->len + 8, NULL, 0), ESP_ERR_INVALID_SIZE);
+    check_rejected();
+    free(data);
+}
+
+static void test_bad_header(const file_t *pack)
+{
+    uint8_t *data = malloc(pack->len);
+    CHECK(data != NULL);
+    
+    // Janela maior que OTA_PACK_MAX_WINDOW_BITS
+    memcpy(data, pack->data, pack->len);
+    data[5] = OTA_PACK_MAX_WINDOW_BITS + 1;
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(data, pack->len, NULL, 0), ESP_ERR_NOT_SUPPORTED);
+    check_rejected();
+    
+    // Versão desconhecida
+    memcpy(data, pack->data, pack->len);
+    data[4] = OTA_PACK_VERSION + 1;
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(data, pack->len, NULL, 0), ESP_ERR_NOT_SUPPORTED);
+    check_rejected();
+    
+    // Tamanho descomprimido maior que a partição
+    memcpy(data, pack->data, pack->len);
+    data[10] = 0x20;
+    ota_test_setup();
+    CHECK_EQ(ota_begin_streaming(NULL, pack->len), ESP_OK);
+    CHECK_EQ(ota_test_stream(data, pack->len, NULL, 0), ESP_ERR_INVALID_SIZE);
+    check_rejected();
+    free(data);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(argc >= 3);
+    file_t image = read_file(argv[1]);
+    
+    for (int i = 2; i < argc; i++) {
+        file_t pack = read_file(argv[i]);
+        CHECK(memcmp(pack.data, OTA_PACK_MAGIC, 4) == 0);
+        printf("%s: janela de %u bytes, %u -> %u bytes\n", argv[i], 1u << pack.data[5],
+               (unsigned)pack.len, (unsigned)image.len);
+        
+        test_round_trip(&image, &pack);
+        test_truncated(&pack);
+        free(pack.data);
+    }
+    
+    // Casos de erro com o primeiro contêiner
+    file_t pack = read_file(argv[2]);
+    test_trailing_data(&pack);
+    test_bad_header(&pack);
+    free(pack.data);
+    free(image.data);
+    return 0;
+}
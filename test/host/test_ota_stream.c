@@ -0,0 +1,218 @@
+/**
+ * @file test_ota_stream.c
+ * @brief Imagem sintética gravada em streaming: série, pipeline, pré-apagamento e retomada
+ * 
+ * Cada caso percorre begin_upgrade → ota_write_data → content_write →
+ * image_write sobre a flash falsa e confere o conteúdo da partição, a
+ * partição de boot e o progresso publicado.
+ */
+
+#include "host_test.h"
+#include "fake_idf.h"
+#include "ota_test_util.h"
+#include "ota_handler.h"
+#include "esp_ota_ops.h"
+#include <string.h>
+
+#define IMAGE_SIZE (300 * 1024 + 123)
+
+// Imagem gravada por inteiro em ota_0, que passa a ser a partição de boot
+static void check_installed(const uint8_t *image, size_t len)
+{
+    CHECK(memcmp(fake_flash_data("ota_0"), image, len) == 0);
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "ota_0") == 0);
+    
+    ota_progress_t progress;
+    ota_get_progress(&progress);
+    CHECK(!progress.in_progress);
+    CHECK_EQ(progress.bytes_written, len);
+    CHECK_EQ(progress.total_bytes, len);
+    CHECK_EQ(progress.percentage, 100);
+    CHECK(strcmp(progress.status_message, "Upgrade concluído com sucesso") == 0);
+    CHECK(!ota_is_upgrading());
+}
+
+// Upgrade rejeitado: sessão encerrada e boot inalterado
+static void check_rejected(void)
+{
+    CHECK(!ota_is_upgrading());
+    CHECK(strcmp(esp_ota_get_boot_partition()->label, "factory") == 0);
+    
+    ota_progress_t progress;
+    ota_get_progress(&progress);
+    CHECK(!progress.in_progress);
+}
+
+static void test_serial_chunks(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 1);
+    
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK(ota_is_upgrading());
+    CHECK_EQ(ota_test_stream(image, IMAGE_SIZE, NULL, 0), ESP_OK);
+    check_installed(image, IMAGE_SIZE);
+    
+    // Sem pré-apagamento, esp_ota_begin() apaga a partição inteira
+    CHECK_EQ(fake_flash_erased_bytes(), esp_ota_get_next_update_partition(NULL)->size);
+    free(image);
+}
+
+static void test_odd_chunks(void)
+{
+    // Blocos que cortam o cabeçalho, o hash anexado e os setores em
+    // qualquer posição
+    static const size_t chunks[] = { 1, 7, 23, 4095, 4097, 13, 65536, 3 };
+    
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 2);
+    uint8_t sha[OTA_SHA256_SIZE];
+    ota_test_sha256(image, IMAGE_SIZE, sha);
+    
+    CHECK_EQ(ota_begin_streaming("ota_0", IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_set_expected_sha256(sha), ESP_OK);
+    CHECK_EQ(ota_test_stream(image, IMAGE_SIZE, chunks, sizeof(chunks) / sizeof(chunks[0])), ESP_OK);
+    check_installed(image, IMAGE_SIZE);
+    free(image);
+}
+
+static void test_pipelined(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 3);
+    
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_test_stream_pipelined(image, IMAGE_SIZE, 0), ESP_OK);
+    check_installed(image, IMAGE_SIZE);
+    free(image);
+}
+
+static void test_pre_erase_raw_write(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 4);
+    
+    // Flash lenta: a gravação alcança o apagamento e precisa esperar por ele
+    fake_flash_set_timing(200, 0);
+    ota_set_pre_erase_enabled(true);
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_test_stream_pipelined(image, IMAGE_SIZE, 0), ESP_OK);
+    check_installed(image, IMAGE_SIZE);
+    ota_test_wait_erase_idle();
+    
+    // Somente os setores ocupados pela imagem são apagados
+    size_t sectors = (IMAGE_SIZE + 4095) / 4096;
+    CHECK_EQ(fake_flash_erased_bytes(), sectors * 4096);
+    free(image);
+}
+
+static void test_expected_sha_mismatch(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 5);
+    uint8_t sha[OTA_SHA256_SIZE];
+    ota_test_sha256(image, IMAGE_SIZE, sha);
+    sha[0] ^= 1;
+    
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_set_expected_sha256(sha), ESP_OK);
+    CHECK_EQ(ota_test_stream(image, IMAGE_SIZE, NULL, 0), ESP_ERR_INVALID_CRC);
+    check_rejected();
+    free(image);
+}
+
+static void test_appended_hash_mismatch(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 6);
+    image[IMAGE_SIZE / 2] ^= 0x40;
+    
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_test_stream(image, IMAGE_SIZE, NULL, 0), ESP_ERR_INVALID_CRC);
+    check_rejected();
+    free(image);
+}
+
+static void test_bad_magic(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 7);
+    image[0] = 0x00;
+    
+    // Rejeitada já no primeiro bloco
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_write_data(image, OTA_STREAM_CHUNK_SIZE), ESP_ERR_INVALID_CRC);
+    check_rejected();
+    CHECK_EQ(ota_write_data(image, OTA_STREAM_CHUNK_SIZE), ESP_ERR_INVALID_STATE);
+    free(image);
+}
+
+static void test_oversize(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 8);
+    
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE - 1), ESP_OK);
+    CHECK_EQ(ota_test_stream(image, IMAGE_SIZE - 100, NULL, 0), ESP_OK);
+    CHECK_EQ(ota_write_data(image + IMAGE_SIZE - 100, 100), ESP_ERR_INVALID_SIZE);
+    check_rejected();
+    
+    // Maior que a partição: recusado antes de abrir a sessão
+    CHECK_EQ(ota_begin_streaming(NULL, 0x100001), ESP_ERR_NO_MEM);
+    CHECK(!ota_is_upgrading());
+    free(image);
+}
+
+static void test_pipeline_error(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 9);
+    image[0] = 0x00;
+    
+    // O erro da task de gravação chega ao produtor, que não fica bloqueado
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_test_stream_pipelined(image, IMAGE_SIZE, 0), ESP_ERR_INVALID_CRC);
+    check_rejected();
+    free(image);
+}
+
+static void test_resume(void)
+{
+    ota_test_setup();
+    uint8_t *image = ota_test_image(IMAGE_SIZE, 10);
+    
+    // Conexão perdida após 200 KB: checkpoint no último múltiplo de 64 KB
+    CHECK_EQ(ota_begin_streaming(NULL, IMAGE_SIZE), ESP_OK);
+    CHECK_EQ(ota_test_stream(image, 200 * 1024, NULL, 0), ESP_OK);
+    CHECK_EQ(ota_abort_upgrade(), ESP_OK);
+    
+    ota_resume_info_t info;
+    CHECK_EQ(ota_get_resume_info(&info), ESP_OK);
+    CHECK_EQ(info.offset, 3 * OTA_RESUME_CHECKPOINT_SIZE);
+    CHECK_EQ(info.total_bytes, IMAGE_SIZE);
+    CHECK(strcmp(info.partition, "ota_0") == 0);
+    
+    // Após o reinício do handler o checkpoint vem do NVS
+    ESP_ERROR_CHECK(init_ota_handler());
+    CHECK_EQ(ota_resume_streaming(NULL, IMAGE_SIZE, info.offset - 1), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(ota_resume_streaming(NULL, IMAGE_SIZE, info.offset), ESP_OK);
+    CHECK_EQ(ota_test_stream(image + info.offset, IMAGE_SIZE - info.offset, NULL, 0), ESP_OK);
+    check_installed(image, IMAGE_SIZE);
+    CHECK_EQ(ota_get_resume_info(&info), ESP_ERR_NOT_FOUND);
+    free(image);
+}
+
+int main(void)
+{
+    RUN_TEST(test_serial_chunks);
+    RUN_TEST(test_odd_chunks);
+    RUN_TEST(test_pipelined);
+    RUN_TEST(test_pre_erase_raw_write);
+    RUN_TEST(test_expected_sha_mismatch);
+    RUN_TEST(test_appended_hash_mismatch);
+    RUN_TEST(test_bad_magic);
+    RUN_TEST(test_oversize);
+    RUN_TEST(test_pipeline_error);
+    RUN_TEST(test_resume);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_wifi_reconnect.c
+ * @brief Backoff, jitter, desistência e busca pelo SSID do agendador de reconexão
+ */
+
+#include "host_test.h"
+#include "fake_idf.h"
+#include "wifi_reconnect.h"
+#include "esp_wifi.h"
+#include "esp_random.h"
+#include <string.h>
+
+// Intervalo sem jitter da n-ésima tentativa (n a partir de 0)
+static uint32_t nominal_delay(uint32_t base, uint32_t n)
+{
+    uint64_t delay = base;
+    for (uint32_t i = 0; i < n && delay < WIFI_RECONNECT_MAX_MS; i++) {
+        delay *= 2;
+    }
+    return delay > WIFI_RECONNECT_MAX_MS ? WIFI_RECONNECT_MAX_MS : (uint32_t)delay;
+}
+
+static void test_classify(void)
+{
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_ASSOC_LEAVE), WIFI_RECONNECT_POLICY_NONE);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_AUTH_FAIL), WIFI_RECONNECT_POLICY_AUTH);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_802_1X_AUTH_FAILED), WIFI_RECONNECT_POLICY_AUTH);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_NO_AP_FOUND), WIFI_RECONNECT_POLICY_AP_MISSING);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD),
+             WIFI_RECONNECT_POLICY_AP_MISSING);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_BEACON_TIMEOUT), WIFI_RECONNECT_POLICY_RETRY);
+    
+    // Enlace fraco: não contam como senha errada
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT), WIFI_RECONNECT_POLICY_RETRY);
+    CHECK_EQ(wifi_reconnect_classify(WIFI_REASON_HANDSHAKE_TIMEOUT), WIFI_RECONNECT_POLICY_RETRY);
+}
+
+static void test_backoff_limit(void)
+{
+    wifi_reconnect_state_t state = {0};
+    
+    // random = 0: metade do intervalo nominal (limite inferior do jitter)
+    for (uint32_t n = 0; n < 40; n++) {
+        uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_BEACON_TIMEOUT, false, 0);
+        CHECK_EQ(delay, nominal_delay(WIFI_RECONNECT_BASE_MS, n) / 2);
+        CHECK_EQ(state.consecutive, n + 1);
+    }
+    CHECK_EQ(state.last_delay_ms, WIFI_RECONNECT_MAX_MS / 2);
+    CHECK_EQ(state.disconnects, 40);
+    CHECK(!state.gave_up);
+}
+
+static void test_jitter_bounds(void)
+{
+    // Limite superior: random % (nominal / 2 + 1) == nominal / 2
+    wifi_reconnect_state_t state = {0};
+    for (uint32_t n = 0; n < 12; n++) {
+        uint32_t nominal = nominal_delay(WIFI_RECONNECT_BASE_MS, n);
+        uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_BEACON_TIMEOUT, false, nominal / 2);
+        CHECK_EQ(delay, nominal);
+    }
+    
+    // Valores sorteados ficam sempre entre a metade e o nominal
+    fake_random_seed(1);
+    memset(&state, 0, sizeof(state));
+    for (uint32_t n = 0; n < 1000; n++) {
+        uint32_t nominal = nominal_delay(WIFI_RECONNECT_BASE_MS, n);
+        uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_CONNECTION_FAIL, false, esp_random());
+        CHECK_RANGE(delay, nominal / 2, nominal);
+    }
+}
+
+static void test_ap_missing_base(void)
+{
+    wifi_reconnect_state_t state = {0};
+    uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_NO_AP_FOUND, false, 0);
+    CHECK_EQ(delay, WIFI_RECONNECT_AP_MISSING_MS / 2);
+    delay = wifi_reconnect_next_delay(&state, WIFI_REASON_NO_AP_FOUND, false, UINT32_MAX);
+    CHECK_RANGE(delay, WIFI_RECONNECT_AP_MISSING_MS, 2 * WIFI_RECONNECT_AP_MISSING_MS);
+}
+
+static void test_give_up_keeps_retrying(void)
+{
+    wifi_reconnect_state_t state = {0};
+    
+    for (int i = 0; i < WIFI_RECONNECT_AUTH_MAX_FAILURES - 1; i++) {
+        CHECK(wifi_reconnect_next_delay(&state, WIFI_REASON_AUTH_FAIL, false, 0) != WIFI_RECONNECT_NEVER);
+        CHECK(!state.gave_up);
+    }
+    
+    // Após desistir do backoff, tentativas no intervalo máximo (com jitter)
+    for (int i = 0; i < 20; i++) {
+        uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_AUTH_FAIL, false, esp_random());
+        CHECK(state.gave_up);
+        CHECK_RANGE(delay, WIFI_RECONNECT_MAX_MS / 2, WIFI_RECONNECT_MAX_MS);
+    }
+    
+    // Outros motivos também ficam no intervalo máximo até uma conexão
+    uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_BEACON_TIMEOUT, false, 0);
+    CHECK_EQ(delay, WIFI_RECONNECT_MAX_MS / 2);
+    CHECK_EQ(state.auth_failures, 0);
+    CHECK(state.gave_up);
+}
+
+static void test_handshake_timeouts_never_give_up(void)
+{
+    wifi_reconnect_state_t state = {0};
+    for (int i = 0; i < 10; i++) {
+        uint8_t reason = i % 2 ? WIFI_REASON_HANDSHAKE_TIMEOUT : WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT;
+        CHECK(wifi_reconnect_next_delay(&state, reason, false, 0) != WIFI_RECONNECT_NEVER);
+    }
+    CHECK(!state.gave_up);
+    CHECK_EQ(state.auth_failures, 0);
+}
+
+static void test_assoc_leave_never_reconnects(void)
+{
+    wifi_reconnect_state_t state = {0};
+    CHECK_EQ(wifi_reconnect_next_delay(&state, WIFI_REASON_ASSOC_LEAVE, false, 0), WIFI_RECONNECT_NEVER);
+    CHECK_EQ(wifi_reconnect_next_delay(&state, WIFI_REASON_ASSOC_LEAVE, true, 0), WIFI_RECONNECT_NEVER);
+    CHECK_EQ(state.consecutive, 0);
+}
+
+static void test_fast_attempt_fallback(void)
+{
+    wifi_reconnect_state_t state = {0};
+    
+    // BSSID salvo não encontrado: busca pelo SSID na base, fora do backoff
+    CHECK_EQ(wifi_reconnect_next_delay(&state, WIFI_REASON_NO_AP_FOUND, true, UINT32_MAX),
+             WIFI_RECONNECT_BASE_MS);
+    CHECK_EQ(state.consecutive, 0);
+    CHECK_EQ(state.disconnects, 1);
+    
+    // A busca pelo SSID também falhou: backoff de AP ausente a partir do início
+    uint32_t delay = wifi_reconnect_next_delay(&state, WIFI_REASON_NO_AP_FOUND, false, 0);
+    CHECK_EQ(delay, WIFI_RECONNECT_AP_MISSING_MS / 2);
+    
+    // Depois da desistência, nem a busca pelo SSID sai antes do intervalo máximo
+    state.gave_up = true;
+    delay = wifi_reconnect_next_delay(&state, WIFI_REASON_NO_AP_FOUND, true, 0);
+    CHECK_EQ(delay, WIFI_RECONNECT_MAX_MS / 2);
+}
+
+static void test_scheduler_sequence(void)
+{
+    wifi_reconnect_stats_t stats;
+    CHECK_EQ(wifi_reconnect_init(), ESP_OK);
+    
+    // Queda do AP: tentativa agendada e disparada pelo timer
+    int connects = fake_wifi_connect_calls();
+    wifi_reconnect_schedule(WIFI_REASON_BEACON_TIMEOUT, false);
+    CHECK_EQ(wifi_reconnect_get_stats(&stats), ESP_OK);
+    CHECK_RANGE(stats.next_attempt_ms, 0, WIFI_RECONNECT_BASE_MS);
+    CHECK(fake_timer_fire("wifi_reconnect"));
+    CHECK_EQ(fake_wifi_connect_calls(), connects + 1);
+    wifi_reconnect_get_stats(&stats);
+    CHECK_EQ(stats.next_attempt_ms, -1);
+    CHECK_EQ(stats.state.attempts, 1);
+    
+    // Senha errada: desiste do backoff, mas o timer continua agendado
+    for (int i = 0; i < WIFI_RECONNECT_AUTH_MAX_FAILURES + 2; i++) {
+        wifi_reconnect_schedule(WIFI_REASON_AUTH_FAIL, false);
+        CHECK(fake_timer_fire("wifi_reconnect"));
+    }
+    wifi_reconnect_get_stats(&stats);
+    CHECK(stats.state.gave_up);
+    CHECK_RANGE(stats.state.last_delay_ms, WIFI_RECONNECT_MAX_MS / 2, WIFI_RECONNECT_MAX_MS);
+    
+    // Conexão com IP: backoff e desistência zerados
+    wifi_reconnect_notify_connected();
+    wifi_reconnect_get_stats(&stats);
+    CHECK(!stats.state.gave_up);
+    CHECK_EQ(stats.state.consecutive, 0);
+    CHECK_EQ(stats.state.auth_failures, 0);
+    
+    // Desconexão pedida: nada agendado
+    wifi_reconnect_schedule(WIFI_REASON_ASSOC_LEAVE, false);
+    wifi_reconnect_get_stats(&stats);
+    CHECK_EQ(stats.next_attempt_ms, -1);
+    CHECK(!fake_timer_fire("wifi_reconnect"));
+    
+    // Reset manual cancela a tentativa agendada
+    wifi_reconnect_schedule(WIFI_REASON_NO_AP_FOUND, true);
+    wifi_reconnect_reset();
+    wifi_reconnect_get_stats(&stats);
+    CHECK_EQ(stats.next_attempt_ms, -1);
+    CHECK(!fake_timer_fire("wifi_reconnect"));
+}
+
+int main(void)
+{
+    RUN_TEST(test_classify);
+    RUN_TEST(test_backoff_limit);
+    RUN_TEST(test_jitter_bounds);
+    RUN_TEST(test_ap_missing_base);
+    RUN_TEST(test_give_up_keeps_retrying);
+    RUN_TEST(test_handshake_timeouts_never_give_up);
+    RUN_TEST(test_assoc_leave_never_reconnects);
+    RUN_TEST(test_fast_attempt_fallback);
+    RUN_TEST(test_scheduler_sequence);
+    return 0;
+}
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Gera o patch delta ODLT aceito por POST /ota.
+
+O patch transforma a imagem em execução (origem) na nova imagem, no estilo
+bsdiff: cada registro soma diff_len bytes à origem, copia extra_len bytes
+literais e desloca a posição de leitura da origem em seek bytes.
+
+Formato (little-endian):
+    0  magic "ODLT"
+    4  versão (1)
+    5  reservado (3 bytes, zero)
+    8  tamanho da nova imagem (uint32)
+    12 tamanho da imagem de origem (uint32)
+    16 SHA-256 da imagem de origem
+    48 registros: diff_len (uint32), extra_len (uint32), seek (int32),
+       diff_len bytes de diff, extra_len bytes literais
+
+Os bytes de diff são majoritariamente zero; com --pack o patch é enviado
+dentro do contêiner OTAZ (tools/ota_pack.py), onde se comprime muito bem.
+
+Antes de gravar, o patch é aplicado sobre uma partição simulada (origem
+completada com 0xFF até o tamanho da partição) e o resultado é comparado
+com a nova imagem.
+
+Uso:
+    python tools/ota_delta.py old.bin build/webserver_at.bin update.odlt --pack
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+
+import ota_pack
+
+MAGIC = b"ODLT"
+VERSION = 1
+HEADER = struct.Struct("<4sB3xII32s")
+CTRL = struct.Struct("<IIi")
+BLOCK = 16          # Tamanho mínimo de um trecho coincidente
+INDEX_STEP = 4      # Espaçamento das posições indexadas na origem
+GIVE_UP = 64        # Bytes sem melhora antes de encerrar uma extensão
+PARTITION_SIZE = 0x100000      # ota_0/ota_1 em partitions.csv
+
+
+def build_index(old):
+    index = {}
+    for i in range(0, len(old) - BLOCK + 1, INDEX_STEP):
+        index.setdefault(old[i:i + BLOCK], i)
+    return index
+
+
+def extend(old, new, o, p):
+    """Estende o trecho enquanto mais da metade dos bytes coincide."""
+    limit = min(len(old) - o, len(new) - p)
+    score = best = length = 0
+    for i in range(limit):
+        if old[o + i] == new[p + i]:
+            score += 1
+        if score * 2 - i > best * 2 - length:
+            best = score
+            length = i + 1
+        elif i - length > GIVE_UP:
+            break
+    return length
+
+
+def find_matches(old, new):
+    index = build_index(old)
+    matches = []
+    p = 0
+    while p <= len(new) - BLOCK:
+        o = index.get(new[p:p + BLOCK])
+        if o is None:
+            p += 1
+            continue
+        length = extend(old, new, o, p)
+        matches.append((p, o, length))
+        p += length
+    return matches
+
+
+def diff(old, new):
+    matches = find_matches(old, new)
+    records = []
+
+    # Trecho literal antes do primeiro casamento
+    first_p, first_o = (matches[0][0], matches[0][1]) if matches else (len(new), 0)
+    records.append((b"", new[:first_p], first_o))
+
+    for i, (p, o, length) in enumerate(matches):
+        next_p, next_o = (matches[i + 1][0], matches[i + 1][1]) if i + 1 < len(matches) else (len(new), o + length)
+        delta = bytes((new[p + k] - old[o + k]) & 0xFF for k in range(length))
+        records.append((delta, new[p + length:next_p], next_o - (o + length)))
+
+    out = [HEADER.pack(MAGIC, VERSION, len(new), len(old), hashlib.sha256(old).digest())]
+    for delta, extra, seek in records:
+        if delta or extra:
+            out.append(CTRL.pack(len(delta), len(extra), seek))
+            out.append(delta)
+            out.append(extra)
+        elif seek:
+            # Registro vazio ainda carrega o deslocamento
+            out.append(CTRL.pack(0, 0, seek))
+    return b"".join(out), len(matches)
+
+
+def apply(partition, patch):
+    """Aplica o patch com as mesmas verificações do firmware."""
+    magic, version, new_size, old_size, old_hash = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("cabeçalho ODLT inválido")
+    if old_size > len(partition) or hashlib.sha256(partition[:old_size]).digest() != old_hash:
+        raise ValueError("patch gerado para outra imagem de origem")
+
+    new = bytearray()
+    old_pos = 0
+    pos = HEADER.size
+    while pos < len(patch):
+        diff_len, extra_len, seek = CTRL.unpack_from(patch, pos)
+        pos += CTRL.size
+        if len(new) + diff_len + extra_len > new_size:
+            raise ValueError("registro excede o tamanho da nova imagem")
+        if old_pos < 0 or old_pos + diff_len > old_size:
+            raise ValueError("patch referencia dados fora da origem")
+        new += bytes((partition[old_pos + k] + patch[pos + k]) & 0xFF for k in range(diff_len))
+        pos += diff_len
+        new += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += diff_len + seek
+    if len(new) != new_size:
+        raise ValueError("patch incompleto")
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gera um patch delta OTA (ODLT)")
+    parser.add_argument("old", help="imagem .bin em execução no dispositivo")
+    parser.add_argument("new", help="nova imagem .bin")
+    parser.add_argument("output", help="arquivo de saída")
+    parser.add_argument("--pack", action="store_true", help="comprimir o patch no contêiner OTAZ")
+    parser.add_argument("--window-bits", type=int, default=13, help="janela deflate para --pack")
+    parser.add_argument("--partition-size", type=lambda v: int(v, 0), default=PARTITION_SIZE,
+                        help="tamanho da partição simulada na verificação (padrão 0x%X)" % PARTITION_SIZE)
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+    for name, image in ((args.old, old), (args.new, new)):
+        if not image or image[0] != ota_pack.ESP_IMAGE_MAGIC:
+            print("Erro: %s não é uma imagem ESP-IDF" % name, file=sys.stderr)
+            return 1
+    if len(old) > args.partition_size:
+        print("Erro: origem maior que a partição", file=sys.stderr)
+        return 1
+
+    patch, matches = diff(old, new)
+
+    # Verificação sobre a partição simulada (flash apagada após a imagem)
+    partition = old + b"\xff" * (args.partition_size - len(old))
+    if apply(partition, patch) != new:
+        print("Erro: verificação do patch falhou", file=sys.stderr)
+        return 1
+
+    data = patch
+    if args.pack:
+        data = ota_pack.pack(patch, args.window_bits, 9)
+        if ota_pack.unpack(data) != patch:
+            print("Erro: verificação da descompressão falhou", file=sys.stderr)
+            return 1
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    print("Origem:     %d bytes (SHA-256 %s)" % (len(old), hashlib.sha256(old).hexdigest()))
+    print("Nova:       %d bytes (SHA-256 %s)" % (len(new), hashlib.sha256(new).hexdigest()))
+    print("Trechos:    %d" % matches)
+    print("Patch:      %d bytes" % len(patch))
+    print("Saída:      %d bytes (%.1f%% da nova imagem)" % (len(data), 100.0 * len(data) / len(new)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Gera o contêiner comprimido OTAZ aceito por POST /ota.
+
+Formato (little-endian):
+    0  magic "OTAZ"
+    4  versão (1)
+    5  window_bits do stream deflate
+    6  reservado (2 bytes, zero)
+    8  tamanho da imagem descomprimida (uint32)
+    12 stream deflate "raw" (sem cabeçalho zlib)
+
+O firmware descomprime com uma janela circular de 2^window_bits bytes,
+portanto janelas menores reduzem o uso de RAM no dispositivo.
+
+Uso:
+    python tools/ota_pack.py build/webserver_at.bin build/webserver_at.otaz
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b"OTAZ"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHI")
+MIN_WINDOW_BITS = 9
+MAX_WINDOW_BITS = 15
+ESP_IMAGE_MAGIC = 0xE9
+
+
+def pack(image, window_bits, level):
+    comp = zlib.compressobj(level, zlib.DEFLATED, -window_bits, 9)
+    payload = comp.compress(image) + comp.flush()
+    return HEADER.pack(MAGIC, VERSION, window_bits, 0, len(image)) + payload
+
+
+def unpack(data):
+    magic, version, window_bits, _, size = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("cabeçalho OTAZ inválido")
+    decomp = zlib.decompressobj(-window_bits)
+    image = decomp.decompress(data[HEADER.size:]) + decomp.flush()
+    if not decomp.eof or decomp.unused_data:
+        raise ValueError("stream deflate incompleto ou com dados extras")
+    if len(image) != size:
+        raise ValueError("tamanho descomprimido diverge do cabeçalho")
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Comprime uma imagem OTA no formato OTAZ")
+    parser.add_argument("input", help="imagem .bin gerada pelo ESP-IDF")
+    parser.add_argument("output", help="arquivo .otaz de saída")
+    parser.add_argument("--window-bits", type=int, default=13,
+                        help="log2 da janela deflate (%d..%d, padrão 13 = 8 KB)"
+                             % (MIN_WINDOW_BITS, MAX_WINDOW_BITS))
+    parser.add_argument("--level", type=int, default=9, help="nível de compressão (1..9)")
+    args = parser.parse_args()
+
+    if not MIN_WINDOW_BITS <= args.window_bits <= MAX_WINDOW_BITS:
+        parser.error("--window-bits fora do intervalo suportado")
+
+    with open(args.input, "rb") as f:
+        image = f.read()
+    if not image or image[0] != ESP_IMAGE_MAGIC:
+        print("Erro: %s não é uma imagem ESP-IDF" % args.input, file=sys.stderr)
+        return 1
+
+    data = pack(image, args.window_bits, args.level)
+
+    # Garantir que o dispositivo reconstruirá exatamente a mesma imagem
+    if unpack(data) != image:
+        print("Erro: verificação da descompressão falhou", file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    print("Imagem:     %d bytes" % len(image))
+    print("Contêiner:  %d bytes (%.1f%%)" % (len(data), 100.0 * len(data) / len(image)))
+    print("Janela:     %d bytes" % (1 << args.window_bits))
+    print("SHA-256:    %s" % hashlib.sha256(image).hexdigest())
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
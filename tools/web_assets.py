@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""
+Gera o arquivo C com as páginas web embutidas no firmware.
+
+Executado pelo build (main/CMakeLists.txt). Cada asset é minificado (HTML,
+CSS e JS), comprimido com gzip e gravado como array de bytes em uma tabela
+web_asset_t ordenada por caminho (consulta por busca binária em
+src/web_assets.c). Assets que não diminuem com gzip (imagens já
+comprimidas) são embutidos como estão.
+
+Cada asset recebe uma versão (16 primeiros dígitos hex do SHA-256 do
+conteúdo servido), usada como ETag. Nas páginas HTML, referências a outros
+assets embutidos são reescritas para "caminho?v=<versão>", URL que o
+servidor entrega com Cache-Control imutável. As imagens são processadas
+antes das páginas, de modo que a versão de uma página muda quando uma
+imagem referenciada muda.
+
+Após gerar o arquivo, o script relê os arrays do próprio .c gerado,
+descomprime cada um e compara com a fonte minificada; qualquer divergência
+interrompe o build. A mesma verificação pode ser executada no host:
+
+    python tools/web_assets.py --root web --output build/web_assets_data.c \\
+        --external assets index.html ota.html
+    python tools/web_assets.py --root web --check build/web_assets_data.c \\
+        --external assets index.html ota.html
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".ico": "image/x-icon",
+}
+
+TEXT_TYPES = (".html", ".css", ".js", ".json", ".svg")
+
+# Compressão só é usada quando economiza ao menos 10%
+MIN_GZIP_GAIN = 0.9
+
+# Dígitos hex do SHA-256 usados como versão/ETag
+VERSION_DIGITS = 16
+
+
+def minify(name, data):
+    """Remove indentação, linhas vazias e comentários de linha em <script>/JS.
+
+    As quebras de linha são mantidas para não depender da inserção
+    automática de ponto e vírgula do JavaScript.
+    """
+    ext = os.path.splitext(name)[1]
+    if ext not in TEXT_TYPES:
+        return data
+
+    in_script = ext == ".js"
+    lines = []
+    for line in data.decode("utf-8").splitlines():
+        line = line.strip()
+        if "<script" in line:
+            in_script = True
+        if "</script>" in line:
+            in_script = False
+        if not line or (in_script and line.startswith("//")):
+            continue
+        lines.append(line)
+    return "\n".join(lines).encode("utf-8")
+
+
+def version_of(data):
+    return hashlib.sha256(data).hexdigest()[:VERSION_DIGITS]
+
+
+def add_versions(source, versions):
+    """Acrescenta ?v=<versão> às referências a outros assets embutidos."""
+    text = source.decode("utf-8")
+    for path, version in versions.items():
+        text = re.sub(re.escape(path) + r"(?=['\")\s])", "%s?v=%s" % (path, version), text)
+    return text.encode("utf-8")
+
+
+def external_versions(root, directories):
+    """Versões dos arquivos servidos fora do firmware (partição spiffs)."""
+    versions = {}
+    for directory in directories:
+        for base, _, files in os.walk(os.path.join(root, directory)):
+            for name in files:
+                full = os.path.join(base, name)
+                with open(full, "rb") as f:
+                    versions["/" + os.path.relpath(full, root).replace(os.sep, "/")] = version_of(f.read())
+    return versions
+
+
+def build(root, names, external=()):
+    entries = []
+    for name in names:
+        with open(os.path.join(root, name), "rb") as f:
+            source = minify(name, f.read())
+        entries.append(("/" + name.replace(os.sep, "/"), source))
+
+    # Assets não-HTML primeiro: suas versões entram nas páginas
+    entries.sort(key=lambda e: e[0].endswith(".html"))
+    versions = external_versions(root, external)
+    assets = []
+    for path, source in entries:
+        if path.endswith(".html"):
+            source = add_versions(source, versions)
+        else:
+            versions[path] = version_of(source)
+        packed = gzip.compress(source, 9, mtime=0)
+        use_gzip = len(packed) < len(source) * MIN_GZIP_GAIN
+        ext = os.path.splitext(path)[1]
+        assets.append({
+            "path": path,
+            "type": CONTENT_TYPES.get(ext, "application/octet-stream"),
+            "source": source,
+            "data": packed if use_gzip else source,
+            "gzip": use_gzip,
+            "version": version_of(source),
+        })
+    return sorted(assets, key=lambda a: a["path"].encode())
+
+
+def c_array(data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(rows)
+
+
+def generate(assets):
+    out = [
+        "/*",
+        " * Gerado por tools/web_assets.py - não editar.",
+        " */",
+        "",
+        '#include "web_assets.h"',
+        "",
+    ]
+    for i, asset in enumerate(assets):
+        out.append("// %s (%d -> %d bytes)" % (asset["path"], len(asset["source"]), len(asset["data"])))
+        out.append("static const uint8_t s_asset_%d[] = {" % i)
+        out.append(c_array(asset["data"]))
+        out.append("};")
+        out.append("")
+    out.append("const web_asset_t g_web_assets[] = {")
+    for i, asset in enumerate(assets):
+        out.append('    { "%s", "%s", s_asset_%d, sizeof(s_asset_%d), %s, "%s" },'
+                   % (asset["path"], asset["type"], i, i, "true" if asset["gzip"] else "false",
+                      asset["version"]))
+    out.append("};")
+    out.append("")
+    out.append("const size_t g_web_assets_count = %d;" % len(assets))
+    out.append("")
+    return "\n".join(out)
+
+
+def check(assets, c_source):
+    """Confere cada array do .c gerado contra a fonte minificada."""
+    arrays = {}
+    for index, body in re.findall(r"s_asset_(\d+)\[\] = \{(.*?)\};", c_source, re.S):
+        arrays[int(index)] = bytes(int(b, 16) for b in re.findall(r"0x([0-9a-f]{2})", body))
+    table = re.findall(r'\{ "([^"]+)", "[^"]+", s_asset_(\d+), sizeof\(s_asset_\d+\), (true|false), '
+                       r'"([0-9a-f]+)" \}', c_source)
+
+    if len(table) != len(assets):
+        return ["tabela com %d entradas, esperado %d" % (len(table), len(assets))]
+
+    errors = []
+    for asset, (path, index, gz, version) in zip(assets, table):
+        data = arrays.get(int(index), b"")
+        if gz == "true":
+            try:
+                data = gzip.decompress(data)
+            except OSError as e:
+                errors.append("%s: gzip inválido (%s)" % (path, e))
+                continue
+        if path != asset["path"] or data != asset["source"]:
+            errors.append("%s: conteúdo diverge da fonte" % path)
+        elif version != version_of(data):
+            errors.append("%s: versão não corresponde ao conteúdo" % path)
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Embute páginas web comprimidas no firmware")
+    parser.add_argument("--root", required=True, help="diretório base dos assets")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("--output", help="arquivo .c a gerar")
+    group.add_argument("--check", help="arquivo .c gerado a verificar")
+    parser.add_argument("--external", action="append", default=[],
+                        help="diretório (relativo a --root) servido fora do firmware")
+    parser.add_argument("assets", nargs="+", help="assets relativos a --root")
+    args = parser.parse_args()
+
+    assets = build(args.root, args.assets, args.external)
+
+    path = args.check or args.output
+    if args.output:
+        c_source = generate(assets)
+        with open(args.output + ".tmp", "w") as f:
+            f.write(c_source)
+    else:
+        with open(path) as f:
+            c_source = f.read()
+
+    errors = check(assets, c_source)
+    if errors:
+        for error in errors:
+            print("web_assets: %s" % error, file=sys.stderr)
+        return 1
+
+    if args.output:
+        os.replace(args.output + ".tmp", args.output)
+
+    total_source = sum(len(a["source"]) for a in assets)
+    total_data = sum(len(a["data"]) for a in assets)
+    print("web_assets: %d assets, %d -> %d bytes" % (len(assets), total_source, total_data))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())